@@ -0,0 +1,153 @@
+#ifndef ASYNC_MEMORY_HIERARCHY_H
+#define ASYNC_MEMORY_HIERARCHY_H
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <queue>
+#include <vector>
+
+#include "kachesim/data.h"
+#include "kachesim/data_storage_transaction.h"
+#include "kachesim/memory_hierarchy.h"
+
+namespace kachesim {
+/**
+ * coroutine which accesses an AsyncMemoryHierarchy, it starts when it is spawned
+ */
+class AccessTask {
+public:
+    struct promise_type {
+        std::exception_ptr exception;
+
+        AccessTask get_return_object() {
+            return AccessTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    AccessTask(AccessTask&& task) noexcept;
+    AccessTask(const AccessTask&) = delete;
+    AccessTask& operator=(const AccessTask&) = delete;
+    ~AccessTask();
+
+    std::coroutine_handle<promise_type> release();
+
+private:
+    explicit AccessTask(std::coroutine_handle<promise_type> handle);
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+class AsyncMemoryHierarchy;
+
+/**
+ * awaitable of an access, the access is issued when the coroutine suspends and the
+ * coroutine resumes in the cycle in which the access completes
+ */
+class AccessAwaitable {
+public:
+    AccessAwaitable(AsyncMemoryHierarchy* hierarchy, DataStorageTransactionType type,
+                    size_t port, address_t address, size_t num_bytes, Data data);
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    DataStorageTransaction await_resume();
+
+private:
+    AsyncMemoryHierarchy* hierarchy_;
+    DataStorageTransactionType type_;
+    size_t port_;
+    address_t address_;
+    size_t num_bytes_;
+    Data data_;
+    std::optional<DataStorageTransaction> dst_;
+};
+
+/**
+ * awaitable which resumes the coroutine after a number of cycles
+ */
+class DelayAwaitable {
+public:
+    DelayAwaitable(AsyncMemoryHierarchy* hierarchy, cycle_t cycles);
+
+    bool await_ready() const noexcept { return cycles_ == 0; }
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+
+private:
+    AsyncMemoryHierarchy* hierarchy_;
+    cycle_t cycles_;
+};
+
+/**
+ * coroutine API of a memory hierarchy in timed mode, e.g.
+ *
+ *   AccessTask load(AsyncMemoryHierarchy& hierarchy) {
+ *       auto dst = co_await hierarchy.read_async(0x100, 8);
+ *       ...
+ *   }
+ *
+ *   AsyncMemoryHierarchy hierarchy(memory_hierarchy);
+ *   hierarchy.spawn(load(hierarchy));
+ *   hierarchy.run();
+ *
+ * Accesses are issued in the current cycle of the global clock of the memory hierarchy
+ * and the awaiting coroutine resumes in the cycle in which the access completes, so
+ * many accesses can be in flight in one thread. The data is read or written when the
+ * access is issued. Coroutines are resumed in cycle order, coroutines which are ready
+ * in the same cycle in the order in which they were suspended. An exception thrown in
+ * a coroutine is rethrown by run.
+ */
+class AsyncMemoryHierarchy {
+public:
+    AsyncMemoryHierarchy(MemoryHierarchy& memory_hierarchy);
+    ~AsyncMemoryHierarchy();
+
+    AccessAwaitable read_async(address_t address, size_t num_bytes);
+    AccessAwaitable read_async(size_t port, address_t address, size_t num_bytes);
+    AccessAwaitable write_async(address_t address, const Data& data);
+    AccessAwaitable write_async(size_t port, address_t address, const Data& data);
+    DelayAwaitable delay(cycle_t cycles);
+
+    void spawn(AccessTask task);
+    void run();
+
+    cycle_t get_cycle() const;
+    size_t get_pending_count() const;
+
+    MemoryHierarchy& get_memory_hierarchy();
+
+private:
+    friend class AccessAwaitable;
+    friend class DelayAwaitable;
+
+    struct ScheduledCoroutine {
+        cycle_t cycle;
+        uint64_t sequence;
+        std::coroutine_handle<> handle;
+
+        bool operator>(const ScheduledCoroutine& other) const {
+            if (cycle != other.cycle) {
+                return cycle > other.cycle;
+            }
+            return sequence > other.sequence;
+        }
+    };
+
+    MemoryHierarchy& memory_hierarchy_;
+
+    std::priority_queue<ScheduledCoroutine, std::vector<ScheduledCoroutine>,
+                        std::greater<ScheduledCoroutine>>
+        scheduled_coroutines_;
+    uint64_t sequence_ = 0;
+
+    void schedule(cycle_t cycle, std::coroutine_handle<> handle);
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef BACKING_STORE_H
+#define BACKING_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "kachesim/data_storage_transaction.h"
+
+namespace kachesim {
+/**
+ * stores the bytes of a memory. Memories only check the address range and model the
+ * timing, how and where the bytes are stored is up to the backing store.
+ */
+class BackingStore {
+public:
+    virtual ~BackingStore() = 0;
+
+    virtual size_t size() const = 0;
+
+    virtual void read(address_t address, uint8_t* data, size_t num_bytes) const = 0;
+    virtual void write(address_t address, const uint8_t* data, size_t num_bytes) = 0;
+
+    virtual void reset() = 0;
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef COW_BACKING_STORE_H
+#define COW_BACKING_STORE_H
+
+#include <memory>
+
+#include "sparse_backing_store.h"
+
+namespace kachesim {
+/**
+ * stores the bytes of a memory as private copy-on-write pages on top of a shared base.
+ * Reads of pages which were never written are served by the base, the first write to
+ * a page copies it from the base into a private page. The base is never modified, so
+ * many memories (e.g. one per hierarchy in a parameter sweep) can share a single
+ * image and only pay for the pages they write. The base must not be written while it
+ * is shared, reads of it may happen from multiple threads.
+ *
+ *   page_size: size of the private pages in bytes, has to be a power of two
+ */
+class CowBackingStore : public SparseBackingStore {
+public:
+    CowBackingStore(std::shared_ptr<const BackingStore> base, size_t page_size = 4096);
+
+    std::shared_ptr<const BackingStore> get_base() const;
+
+    void read(address_t address, uint8_t* data, size_t num_bytes) const;
+    void write(address_t address, const uint8_t* data, size_t num_bytes);
+
+private:
+    std::shared_ptr<const BackingStore> base_;
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef DENSE_BACKING_STORE_H
+#define DENSE_BACKING_STORE_H
+
+#include <vector>
+
+#include "backing_store.h"
+
+namespace kachesim {
+/**
+ * stores all bytes of a memory in one contiguous allocation
+ */
+class DenseBackingStore : public BackingStore {
+public:
+    DenseBackingStore(size_t size);
+
+    size_t size() const;
+
+    void read(address_t address, uint8_t* data, size_t num_bytes) const;
+    void write(address_t address, const uint8_t* data, size_t num_bytes);
+
+    void reset();
+
+private:
+    size_t size_;
+    std::vector<uint8_t> data_;
+};
+}  // namespace kachesim
+
+#endif
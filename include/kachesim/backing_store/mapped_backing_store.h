@@ -0,0 +1,42 @@
+#ifndef MAPPED_BACKING_STORE_H
+#define MAPPED_BACKING_STORE_H
+
+#include <string>
+
+#include "backing_store.h"
+
+namespace kachesim {
+/**
+ * maps a memory image file privately into the address space of the simulator. Pages of
+ * the image are only loaded when they are accessed and copied when they are written,
+ * the image file itself is never modified. Bytes behind the end of the image are 0.
+ */
+class MappedBackingStore : public BackingStore {
+public:
+    MappedBackingStore(const std::string& image_path, size_t size = 0);
+    ~MappedBackingStore();
+
+    MappedBackingStore(const MappedBackingStore&) = delete;
+    MappedBackingStore& operator=(const MappedBackingStore&) = delete;
+
+    size_t size() const;
+    size_t image_size() const;
+    std::string get_image_path() const;
+
+    void read(address_t address, uint8_t* data, size_t num_bytes) const;
+    void write(address_t address, const uint8_t* data, size_t num_bytes);
+
+    void reset();
+
+private:
+    std::string image_path_;
+    size_t size_;
+    size_t image_size_;
+    uint8_t* data_ = nullptr;
+
+    void map();
+    void unmap();
+};
+}  // namespace kachesim
+
+#endif
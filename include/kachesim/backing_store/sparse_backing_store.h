@@ -0,0 +1,57 @@
+#ifndef SPARSE_BACKING_STORE_H
+#define SPARSE_BACKING_STORE_H
+
+#include <memory>
+#include <vector>
+
+#include "backing_store.h"
+
+namespace kachesim {
+struct SparseBackingStoreNode {
+    // inner nodes point to further nodes, nodes on the last level point to pages
+    std::vector<std::unique_ptr<SparseBackingStoreNode>> children;
+    std::vector<std::unique_ptr<uint8_t[]>> pages;
+};
+
+/**
+ * stores the bytes of a memory in pages which are allocated on the first write. The
+ * pages are looked up in a radix table, each level of the table resolves 9 bits of the
+ * page number. Bytes in pages which were never written are read as 0.
+ *
+ *   page_size: size of a page in bytes, has to be a power of two (e.g. 4 KiB or 2 MiB)
+ */
+class SparseBackingStore : public BackingStore {
+public:
+    SparseBackingStore(size_t size, size_t page_size = 4096);
+
+    size_t size() const;
+    size_t page_size() const;
+
+    void read(address_t address, uint8_t* data, size_t num_bytes) const;
+    void write(address_t address, const uint8_t* data, size_t num_bytes);
+
+    size_t get_allocated_page_count() const;
+
+    void reset();
+
+protected:
+    uint32_t page_bits() const { return page_bits_; }
+
+    const uint8_t* find_page(uint64_t page_number) const;
+    uint8_t* find_or_allocate_page(uint64_t page_number);
+
+private:
+    static constexpr uint32_t radix_bits_ = 9;
+    static constexpr uint64_t radix_mask_ = (1 << radix_bits_) - 1;
+
+    size_t size_;
+    size_t page_size_;
+    uint32_t page_bits_;
+    uint32_t levels_;
+
+    std::unique_ptr<SparseBackingStoreNode> root_;
+    size_t allocated_pages_ = 0;
+};
+}  // namespace kachesim
+
+#endif
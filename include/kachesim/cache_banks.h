@@ -0,0 +1,57 @@
+#ifndef CACHE_BANKS_H
+#define CACHE_BANKS_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "kachesim/data_storage_transaction.h"
+#include "kachesim/index_function.h"
+
+namespace kachesim {
+/**
+ * models the banks of a cache. The bytes of the cache are interleaved over the banks in
+ * units of bank_width bytes, the bank of a unit is selected by an IndexFunction of the
+ * unit address. Every access to a unit keeps its bank busy for busy_cycles, an access
+ * which needs a busy bank waits until it is free. Accesses to different banks overlap.
+ *
+ *   banks: number of banks, doesn't need to be a power of two
+ *   bank_width: number of consecutive bytes in one bank, a power of two
+ *   busy_cycles: cycles a bank is busy with the access to one unit
+ *   bank_function: selects the bank of a unit like the set of a block, MODULO_INDEX
+ *   interleaves the units, XOR_INDEX spreads strides which are a multiple of the
+ *   number of banks
+ */
+class CacheBanks {
+public:
+    CacheBanks(size_t banks, size_t bank_width, latency_t busy_cycles,
+               IndexFunctionType bank_function = MODULO_INDEX);
+
+    size_t get_banks();
+    size_t get_bank_width();
+    latency_t get_busy_cycles();
+    IndexFunctionType get_bank_function();
+
+    size_t get_bank(address_t address);
+    cycle_t schedule(address_t address, size_t num_bytes, cycle_t cycle,
+                     latency_t latency);
+
+    std::shared_ptr<CacheBanks> clone();
+
+    void reset();
+
+private:
+    size_t banks_;
+    size_t bank_width_;
+    uint32_t bank_width_bits_;
+    latency_t busy_cycles_;
+    IndexFunction bank_function_;
+
+    // cycle in which bank i becomes free
+    std::vector<cycle_t> free_cycles_;
+    // units of the current access per bank, all 0 between accesses
+    std::vector<size_t> units_;
+};
+}  // namespace kachesim
+
+#endif
@@ -10,23 +10,48 @@ namespace kachesim {
 /**
  * represents a cache block (also called line) containing N bytes with a tag and a
  * dirty bit
+ *
+ * a block can be divided into up to 64 sectors of equal size, each with its own valid
+ * and dirty bit in a sector mask. The valid and dirty bit of the block are set if any
+ * of its sectors is valid or dirty. A block which isn't sectored has a single sector.
+ *
+ * a block with byte masks additionally has a valid bit per byte, so data can be written
+ * into it without loading the rest of the block first. Such a block is complete once
+ * all of its bytes are valid. A block without byte masks is always complete.
+ *
+ * a block is only considered valid if its valid bit is set and it was updated in the
+ * same generation as the one it is checked against. This allows a cache to invalidate
+ * all of its blocks at once by incrementing its generation.
  */
 class CacheBlock {
 public:
-    CacheBlock(uint64_t size);
+    CacheBlock(uint64_t size, uint32_t sectors = 1, bool byte_masks = false);
+    CacheBlock(const CacheBlock& cache_block);
     ~CacheBlock();
 
+    CacheBlock& operator=(const CacheBlock&) = delete;
+
     std::size_t size() const { return size_; }
 
-    void set_valid();
+    void set_valid(uint64_t generation = 0);
     void set_unvalid();
-    bool is_valid();
+    bool is_valid(uint64_t generation = 0);
 
     void set_dirty();
     void set_not_dirty();
     bool is_dirty();
 
-    void update(uint64_t tag, Data& data, bool valid = true, bool dirty = true);
+    void update(uint64_t tag, Data& data, bool valid = true, bool dirty = true,
+                uint64_t generation = 0);
+    void update_sectors(uint64_t tag, Data& data, uint64_t valid_sectors,
+                        uint64_t dirty_sectors, uint64_t generation = 0);
+    void update_bytes(uint64_t tag, Data& data, uint64_t offset,
+                      uint64_t generation = 0);
+
+    bool are_bytes_valid(uint64_t offset, uint64_t num_bytes) const;
+    bool is_complete() const { return valid_byte_count_ == size_; }
+    uint64_t get_valid_sectors() const { return valid_sectors_; }
+    uint64_t get_dirty_sectors() const { return dirty_sectors_; }
     uint64_t get_tag();
     Data get_data();
 
@@ -39,9 +64,19 @@ private:
     uint8_t* data_;
 
     size_t size_;
+    uint64_t all_sectors_;
     uint64_t tag_;
+    uint64_t generation_ = 0;
     bool dirty_ = false;
     bool valid_ = false;
+    uint64_t valid_sectors_ = 0;
+    uint64_t dirty_sectors_ = 0;
+
+    // empty if the block has no byte masks
+    std::vector<bool> valid_bytes_;
+    size_t valid_byte_count_ = 0;
+
+    void set_bytes_valid(bool valid);
 };
 }  // namespace kachesim
 
@@ -1,6 +1,8 @@
 #ifndef CACHE_INTERFACE_H
 #define CACHE_INTERFACE_H
 
+#include <memory>
+
 #include "kachesim/data_storage.h"
 
 namespace kachesim {
@@ -18,6 +20,9 @@ public:
     virtual DataStorageTransaction read(address_t address, size_t num_bytes) = 0;
     virtual DataStorageTransaction flush() = 0;
 
+    virtual std::shared_ptr<CacheInterface> clone(
+        std::shared_ptr<DataStorage> next_level_data_storage) = 0;
+
     virtual uint8_t get(address_t address) = 0;
 
     virtual void reset() = 0;
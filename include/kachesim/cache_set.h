@@ -12,25 +12,54 @@ namespace kachesim {
 class CacheSet {
 public:
     CacheSet(uint64_t cache_block_size, uint32_t ways,
-             ReplacementPolicyType replacement_policy_type);
+             ReplacementPolicyType replacement_policy_type, uint32_t sectors = 1,
+             bool byte_masks = false);
 
-    int32_t get_block_index_with_tag(uint64_t tag);
-    int32_t get_free_block_index();
+    int32_t get_block_index_with_tag(uint64_t tag, uint64_t generation = 0);
+    int32_t get_free_block_index(uint64_t generation = 0);
 
     Data get_block_data(uint32_t block_index);
     uint64_t get_block_tag(uint32_t block_index);
     void update_block(uint32_t block_index, uint64_t tag, Data& data, bool valid = true,
-                      bool dirty = true);
+                      bool dirty = true, uint64_t generation = 0);
+    void update_block_sectors(uint32_t block_index, uint64_t tag, Data& data,
+                              uint64_t valid_sectors, uint64_t dirty_sectors,
+                              uint64_t generation = 0);
+    void update_block_bytes(uint32_t block_index, uint64_t tag, Data& data,
+                            uint64_t offset, uint64_t generation = 0);
 
-    bool is_block_valid(uint32_t block_index);
+    bool is_block_valid(uint32_t block_index, uint64_t generation = 0);
     bool is_block_dirty(uint32_t block_index);
+    uint64_t get_block_valid_sectors(uint32_t block_index);
+    uint64_t get_block_dirty_sectors(uint32_t block_index);
+    bool are_block_bytes_valid(uint32_t block_index, uint64_t offset,
+                               uint64_t num_bytes);
+    bool is_block_complete(uint32_t block_index);
+
+    uint32_t get_dirty_block_count() const { return dirty_blocks_; }
+    const std::vector<uint64_t>& get_dirty_mask() const { return dirty_mask_; }
+    void clear_dirty_mask();
 
     void update_replacement_policy(uint32_t block_index);
     uint32_t get_replacement_index();
 
+    std::unique_ptr<CacheSet> clone();
+
+    void reset();
+
 private:
+    CacheSet(const CacheSet& cache_set);
+
     std::vector<std::unique_ptr<CacheBlock>> blocks_;
     std::shared_ptr<ReplacementPolicy> replacement_policy_;
+    ReplacementPolicyType replacement_policy_type_;
+
+    // bit i is set if block i is valid and dirty
+    std::vector<uint64_t> dirty_mask_;
+    uint32_t dirty_blocks_ = 0;
+
+    void create_replacement_policy();
+    void update_dirty_mask(uint32_t block_index, bool dirty);
 };
 }  // namespace kachesim
 
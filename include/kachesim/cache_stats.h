@@ -0,0 +1,88 @@
+#ifndef CACHE_STATS_H
+#define CACHE_STATS_H
+
+#include <cstdint>
+
+namespace kachesim {
+/**
+ * counts the accesses of a cache, accesses spanning multiple blocks are counted once
+ * per block
+ *
+ *   mshr_merges: timed accesses to a block whose miss was still outstanding
+ *   mshr_stalls: timed misses which had to wait for a free MSHR
+ *   prefetches_issued: blocks loaded by the prefetcher
+ *   prefetches_useful: prefetched blocks which were accessed before their eviction
+ *   prefetches_late: useful prefetches whose miss was still outstanding when accessed
+ *   prefetches_polluting: prefetched blocks which were evicted without being accessed
+ *   prefetches_dropped: prefetches which weren't issued because all MSHRs were in use
+ *   victim_hits: accesses which missed in the cache but were served by the victim
+ *   cache, they are counted as hits and not as misses
+ *   sector_misses: misses to a cached block whose accessed sectors weren't valid
+ *   deferred_fills: reads which loaded a block allocated by a write without fetch
+ *   write_buffer_merges: writes which merged into an entry of the write buffer
+ *   write_buffer_drains: entries of the write buffer written to the next level
+ *   write_buffer_stalls: writes which had to wait for a free write buffer entry
+ *   bank_conflicts: block accesses which were delayed by a busy cache bank
+ *   next_level_bytes_read: bytes read from the next level data storage
+ *   next_level_bytes_written: bytes written to the next level data storage, including
+ *   write backs and write throughs
+ */
+struct CacheStats {
+    uint64_t read_hits = 0;
+    uint64_t read_misses = 0;
+    uint64_t write_hits = 0;
+    uint64_t write_misses = 0;
+    uint64_t write_backs = 0;
+    uint64_t mshr_merges = 0;
+    uint64_t mshr_stalls = 0;
+    uint64_t prefetches_issued = 0;
+    uint64_t prefetches_useful = 0;
+    uint64_t prefetches_late = 0;
+    uint64_t prefetches_polluting = 0;
+    uint64_t prefetches_dropped = 0;
+    uint64_t victim_hits = 0;
+    uint64_t sector_misses = 0;
+    uint64_t deferred_fills = 0;
+    uint64_t write_buffer_merges = 0;
+    uint64_t write_buffer_drains = 0;
+    uint64_t write_buffer_stalls = 0;
+    uint64_t bank_conflicts = 0;
+    uint64_t next_level_bytes_read = 0;
+    uint64_t next_level_bytes_written = 0;
+
+    CacheStats& operator+=(const CacheStats& stats) {
+        read_hits += stats.read_hits;
+        read_misses += stats.read_misses;
+        write_hits += stats.write_hits;
+        write_misses += stats.write_misses;
+        write_backs += stats.write_backs;
+        mshr_merges += stats.mshr_merges;
+        mshr_stalls += stats.mshr_stalls;
+        prefetches_issued += stats.prefetches_issued;
+        prefetches_useful += stats.prefetches_useful;
+        prefetches_late += stats.prefetches_late;
+        prefetches_polluting += stats.prefetches_polluting;
+        prefetches_dropped += stats.prefetches_dropped;
+        victim_hits += stats.victim_hits;
+        sector_misses += stats.sector_misses;
+        deferred_fills += stats.deferred_fills;
+        write_buffer_merges += stats.write_buffer_merges;
+        write_buffer_drains += stats.write_buffer_drains;
+        write_buffer_stalls += stats.write_buffer_stalls;
+        bank_conflicts += stats.bank_conflicts;
+        next_level_bytes_read += stats.next_level_bytes_read;
+        next_level_bytes_written += stats.next_level_bytes_written;
+        return *this;
+    }
+};
+
+/**
+ * stats of one thread, shards are aligned to cache lines so threads counting in
+ * different shards don't share a line
+ */
+struct alignas(64) CacheStatsShard {
+    CacheStats stats;
+};
+}  // namespace kachesim
+
+#endif
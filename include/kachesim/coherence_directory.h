@@ -0,0 +1,116 @@
+#ifndef COHERENCE_DIRECTORY_H
+#define COHERENCE_DIRECTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "kachesim/data.h"
+#include "kachesim/data_storage_transaction.h"
+
+namespace kachesim {
+class SetAssociativeCache;
+
+typedef enum CoherenceProtocol { MESI, MOESI } CoherenceProtocol;
+
+typedef enum CoherenceState {
+    COHERENCE_INVALID,
+    COHERENCE_SHARED,
+    COHERENCE_EXCLUSIVE,
+    COHERENCE_OWNED,
+    COHERENCE_MODIFIED
+} CoherenceState;
+
+/**
+ * the coherence actions which were needed to serve a request of a cache
+ *
+ *   invalidations: number of copies invalidated in other caches
+ *   interventions: number of requests forwarded to the owner of a block
+ *   latency: latency of the directory lookup, the snoops and write backs
+ *   forwarded: the block was forwarded by its owner and doesn't need to be read from
+ *   the next level data storage
+ */
+struct CoherenceTransaction {
+    uint64_t invalidations = 0;
+    uint64_t interventions = 0;
+    latency_t latency = 0;
+    bool forwarded = false;
+
+    CoherenceTransaction& operator+=(const CoherenceTransaction& transaction) {
+        invalidations += transaction.invalidations;
+        interventions += transaction.interventions;
+        latency += transaction.latency;
+        forwarded = forwarded || transaction.forwarded;
+        return *this;
+    }
+};
+
+/**
+ * keeps private caches which share a next level data storage coherent with a MESI or
+ * MOESI protocol. The directory tracks the sharers and the owner of every block which
+ * is cached by any of the caches, so only caches holding a block are snooped instead
+ * of broadcasting to all of them.
+ *
+ * With MESI dirty blocks always pass through the next level data storage: an owner in
+ * the modified state writes its block back before it is shared or invalidated. With
+ * MOESI a modified block which is read by another cache stays dirty in the owned state
+ * and is forwarded from cache to cache.
+ *
+ *   lookup_latency: latency of each request which has to consult the directory
+ *   snoop_latency: latency added if other caches have to be snooped, snoops of one
+ *   request are sent in parallel
+ *
+ * At most 64 caches can be kept coherent.
+ */
+class CoherenceDirectory {
+public:
+    CoherenceDirectory(CoherenceProtocol protocol, latency_t lookup_latency,
+                       latency_t snoop_latency);
+
+    void set_cache(size_t cache_id, SetAssociativeCache* cache);
+
+    CoherenceTransaction read(size_t cache_id, address_t address, Data* data);
+    CoherenceTransaction write(size_t cache_id, address_t address, Data* data,
+                               bool allocate);
+    void evict(size_t cache_id, address_t address);
+    void evict_all(size_t cache_id);
+
+    CoherenceState get_state(size_t cache_id, address_t address);
+    CoherenceProtocol get_protocol();
+    size_t get_entry_count();
+    uint64_t get_invalidation_count();
+    uint64_t get_intervention_count();
+
+    std::shared_ptr<CoherenceDirectory> clone();
+
+private:
+    static constexpr size_t max_caches_ = 64;
+
+    /**
+     * sharers contains every cache with a valid copy including the owner, state is the
+     * state of the owner or COHERENCE_SHARED if there is no owner
+     */
+    struct DirectoryEntry {
+        uint64_t sharers = 0;
+        int32_t owner = -1;
+        CoherenceState state = COHERENCE_SHARED;
+    };
+
+    CoherenceProtocol protocol_;
+    latency_t lookup_latency_;
+    latency_t snoop_latency_;
+
+    std::vector<SetAssociativeCache*> caches_;
+    std::unordered_map<address_t, DirectoryEntry> entries_;
+
+    uint64_t invalidations_ = 0;
+    uint64_t interventions_ = 0;
+
+    void remove_sharer(std::unordered_map<address_t, DirectoryEntry>::iterator it,
+                       size_t cache_id);
+};
+}  // namespace kachesim
+
+#endif
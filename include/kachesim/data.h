@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <iomanip>
 #include <iostream>
+#include <vector>
 
 namespace kachesim {
 class Data {
@@ -19,6 +20,9 @@ public:
 
     size_t size() const;
 
+    uint8_t* data();
+    const uint8_t* data() const;
+
     uint8_t operator[](uint64_t index) const;
     uint8_t& operator[](uint64_t index);
 
@@ -13,12 +13,20 @@ public:
 
     virtual std::string get_name() = 0;
     virtual size_t size() = 0;
+    virtual size_t get_address_space_size();
 
     virtual DataStorageTransaction write(address_t address, Data& data) = 0;
     virtual DataStorageTransaction read(address_t address, size_t num_bytes) = 0;
 
+    virtual DataStorageTransaction write_at(cycle_t cycle, address_t address,
+                                            Data& data);
+    virtual DataStorageTransaction read_at(cycle_t cycle, address_t address,
+                                           size_t num_bytes);
+
     virtual uint8_t get(address_t address) = 0;
 
+    virtual void set_concurrent(bool concurrent);
+
     virtual void reset() = 0;
 };
 }  // namespace kachesim
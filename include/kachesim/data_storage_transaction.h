@@ -7,6 +7,7 @@
 
 typedef uint32_t latency_t;
 typedef uint64_t address_t;
+typedef uint64_t cycle_t;
 
 typedef enum DataStorageTransactionType { READ, WRITE } DataStorageTransactionType;
 typedef enum HitMiss { HIT, MISS } HitMiss;
@@ -30,6 +31,18 @@ public:
      */
     int32_t hit_level;
     Data data = Data(0);
+
+    /**
+     * coherence actions of coherent caches: the number of copies invalidated in other
+     * caches, the number of requests forwarded to the owner of a block and the latency
+     * they added, which is included in latency
+     */
+    uint64_t invalidations = 0;
+    uint64_t interventions = 0;
+    latency_t coherence_latency = 0;
+
+    // cycle in which a timed access completes, see DataStorage::read_at
+    cycle_t completion_cycle = 0;
 };
 }  // namespace kachesim
 
@@ -0,0 +1,56 @@
+#ifndef DIRTY_PAGE_BITMAP_H
+#define DIRTY_PAGE_BITMAP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "kachesim/data_storage_transaction.h"
+
+namespace kachesim {
+/**
+ * tracks which pages of a memory have been written. The bitmap is split into chunks
+ * which are allocated on the first write to one of their pages, so memories up to the
+ * full 64-bit address space only pay for the regions which were actually written.
+ *
+ *   page_size: size of a page in bytes, has to be a power of two
+ */
+class DirtyPageBitmap {
+public:
+    DirtyPageBitmap(size_t page_size = 4096);
+    DirtyPageBitmap(const DirtyPageBitmap& dirty_page_bitmap);
+
+    DirtyPageBitmap& operator=(const DirtyPageBitmap& dirty_page_bitmap);
+
+    size_t page_size() const;
+
+    void mark(address_t address, size_t num_bytes);
+    bool is_dirty(address_t address) const;
+
+    size_t get_dirty_page_count() const;
+    std::vector<uint64_t> get_dirty_pages() const;
+
+    void clear();
+
+private:
+    // each chunk covers 64 * 64 pages
+    static constexpr uint32_t chunk_words_ = 64;
+    static constexpr uint32_t chunk_bits_ = 12;
+
+    typedef std::array<uint64_t, chunk_words_> Chunk;
+
+    size_t page_size_;
+    uint32_t page_bits_;
+
+    std::map<uint64_t, Chunk> chunks_;
+    size_t dirty_pages_ = 0;
+
+    // the chunk written last, most writes hit the same chunk again
+    uint64_t last_chunk_index_ = 0;
+    Chunk* last_chunk_ = nullptr;
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef DRAM_MEMORY_H
+#define DRAM_MEMORY_H
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kachesim/fake_memory.h"
+
+typedef enum DramRowPolicy { OPEN_ROW_POLICY, CLOSED_ROW_POLICY } DramRowPolicy;
+
+namespace kachesim {
+/**
+ * timing parameters of a DramMemory in cycles
+ *
+ *   t_rcd: activate to column command
+ *   t_cas: column command to the first data
+ *   t_rp: precharge to activate
+ *   t_ras: activate to precharge
+ *   t_burst: cycles the data of one column access occupies the data bus
+ */
+struct DramTimings {
+    latency_t t_rcd = 0;
+    latency_t t_cas = 0;
+    latency_t t_rp = 0;
+    latency_t t_ras = 0;
+    latency_t t_burst = 1;
+};
+
+/**
+ * counts the row buffer outcomes of a DramMemory, accesses spanning multiple rows are
+ * counted once per row
+ *
+ *   row_hits: accesses to the open row of their bank
+ *   row_misses: accesses to a precharged bank, which only activate the row
+ *   row_conflicts: accesses which precharge another open row before the activate
+ */
+struct DramStats {
+    uint64_t row_hits = 0;
+    uint64_t row_misses = 0;
+    uint64_t row_conflicts = 0;
+};
+
+/**
+ * represents a DRAM behind a memory controller. The data is stored like in a
+ * FakeMemory, the latency depends on the state of the row buffers.
+ *
+ * An address is split into (from the most to the least significant part) row, rank,
+ * bank, channel and column, the column is the offset in a row of row_size bytes. So
+ * consecutive rows are spread over the channels first and then over the banks. Each
+ * bank of each rank of each channel has its own row buffer, the banks of a channel
+ * share its data bus.
+ *
+ *   read_latency, write_latency: fixed latency of the controller added to every read
+ *   and write
+ *   burst_size: bytes transferred by one column access, an access to n bursts takes n
+ *   times t_burst on the data bus
+ *   row_policy:
+ *   OPEN_ROW_POLICY: a row stays open after an access until an access to another row
+ *   of its bank precharges it
+ *   CLOSED_ROW_POLICY: a row is precharged as soon as the access and t_ras allow
+ *
+ * Without a timing model (read, write) only the row buffers are modeled: a row hit
+ * takes t_cas, a row miss t_rcd + t_cas and a row conflict t_rp + t_rcd + t_cas plus
+ * the bursts. Accesses spanning multiple rows take the latency of the slowest row.
+ *
+ * In timed mode (read_at, write_at) the controller schedules the commands of every
+ * bank and the transfers on every data bus. Banks work in parallel, t_ras delays the
+ * precharge of a row. The scheduler is FR-FCFS: an access to a row which is still open
+ * is served before older accesses which need another row of the bank, as long as it
+ * doesn't delay them. A timed access reports its completion when it is issued, so the
+ * commands of older accesses are never moved. Accesses are expected in roughly
+ * increasing cycle order, scheduling state which is older than history_cycles before
+ * the newest access is dropped.
+ */
+class DramMemory : public FakeMemory {
+public:
+    DramMemory(const std::string& name, uint64_t size, latency_t read_latency,
+               latency_t write_latency, size_t channels, size_t ranks, size_t banks,
+               size_t row_size, size_t burst_size, DramRowPolicy row_policy,
+               DramTimings timings);
+    DramMemory(const std::string& name, std::shared_ptr<BackingStore> backing_store,
+               latency_t read_latency, latency_t write_latency, size_t channels,
+               size_t ranks, size_t banks, size_t row_size, size_t burst_size,
+               DramRowPolicy row_policy, DramTimings timings);
+
+    DataStorageTransaction write(address_t address, Data& data);
+    DataStorageTransaction read(address_t address, size_t num_bytes);
+
+    DataStorageTransaction write_at(cycle_t cycle, address_t address, Data& data);
+    DataStorageTransaction read_at(cycle_t cycle, address_t address,
+                                   size_t num_bytes);
+
+    size_t get_channels();
+    size_t get_ranks();
+    size_t get_banks();
+    size_t get_row_size();
+    size_t get_burst_size();
+    DramRowPolicy get_row_policy();
+    DramTimings get_timings();
+
+    DramStats get_stats();
+    void reset_stats();
+
+    std::shared_ptr<MemoryInterface> clone();
+
+    void reset();
+
+    static constexpr cycle_t history_cycles = 4096;
+
+private:
+    size_t channels_;
+    size_t ranks_;
+    size_t banks_;
+    size_t row_size_;
+    size_t burst_size_;
+    DramRowPolicy row_policy_;
+    DramTimings timings_;
+
+    // the bank of an address, bank indexes all banks of all ranks and channels
+    struct Location {
+        size_t channel;
+        size_t bank;
+        address_t row;
+    };
+
+    // a row which is open from the activate until the precharge
+    struct RowWindow {
+        address_t row;
+        cycle_t activate_cycle;
+        // cycle in which the next column command can be issued
+        cycle_t column_cycle;
+        // the maximum cycle while no precharge is scheduled
+        cycle_t precharge_cycle;
+    };
+
+    struct Bank {
+        // rows of the bank in timed mode, the newest last
+        std::deque<RowWindow> row_windows;
+        // cycle in which the next activate can be issued if no row is open
+        cycle_t activate_cycle = 0;
+        // open row without a timing model
+        bool row_open = false;
+        address_t open_row = 0;
+    };
+
+    std::vector<Bank> bank_states_;
+    // occupied cycles [begin, end) of the data bus of each channel by begin
+    std::vector<std::map<cycle_t, cycle_t>> data_buses_;
+    cycle_t newest_cycle_ = 0;
+
+    DramStats stats_;
+
+    Location locate(address_t address);
+    size_t count_bursts(address_t address, size_t num_bytes);
+
+    latency_t access(address_t address, size_t num_bytes);
+    cycle_t access_at(cycle_t cycle, address_t address, size_t num_bytes);
+    cycle_t schedule(cycle_t cycle, const Location& location, size_t bursts);
+
+    cycle_t find_data_bus_slot(size_t channel, cycle_t cycle, latency_t cycles);
+    void reserve_data_bus(size_t channel, cycle_t cycle, latency_t cycles);
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef ELF_IMAGE_H
+#define ELF_IMAGE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kachesim/data_storage_transaction.h"
+
+namespace kachesim {
+/**
+ * a loadable segment (PT_LOAD) of an ELF file. Bytes between file_size and memory_size
+ * are BSS and zero filled when the segment is loaded.
+ */
+struct ElfSegment {
+    address_t physical_address;
+    address_t virtual_address;
+    uint64_t file_offset;
+    uint64_t file_size;
+    uint64_t memory_size;
+    bool readable;
+    bool writable;
+    bool executable;
+};
+
+typedef enum ElfSymbolType { ELF_SYMBOL_FUNCTION, ELF_SYMBOL_OBJECT } ElfSymbolType;
+
+/**
+ * a function or object from the symbol table of an ELF file, the address is the
+ * virtual address from the symbol table
+ */
+struct ElfSymbol {
+    std::string name;
+    address_t address;
+    uint64_t size;
+    ElfSymbolType type;
+};
+
+/**
+ * describes an ELF file loaded into a memory. Symbols are sorted by their address.
+ */
+struct ElfImage {
+    address_t entry_point;
+    bool is_64_bit;
+    std::vector<ElfSegment> segments;
+    std::vector<ElfSymbol> symbols;
+};
+}  // namespace kachesim
+
+#endif
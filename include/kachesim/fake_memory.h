@@ -1,16 +1,29 @@
 #ifndef FAKE_MEMORY_H
 #define FAKE_MEMORY_H
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "kachesim/backing_store/backing_store.h"
+#include "kachesim/dirty_page_bitmap.h"
+#include "kachesim/elf_image.h"
 #include "kachesim/memory_interface.h"
 
 namespace kachesim {
+/**
+ * represents a memory with a fixed read and write latency. By default all bytes are
+ * stored in a DenseBackingStore, other backing stores can be passed in. Pages which are
+ * written are tracked, so checkpoints can be dumped incrementally. In concurrent mode
+ * reads and writes are serialized by a lock, the file and debug methods are not.
+ */
 class FakeMemory : public MemoryInterface {
 public:
     FakeMemory(const std::string& name, uint64_t size, latency_t read_latency,
                latency_t write_latency);
+    FakeMemory(const std::string& name, std::shared_ptr<BackingStore> backing_store,
+               latency_t read_latency, latency_t write_latency);
 
     std::string get_name();
     size_t size();
@@ -19,7 +32,8 @@ public:
     DataStorageTransaction read(address_t address, size_t num_bytes);
 
     void read_hex_memory_file(const std::string& memory_file_path,
-                              address_t start_address = 0, address_t end_address = 0);
+                              address_t start_address = 0, address_t end_address = 0,
+                              uint32_t num_threads = 1);
     void write_hex_memory_file(const std::string& memory_file_path,
                                address_t start_address = 0, address_t end_address = 0,
                                uint8_t bytes_per_line = 4);
@@ -29,15 +43,45 @@ public:
     void write_bin_memory_file(const std::string& memory_file_path,
                                address_t start_address = 0, address_t end_address = 0);
 
+    void read_incremental_memory_file(const std::string& memory_file_path);
+    void write_incremental_memory_file(const std::string& memory_file_path);
+
+    ElfImage load_elf(const std::string& elf_file_path);
+
+    size_t get_dirty_page_size();
+    size_t get_dirty_page_count();
+    bool is_page_dirty(address_t address);
+    void clear_dirty_pages();
+
     void set(address_t address, uint8_t);
     uint8_t get(address_t address);
 
+    std::shared_ptr<BackingStore> get_backing_store();
+
+    std::shared_ptr<MemoryInterface> clone();
+
+    void set_concurrent(bool concurrent);
+
     void reset();
 
+protected:
+    DirtyPageBitmap dirty_pages_;
+    bool concurrent_ = false;
+
+    std::shared_ptr<BackingStore> backing_store_;
+
+    std::unique_lock<std::mutex> lock();
+    std::shared_ptr<BackingStore> clone_backing_store(size_t page_size = 4096);
+
 private:
     std::string name_;
     size_t size_;
-    std::vector<uint8_t> data_;
+
+    std::mutex mutex_;
+
+    void check_address_range(const std::string& access, address_t address,
+                             size_t num_bytes);
+    void write_backing_store(address_t address, const uint8_t* data, size_t num_bytes);
 };
 }  // namespace kachesim
 
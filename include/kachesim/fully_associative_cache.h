@@ -0,0 +1,117 @@
+#ifndef FULLY_ASSOCIATIVE_CACHE_H
+#define FULLY_ASSOCIATIVE_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "kachesim/cache_interface.h"
+#include "kachesim/cache_stats.h"
+#include "kachesim/data_storage.h"
+
+namespace kachesim {
+/**
+ * represents a fully associative cache with LRU replacement, e.g. a TLB or a small L0
+ * cache. Every block can be stored in every entry. Entries are found through a hash
+ * index from tag to entry and the LRU order is kept in a doubly linked list of entry
+ * indices, so an access costs the same for any number of entries.
+ *
+ *   entries: number of blocks the cache holds
+ *
+ *   write_allocate, write_through: see SetAssociativeCache
+ *
+ *   if an access spans multiple blocks the latencies of the blocks are summed up
+ *
+ *   concurrent: (=true) reads and writes may be called from multiple threads at once,
+ *   the whole cache is locked for each access
+ */
+class FullyAssociativeCache : public CacheInterface {
+public:
+    FullyAssociativeCache(const std::string& name,
+                          std::shared_ptr<DataStorage> next_level_data_storage,
+                          bool write_allocate, bool write_through,
+                          latency_t miss_latency, latency_t hit_latency,
+                          size_t cache_block_size, size_t entries);
+
+    std::string get_name();
+    size_t size();
+    size_t get_address_space_size();
+
+    DataStorageTransaction write(address_t address, Data& data);
+    DataStorageTransaction read(address_t address, size_t num_bytes);
+    DataStorageTransaction flush();
+
+    std::shared_ptr<CacheInterface> clone(
+        std::shared_ptr<DataStorage> next_level_data_storage);
+
+    latency_t get_hit_latency();
+    latency_t get_miss_latency();
+    void set_hit_latency(latency_t hit_latency);
+    void set_miss_latency(latency_t miss_latency);
+
+    size_t get_entries();
+    size_t get_valid_entry_count();
+
+    bool is_address_cached(address_t address);
+    bool is_address_dirty(address_t address);
+
+    uint8_t get(address_t address);
+
+    size_t get_dirty_block_count();
+
+    CacheStats get_stats();
+    void reset_stats();
+
+    void set_concurrent(bool concurrent);
+
+    void reset();
+
+private:
+    static constexpr uint32_t no_entry_ = UINT32_MAX;
+
+    std::string name_;
+    std::shared_ptr<DataStorage> next_level_data_storage_;
+
+    bool write_allocate_;
+    bool write_through_;
+
+    latency_t miss_latency_;
+    latency_t hit_latency_;
+
+    size_t cache_block_size_;
+    size_t entries_;
+    uint32_t offset_bits_;
+
+    // entry i holds the block with tags_[i], its data starts at i * cache_block_size_
+    std::vector<uint8_t> data_;
+    std::vector<address_t> tags_;
+    std::vector<bool> dirty_;
+    std::unordered_map<address_t, uint32_t> tag_index_;
+    size_t dirty_blocks_ = 0;
+
+    // LRU order of the valid entries, head_ is the most recently used entry
+    std::vector<uint32_t> previous_;
+    std::vector<uint32_t> next_;
+    uint32_t head_ = no_entry_;
+    uint32_t tail_ = no_entry_;
+
+    CacheStats stats_;
+
+    bool concurrent_ = false;
+    std::mutex mutex_;
+
+    std::unique_lock<std::mutex> lock();
+
+    uint32_t find_entry(address_t tag);
+    void unlink_entry(uint32_t entry);
+    void touch_entry(uint32_t entry);
+    uint32_t allocate_entry(address_t tag, latency_t& latency);
+
+    DataStorageTransaction aligned_write(address_t address, Data& data);
+    DataStorageTransaction aligned_read(address_t address, size_t num_bytes);
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef HIERARCHY_BUILDER_H
+#define HIERARCHY_BUILDER_H
+
+#include <memory>
+
+#include "kachesim/backing_store/backing_store.h"
+#include "kachesim/hierarchy_config.h"
+#include "kachesim/memory_hierarchy.h"
+
+namespace kachesim {
+/**
+ * builds a memory hierarchy from typed configs without going through yaml, e.g.
+ *
+ *   auto memory_hierarchy = HierarchyBuilder()
+ *                               .memory(memory_config)
+ *                               .cache(l2_config)
+ *                               .cache(l1_config)
+ *                               .build();
+ *
+ * the order in which memories and caches are added doesn't matter
+ */
+class HierarchyBuilder {
+public:
+    HierarchyBuilder();
+    HierarchyBuilder(const HierarchyConfig& config);
+
+    HierarchyBuilder& memory(const MemoryConfig& memory_config);
+    HierarchyBuilder& cache(const CacheConfig& cache_config);
+    HierarchyBuilder& coherence(const CoherenceConfig& coherence_config);
+    HierarchyBuilder& base_image(std::shared_ptr<const BackingStore> base_image);
+
+    const HierarchyConfig& get_config() const;
+
+    std::unique_ptr<MemoryHierarchy> build() const;
+
+private:
+    HierarchyConfig config_;
+    std::shared_ptr<const BackingStore> base_image_;
+};
+}  // namespace kachesim
+
+#endif
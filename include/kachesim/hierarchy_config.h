@@ -0,0 +1,141 @@
+#ifndef HIERARCHY_CONFIG_H
+#define HIERARCHY_CONFIG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kachesim/coherence_directory.h"
+#include "kachesim/data_storage_transaction.h"
+#include "kachesim/dram_memory.h"
+#include "kachesim/index_function.h"
+#include "kachesim/prefetcher/prefetcher.h"
+#include "kachesim/replacement_policy/replacement_policy.h"
+#include "kachesim/skewed_associative_cache.h"
+#include "kachesim/write_buffer.h"
+
+namespace kachesim {
+typedef enum MemoryType { FAKE_MEMORY, SPARSE_MEMORY, DRAM_MEMORY } MemoryType;
+typedef enum CacheType {
+    SET_ASSOCIATIVE_CACHE,
+    FULLY_ASSOCIATIVE_CACHE,
+    SKEWED_ASSOCIATIVE_CACHE
+} CacheType;
+
+/**
+ * configuration of a memory in a memory hierarchy
+ *
+ *   size: size of the memory in bytes, optional (= 0) if an image is given
+ *   image: path of a binary image mapped copy-on-write into a FakeMemory or DramMemory
+ *   page_size: size of the pages of a SparseMemory
+ *   channels, ranks, banks, row_size, burst_size, row_policy, dram_timings:
+ *   organization and timing of a DramMemory, see DramMemory
+ */
+struct MemoryConfig {
+    std::string name;
+    MemoryType type = FAKE_MEMORY;
+    uint64_t size = 0;
+    latency_t read_latency = 0;
+    latency_t write_latency = 0;
+    std::string image;
+    size_t page_size = 4096;
+    size_t channels = 1;
+    size_t ranks = 1;
+    size_t banks = 8;
+    size_t row_size = 2048;
+    size_t burst_size = 64;
+    DramRowPolicy row_policy = OPEN_ROW_POLICY;
+    DramTimings dram_timings;
+
+    void validate() const;
+};
+
+/**
+ * configuration of a cache in a memory hierarchy, see SetAssociativeCache for the
+ * meaning of the parameters. A FullyAssociativeCache has one set, its entries are
+ * given as ways. A SkewedAssociativeCache uses skewed_replacement_policy instead of
+ * replacement_policy. Multi block access, MSHRs, index function, sectors, write no
+ * fetch, prefetcher, victim cache, write buffer and banks only apply to a
+ * SetAssociativeCache.
+ *
+ *   skewed_replacement_policy: replacement of a SkewedAssociativeCache
+ *   index_function: maps addresses to sets, see IndexFunction
+ *   sectors: number of sectors per block, a sectored cache can't have a victim cache
+ *   write_no_fetch: partial write misses don't load the block, can't be combined with
+ *   sectors or a victim cache
+ *   prefetcher: type of the prefetcher attached to the cache
+ *   prefetch_degree: number of blocks the prefetcher prefetches ahead
+ *   victim_cache_size: size of the victim cache in bytes, 0 if the cache has none
+ *   victim_cache_latency: latency of a hit in the victim cache
+ *   write_buffer_entries: number of write buffer entries, 0 if the cache has none
+ *   write_buffer_granularity: size of a write buffer entry, 0 uses cache_block_size
+ *   write_buffer_drain_policy: when the write buffer drains, see WriteBuffer
+ *   banks: number of banks, 0 if the cache isn't banked, see CacheBanks
+ *   bank_width: bytes per bank unit, 0 uses cache_block_size
+ *   bank_busy_cycles: cycles a bank is busy per accessed unit
+ *   bank_function: selects the bank of a unit, see IndexFunction
+ */
+struct CacheConfig {
+    std::string name;
+    CacheType type = SET_ASSOCIATIVE_CACHE;
+    std::string next_level_data_storage;
+    bool write_allocate = true;
+    bool write_through = false;
+    latency_t miss_latency = 0;
+    latency_t hit_latency = 0;
+    size_t cache_block_size = 64;
+    size_t sets = 1;
+    size_t ways = 1;
+    ReplacementPolicyType replacement_policy = ReplacementPolicyType::LRU;
+    SkewedReplacementPolicyType skewed_replacement_policy = SKEWED_LRU;
+    size_t multi_block_access = 1;
+    size_t mshrs = 0;
+    IndexFunctionType index_function = MODULO_INDEX;
+    size_t sectors = 1;
+    bool write_no_fetch = false;
+    PrefetcherType prefetcher = NO_PREFETCHER;
+    size_t prefetch_degree = 1;
+    size_t victim_cache_size = 0;
+    latency_t victim_cache_latency = 0;
+    size_t write_buffer_entries = 0;
+    size_t write_buffer_granularity = 0;
+    WriteBufferDrainPolicy write_buffer_drain_policy = DRAIN_EAGER;
+    size_t banks = 0;
+    size_t bank_width = 0;
+    latency_t bank_busy_cycles = 1;
+    IndexFunctionType bank_function = MODULO_INDEX;
+
+    void validate() const;
+};
+
+/**
+ * configuration of the coherence between the first level caches, see
+ * CoherenceDirectory. All first level caches must share the same next level data
+ * storage and cache block size.
+ */
+struct CoherenceConfig {
+    bool enabled = false;
+    CoherenceProtocol protocol = MESI;
+    latency_t lookup_latency = 0;
+    latency_t snoop_latency = 0;
+};
+
+/**
+ * configuration of a whole memory hierarchy. Caches form a graph by pointing to their
+ * next level data storage, memories are the roots of this graph.
+ */
+struct HierarchyConfig {
+    std::vector<MemoryConfig> memories;
+    std::vector<CacheConfig> caches;
+    CoherenceConfig coherence;
+
+    void validate() const;
+    std::vector<std::string> get_topological_order() const;
+    void validate_coherence() const;
+
+    static HierarchyConfig from_yaml(const std::string& yaml_config_string);
+};
+}  // namespace kachesim
+
+#endif
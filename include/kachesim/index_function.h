@@ -0,0 +1,99 @@
+#ifndef INDEX_FUNCTION_H
+#define INDEX_FUNCTION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "kachesim/data_storage_transaction.h"
+
+typedef enum IndexFunctionType {
+    MODULO_INDEX,
+    XOR_INDEX,
+    PRIME_MODULO_INDEX,
+    SKEWED_INDEX
+} IndexFunctionType;
+
+namespace kachesim {
+/**
+ * maps the block address (address / cache block size) of an access to a set index and
+ * a tag. The mapping is invertible, the block address of a cached block is restored
+ * from its index and tag.
+ *
+ * The block address is split into quotient and remainder of the division by the
+ * number of indexable sets. The quotient is the tag, the remainder plus a hash of the
+ * tag (modulo the number of indexable sets) is the index. Any number of sets is
+ * supported, for a power of two MODULO_INDEX is the classic bit slicing.
+ *
+ *   MODULO_INDEX: no hash, the index is the remainder
+ *   XOR_INDEX: the hash XOR-folds the upper tag bits in chunks of log2(sets) bits
+ *   PRIME_MODULO_INDEX: like MODULO_INDEX but divides by the largest prime which
+ *   isn't larger than the number of sets, the remaining sets stay unused
+ *   SKEWED_INDEX: the hash multiplies the tag with a constant chosen by skew, so
+ *   index functions with different skews disperse conflicting blocks differently
+ *
+ * The division uses a precomputed 128 bit reciprocal, index, tag and block_address
+ * are branch-free.
+ */
+class IndexFunction {
+public:
+    IndexFunction(IndexFunctionType type, size_t sets, size_t skew = 0);
+
+    IndexFunctionType get_type() const;
+    size_t get_sets() const;
+    size_t get_indexable_sets() const;
+
+    address_t index(address_t block_address) const {
+        address_t tag = divide(block_address);
+        address_t remainder = block_address - tag * divisor_;
+        return wrap(remainder + hash(tag));
+    }
+
+    address_t tag(address_t block_address) const { return divide(block_address); }
+
+    address_t block_address(address_t index, address_t tag) const {
+        return tag * divisor_ + wrap(index + divisor_ - hash(tag));
+    }
+
+private:
+    IndexFunctionType type_;
+    size_t sets_;
+    size_t skew_;
+
+    address_t divisor_;
+    // ceil(2^128 / divisor_), 0 if divisor_ is 1
+    unsigned __int128 reciprocal_;
+    // all ones if divisor_ is 1, the quotient is then the dividend itself
+    address_t identity_mask_;
+
+    uint32_t fold_shift_;
+    address_t xor_mask_;
+    address_t skew_multiplier_;
+    address_t skew_mask_;
+
+    // floor(x / divisor_) as the upper 64 bits of the 192 bit product x * reciprocal_
+    address_t divide(address_t x) const {
+        unsigned __int128 x_wide = x;
+        unsigned __int128 low = static_cast<uint64_t>(reciprocal_) * x_wide;
+        unsigned __int128 high = static_cast<uint64_t>(reciprocal_ >> 64) * x_wide;
+        address_t quotient = static_cast<address_t>((high + (low >> 64)) >> 64);
+        return quotient | (x & identity_mask_);
+    }
+
+    // maps a value in [0, 2 * divisor_) to [0, divisor_)
+    address_t wrap(address_t x) const {
+        return x - (divisor_ & -static_cast<address_t>(x >= divisor_));
+    }
+
+    // hash of the tag in [0, divisor_)
+    address_t hash(address_t tag) const {
+        address_t fold = tag ^ (tag >> fold_shift_) ^ (tag >> (2 * fold_shift_));
+        address_t mix = tag * skew_multiplier_;
+        mix ^= mix >> 32;
+
+        address_t hash = (fold & xor_mask_) ^ (mix & skew_mask_);
+        return hash - divide(hash) * divisor_;
+    }
+};
+}  // namespace kachesim
+
+#endif
@@ -3,18 +3,45 @@
 
 namespace kachesim {}
 
+// the coroutine API needs C++20
+#if defined(__cpp_impl_coroutine)
+#include "kachesim/async_memory_hierarchy.h"
+#endif
+#include "kachesim/backing_store/backing_store.h"
+#include "kachesim/backing_store/cow_backing_store.h"
+#include "kachesim/backing_store/dense_backing_store.h"
+#include "kachesim/backing_store/mapped_backing_store.h"
+#include "kachesim/backing_store/sparse_backing_store.h"
+#include "kachesim/cache_banks.h"
 #include "kachesim/cache_block.h"
 #include "kachesim/cache_interface.h"
 #include "kachesim/cache_set.h"
+#include "kachesim/cache_stats.h"
+#include "kachesim/coherence_directory.h"
 #include "kachesim/common.h"
 #include "kachesim/data.h"
 #include "kachesim/data_storage_transaction.h"
+#include "kachesim/dirty_page_bitmap.h"
 #include "kachesim/doubly_linked_list/doubly_linked_list.h"
+#include "kachesim/dram_memory.h"
+#include "kachesim/elf_image.h"
 #include "kachesim/fake_memory.h"
+#include "kachesim/fully_associative_cache.h"
+#include "kachesim/hierarchy_builder.h"
+#include "kachesim/hierarchy_config.h"
+#include "kachesim/index_function.h"
 #include "kachesim/memory_hierarchy.h"
 #include "kachesim/memory_interface.h"
+#include "kachesim/prefetcher/next_line_prefetcher.h"
+#include "kachesim/prefetcher/prefetcher.h"
+#include "kachesim/prefetcher/stream_prefetcher.h"
+#include "kachesim/prefetcher/stride_prefetcher.h"
 #include "kachesim/replacement_policy/least_recently_used.h"
 #include "kachesim/replacement_policy/replacement_policy.h"
 #include "kachesim/set_associative_cache.h"
+#include "kachesim/skewed_associative_cache.h"
+#include "kachesim/sparse_memory.h"
+#include "kachesim/victim_cache.h"
+#include "kachesim/write_buffer.h"
 
 #endif
@@ -1,43 +1,105 @@
 #ifndef MEMORY_HIERARCHY_H
 #define MEMORY_HIERARCHY_H
 
-#include <yaml-cpp/yaml.h>
-
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "kachesim/backing_store/backing_store.h"
 #include "kachesim/data_storage.h"
 #include "kachesim/data_storage_transaction.h"
+#include "kachesim/dram_memory.h"
 #include "kachesim/fake_memory.h"
+#include "kachesim/fully_associative_cache.h"
+#include "kachesim/hierarchy_config.h"
 #include "kachesim/set_associative_cache.h"
+#include "kachesim/skewed_associative_cache.h"
+#include "kachesim/sparse_memory.h"
 
 namespace kachesim {
+/**
+ * represents a memory hierarchy of caches and memories. Caches can share a next level
+ * data storage, so the hierarchy can be any DAG (e.g. split L1 instruction and data
+ * caches per core in front of a shared L2). Every cache which isn't the next level of
+ * another cache is a first level cache and accessible through its own port, ports are
+ * numbered in the order of the config. If coherence is enabled in the config the first
+ * level caches are kept coherent by a CoherenceDirectory, the id of each cache in the
+ * directory is its port.
+ *
+ * In timed mode accesses are issued in the current cycle of a global clock and return
+ * the cycle in which they complete, see SetAssociativeCache for the non-blocking
+ * timing model with MSHRs.
+ */
 class MemoryHierarchy {
 public:
     MemoryHierarchy();
     MemoryHierarchy(const std::string& yaml_config_string);
+    MemoryHierarchy(const std::string& yaml_config_string,
+                    std::shared_ptr<const BackingStore> base_image);
+    MemoryHierarchy(const HierarchyConfig& config,
+                    std::shared_ptr<const BackingStore> base_image = nullptr);
     DataStorageTransaction write(address_t address, Data& data);
     DataStorageTransaction read(address_t address, size_t num_bytes);
+    DataStorageTransaction write(size_t port, address_t address, Data& data);
+    DataStorageTransaction read(size_t port, address_t address, size_t num_bytes);
     DataStorageTransaction flush_all_caches();
 
+    size_t get_port_count() const;
+    const std::vector<std::string>& get_port_names() const;
+    size_t get_port(const std::string& name) const;
+
+    void set_timed(bool timed);
+    bool is_timed() const;
+    cycle_t get_cycle() const;
+    void advance(cycle_t cycles);
+    void advance_to(cycle_t cycle);
+
     std::shared_ptr<MemoryInterface> top_level_memory;
 
+    std::shared_ptr<DataStorage> get_data_storage(const std::string& name);
+    const HierarchyConfig& get_config() const;
+    std::shared_ptr<CoherenceDirectory> get_coherence_directory();
+
+    std::unique_ptr<MemoryHierarchy> clone();
+
+    void set_concurrent(bool concurrent);
+
     void reset();
 
 private:
+    HierarchyConfig config_;
+
     std::vector<std::string> data_storage_names_;
     std::map<std::string, std::string> data_storage_type_map_;
     std::map<std::string, std::string> data_storage_dependency_map_;
     std::map<std::string, std::shared_ptr<DataStorage>> data_storage_map_;
 
-    std::shared_ptr<FakeMemory> fake_memory_from_yaml_node_(
-        const YAML::Node& yaml_node);
-    std::shared_ptr<SetAssociativeCache> set_associative_cache_from_yaml_node_(
-        const YAML::Node& yaml_node,
+    // image shared copy-on-write with other hierarchies, nullptr if not shared
+    std::shared_ptr<const BackingStore> base_image_;
+
+    std::shared_ptr<MemoryInterface> memory_from_config_(const MemoryConfig& config);
+    std::shared_ptr<CacheInterface> cache_from_config_(
+        const CacheConfig& config,
         std::shared_ptr<DataStorage> next_level_data_storage);
 
-    std::shared_ptr<CacheInterface> first_level_cache_;
+    // first level caches in the order of the config, the index is the port
+    std::vector<std::string> port_names_;
+    std::vector<std::shared_ptr<CacheInterface>> first_level_caches_;
+
+    // nullptr if coherence isn't enabled
+    std::shared_ptr<CoherenceDirectory> coherence_directory_;
+
+    // global clock of the timed mode
+    bool timed_ = false;
+    cycle_t cycle_ = 0;
+
+    // if ports may be accessed by different threads
+    bool concurrent_ = false;
+
+    void init_ports_();
+    void init_coherence_(std::shared_ptr<CoherenceDirectory> coherence_directory);
+    CacheInterface* get_first_level_cache_(size_t port);
 };
 }  // namespace kachesim
 
@@ -1,6 +1,8 @@
 #ifndef MEMORY_INTERFACE_H
 #define MEMORY_INTERFACE_H
 
+#include <memory>
+
 #include "kachesim/data_storage.h"
 
 namespace kachesim {
@@ -20,6 +22,13 @@ public:
     virtual void set(address_t address, uint8_t) = 0;
     virtual uint8_t get(address_t address) = 0;
 
+    virtual std::shared_ptr<MemoryInterface> clone() = 0;
+
+    latency_t get_read_latency() { return read_latency_; }
+    latency_t get_write_latency() { return write_latency_; }
+    void set_read_latency(latency_t read_latency) { read_latency_ = read_latency; }
+    void set_write_latency(latency_t write_latency) { write_latency_ = write_latency; }
+
     virtual void reset() = 0;
 
 protected:
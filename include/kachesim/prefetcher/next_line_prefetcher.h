@@ -0,0 +1,24 @@
+#ifndef NEXT_LINE_PREFETCHER_H
+#define NEXT_LINE_PREFETCHER_H
+
+#include "prefetcher.h"
+
+namespace kachesim {
+/**
+ * prefetches the degree blocks following a block which missed
+ */
+class NextLinePrefetcher : public Prefetcher {
+public:
+    NextLinePrefetcher(size_t cache_block_size, size_t degree = 1);
+
+    std::vector<address_t> access(address_t pc, address_t address, bool miss);
+    std::shared_ptr<Prefetcher> clone();
+    void reset();
+
+private:
+    size_t cache_block_size_;
+    size_t degree_;
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "kachesim/data_storage_transaction.h"
+
+typedef enum PrefetcherType {
+    NO_PREFETCHER,
+    NEXT_LINE_PREFETCHER,
+    STRIDE_PREFETCHER,
+    STREAM_PREFETCHER
+} PrefetcherType;
+
+namespace kachesim {
+/**
+ * predicts which blocks a cache should load before they are accessed. The cache
+ * reports every demand access to the prefetcher, which returns the addresses of the
+ * blocks to prefetch. The cache drops blocks which are already cached or for which no
+ * MSHR is free.
+ */
+class Prefetcher {
+public:
+    virtual ~Prefetcher() = 0;
+
+    /**
+     * @param pc the program counter of the access, 0 if unknown
+     * @param address the address of the access
+     * @param miss if the access missed or hit a block that was prefetched but not
+     * accessed yet, i.e. if it would have missed without prefetching
+     * @return the addresses of the blocks to prefetch
+     */
+    virtual std::vector<address_t> access(address_t pc, address_t address,
+                                          bool miss) = 0;
+
+    virtual std::shared_ptr<Prefetcher> clone() = 0;
+
+    virtual void reset() = 0;
+
+    static std::shared_ptr<Prefetcher> create(PrefetcherType type,
+                                              size_t cache_block_size, size_t degree);
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef STREAM_PREFETCHER_H
+#define STREAM_PREFETCHER_H
+
+#include "prefetcher.h"
+
+namespace kachesim {
+struct StreamBuffer {
+    bool valid = false;
+    // the last block accessed by the stream and the next block to prefetch, in blocks
+    address_t last_block = 0;
+    address_t next_block = 0;
+    // +1 for ascending, -1 for descending and 0 while the direction is unknown
+    int64_t direction = 0;
+    uint64_t last_use = 0;
+};
+
+/**
+ * tracks sequential streams of blocks in stream buffers. A miss outside of all streams
+ * allocates the least recently used buffer, a second miss to an adjacent block sets
+ * the direction of the stream. Afterwards every access within the stream keeps the
+ * prefetches degree blocks ahead of it.
+ *
+ *   streams: number of stream buffers
+ */
+class StreamPrefetcher : public Prefetcher {
+public:
+    StreamPrefetcher(size_t cache_block_size, size_t degree = 1, size_t streams = 8);
+
+    std::vector<address_t> access(address_t pc, address_t address, bool miss);
+    std::shared_ptr<Prefetcher> clone();
+    void reset();
+
+private:
+    size_t cache_block_size_;
+    size_t degree_;
+    std::vector<StreamBuffer> streams_;
+    uint64_t accesses_ = 0;
+
+    bool is_in_stream(const StreamBuffer& stream, address_t block);
+    std::vector<address_t> advance(StreamBuffer& stream, address_t block);
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef STRIDE_PREFETCHER_H
+#define STRIDE_PREFETCHER_H
+
+#include "prefetcher.h"
+
+namespace kachesim {
+struct StridePrefetcherEntry {
+    bool valid = false;
+    address_t pc = 0;
+    address_t last_address = 0;
+    int64_t stride = 0;
+    uint32_t confidence = 0;
+};
+
+/**
+ * detects constant strides between the accesses of each instruction. The strides are
+ * tracked in a direct mapped table indexed by the program counter. Once the same
+ * stride was seen twice in a row the blocks of the next degree accesses are
+ * prefetched. Accesses without a program counter share the entry of pc 0.
+ *
+ *   table_size: number of entries of the table
+ */
+class StridePrefetcher : public Prefetcher {
+public:
+    StridePrefetcher(size_t cache_block_size, size_t degree = 1,
+                     size_t table_size = 256);
+
+    std::vector<address_t> access(address_t pc, address_t address, bool miss);
+    std::shared_ptr<Prefetcher> clone();
+    void reset();
+
+private:
+    static constexpr uint32_t max_confidence_ = 3;
+
+    size_t cache_block_size_;
+    size_t degree_;
+    std::vector<StridePrefetcherEntry> table_;
+};
+}  // namespace kachesim
+
+#endif
@@ -16,6 +16,7 @@ public:
     void update(uint32_t index);
     uint32_t get_replacement_index();
     void remove(uint32_t index);
+    std::shared_ptr<ReplacementPolicy> clone();
 
     std::string to_string();
 
@@ -2,6 +2,7 @@
 #define REPLACEMENT_POLICY_H
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
 typedef enum ReplacementPolicyType { LRU } ReplacementPolicyType;
@@ -12,6 +13,7 @@ public:
     virtual ~ReplacementPolicy() = 0;
     virtual void update(uint32_t index) = 0;
     virtual uint32_t get_replacement_index() = 0;
+    virtual std::shared_ptr<ReplacementPolicy> clone() = 0;
 
     virtual std::string to_string() = 0;
 };
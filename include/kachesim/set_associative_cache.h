@@ -3,10 +3,21 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "kachesim/cache_banks.h"
 #include "kachesim/cache_interface.h"
 #include "kachesim/cache_set.h"
+#include "kachesim/cache_stats.h"
+#include "kachesim/coherence_directory.h"
 #include "kachesim/data_storage.h"
+#include "kachesim/index_function.h"
+#include "kachesim/prefetcher/prefetcher.h"
+#include "kachesim/victim_cache.h"
+#include "kachesim/write_buffer.h"
 
 /**
  * represents a set-associative cache
@@ -63,6 +74,11 @@
  *
  *   ways: is the number of blocks per set
  *
+ *   sets: doesn't need to be a power of two
+ *
+ *   index_function_type: how the set index and the tag are derived from the address,
+ *   see IndexFunction
+ *
  *   write_allocate: (=true) if a write miss occurs the data is loaded into the matching
  *   cache blocks. (=false) data is only forwarded to the next level data storage
  *
@@ -74,6 +90,67 @@
  *   n = 1: sequential access: if multiple blocks are accessed the latency is summed up
  *   n > 1: parallel access: if multiple blocks are accessed the latency of max of n
  *   consecutive transactions is taken and than summed up
+ *
+ *   concurrent: (=true) reads and writes may be called from multiple threads at once.
+ *   Each access locks the stripe of sets it touches, so accesses to different sets
+ *   proceed in parallel. Stats are counted in per-thread shards. flush and reset must
+ *   not run concurrently with other accesses.
+ *
+ *   coherence_directory: private caches sharing a next level data storage can be kept
+ *   coherent by a CoherenceDirectory. Misses, writes and evictions are then reported to
+ *   the directory, which snoops the other caches if needed. The coherence actions are
+ *   reported in the DataStorageTransaction.
+ *
+ *   mshrs: number of misses which can be outstanding at once in timed mode (read_at,
+ *   write_at), 0 means unlimited. Timed accesses don't block the cache: hits are served
+ *   while misses are outstanding and accesses to a block with an outstanding miss are
+ *   merged into its MSHR. If all MSHRs are in use a miss waits for the first one to
+ *   become free. The blocks of an access are issued in parallel. Write backs and writes
+ *   to the next level are posted and don't delay the access. In concurrent mode every
+ *   thread issues its timed accesses in its own cycles, the threads share the MSHRs,
+ *   so their cycles should stay close to each other.
+ *
+ *   prefetcher: is trained on every demand access and loads the blocks it predicts
+ *   through the same path as a read miss, but without delaying the access. In timed
+ *   mode a prefetch occupies an MSHR until it completes and is dropped if no MSHR is
+ *   free. The program counter passed to the prefetcher is set by set_program_counter.
+ *   Prefetching isn't supported in concurrent mode.
+ *
+ *   sectors: number of sectors a block is divided into (power of two, at most 64).
+ *   Every sector has its own valid and dirty bit. A miss only loads the accessed
+ *   sectors which aren't valid, a write only loads the partially written sectors and
+ *   a write back only writes the dirty sectors. An access to a cached block with an
+ *   accessed sector which isn't valid counts as miss and as sector miss. Sectored
+ *   caches can't have a victim cache or be kept coherent.
+ *
+ *   write_no_fetch: (=false) a partial write miss allocates the block without loading
+ *   it from the next level data storage, a valid bit per byte tracks the written
+ *   bytes. A read of a byte which isn't valid loads the block and merges it with the
+ *   written bytes, it counts as read miss and as deferred fill. A write back of a block
+ *   which wasn't loaded only writes the written bytes. Caches without fetch on write
+ *   can't be sectored, have a victim cache or be kept coherent.
+ *
+ *   victim_cache: holds the blocks evicted from the cache. A miss which hits in the
+ *   victim cache takes the block back and counts as hit on this level with the miss
+ *   latency plus the latency of the victim cache, a miss in the victim cache goes to
+ *   the next level data storage without additional latency. Dirty blocks are only
+ *   written back when they leave the victim cache. Victim caches aren't supported in
+ *   concurrent mode or for coherent caches.
+ *
+ *   write_buffer: absorbs all writes to the next level data storage (write throughs,
+ *   write backs and writes which aren't allocated), see WriteBuffer. A buffered write
+ *   only adds latency if it has to wait for a free entry, reads from the next level
+ *   see the buffered bytes. In timed mode eager drains start in the cycle the next
+ *   level becomes free. Flushing drains the buffer. Write buffers aren't supported in
+ *   concurrent mode or for coherent caches.
+ *
+ *   banks: divide the cache into banks, see CacheBanks. The latency of an access
+ *   spanning multiple blocks is then derived from the banks instead of
+ *   multi_block_access: blocks in different banks are accessed in parallel, blocks in
+ *   the same bank one after the other. In timed mode the banks stay busy across
+ *   accesses, so back-to-back accesses to the same bank serialize as well. The wait
+ *   for a busy bank is added to the latency of a block access, it doesn't delay its
+ *   miss. Banks aren't supported in concurrent mode.
  */
 namespace kachesim {
 class SetAssociativeCache : public CacheInterface {
@@ -83,15 +160,33 @@ public:
                         bool write_allocate, bool write_through, latency_t miss_latency,
                         latency_t hit_latency, size_t cache_block_size, size_t sets,
                         size_t ways, ReplacementPolicyType replacement_policy_type,
-                        size_t multi_block_access = 1);
+                        size_t multi_block_access = 1, size_t mshrs = 0,
+                        IndexFunctionType index_function_type = MODULO_INDEX,
+                        size_t sectors = 1, bool write_no_fetch = false);
 
     std::string get_name();
     size_t size();
+    size_t get_address_space_size();
 
     DataStorageTransaction write(address_t address, Data& data);
     DataStorageTransaction read(address_t address, size_t num_bytes);
+    DataStorageTransaction write_at(cycle_t cycle, address_t address, Data& data);
+    DataStorageTransaction read_at(cycle_t cycle, address_t address, size_t num_bytes);
     DataStorageTransaction flush();
 
+    std::shared_ptr<CacheInterface> clone(
+        std::shared_ptr<DataStorage> next_level_data_storage);
+
+    latency_t get_hit_latency();
+    latency_t get_miss_latency();
+    void set_hit_latency(latency_t hit_latency);
+    void set_miss_latency(latency_t miss_latency);
+
+    size_t get_mshrs();
+    size_t get_sectors();
+    bool get_write_no_fetch();
+    size_t get_outstanding_miss_count(cycle_t cycle);
+
     bool is_address_cached(address_t address);
     bool is_address_valid(address_t address);
     bool is_address_dirty(address_t address);
@@ -103,9 +198,37 @@ public:
     bool is_cache_block_valid(address_t cache_set_index, address_t block_index);
     bool is_cache_block_dirty(address_t cache_set_index, address_t block_index);
 
+    size_t get_dirty_block_count();
+
+    CacheStats get_stats();
+    void reset_stats();
+
+    void set_concurrent(bool concurrent);
+    bool is_concurrent();
+
+    void set_coherence_directory(std::shared_ptr<CoherenceDirectory> directory,
+                                 size_t coherence_id);
+    latency_t snoop(address_t address, bool invalidate, bool write_back, Data* data);
+
+    void set_prefetcher(std::shared_ptr<Prefetcher> prefetcher);
+    std::shared_ptr<Prefetcher> get_prefetcher();
+    void set_program_counter(address_t pc);
+
+    void set_victim_cache(std::shared_ptr<VictimCache> victim_cache);
+    std::shared_ptr<VictimCache> get_victim_cache();
+
+    void set_write_buffer(std::shared_ptr<WriteBuffer> write_buffer);
+    std::shared_ptr<WriteBuffer> get_write_buffer();
+
+    void set_banks(std::shared_ptr<CacheBanks> banks);
+    std::shared_ptr<CacheBanks> get_banks();
+
     void reset();
 
 private:
+    SetAssociativeCache(const SetAssociativeCache& cache,
+                        std::shared_ptr<DataStorage> next_level_data_storage);
+
     std::string name_;
 
     bool write_allocate_;
@@ -118,31 +241,165 @@ private:
     size_t sets_;
     size_t ways_;
     size_t multi_block_access_;
+    size_t mshrs_;
+    size_t sectors_;
+    size_t sector_size_;
+    uint32_t sector_bits_;
+    bool write_no_fetch_;
 
     address_t offset_mask_;
-    address_t index_mask_;
-    address_t tag_mask_;
+    uint32_t offset_bits_;
+    IndexFunction index_function_;
     ReplacementPolicyType replacement_policy_type_;
 
     std::vector<std::unique_ptr<CacheSet>> cache_sets_;
 
+    // blocks are only valid if they were updated in the current generation
+    uint64_t generation_ = 0;
+
+    // bit i is set if cache set i contains at least one dirty block
+    std::vector<uint64_t> dirty_sets_;
+    size_t dirty_blocks_ = 0;
+
     std::shared_ptr<DataStorage> next_level_data_storage_;
 
+    static constexpr size_t max_set_locks_ = 1024;
+    static constexpr size_t stats_shard_count_ = 64;
+
+    bool concurrent_ = false;
+    // set i is protected by lock i % set_lock_count_
+    size_t set_lock_count_ = 0;
+    std::unique_ptr<std::mutex[]> set_locks_;
+    std::vector<CacheStatsShard> stats_shards_ = std::vector<CacheStatsShard>(1);
+
+    std::unique_lock<std::mutex> lock_set(address_t index);
+    void count(uint64_t CacheStats::*counter, uint64_t amount = 1);
+
+    // nullptr if the cache isn't kept coherent
+    std::shared_ptr<CoherenceDirectory> coherence_directory_;
+    size_t coherence_id_ = 0;
+
+    DataStorageTransaction read_next_level_block(address_t address, bool write,
+                                                 CoherenceTransaction& coherence,
+                                                 bool& dirty);
+    void request_write(address_t address, bool allocate,
+                       CoherenceTransaction& coherence);
+    latency_t evict_block(address_t index, uint32_t block_index);
+
+    // nullptr if the cache has no victim cache
+    std::shared_ptr<VictimCache> victim_cache_;
+
+    latency_t drop_victim_block(address_t address);
+
+    // nullptr if the cache has no write buffer
+    std::shared_ptr<WriteBuffer> write_buffer_;
+
+    DataStorageTransaction write_to_buffer(address_t address, Data& data);
+    latency_t drain_write_buffer_entry(WriteBufferEntry& entry, cycle_t cycle);
+    latency_t free_write_buffer_entry(cycle_t cycle);
+    void advance_write_buffer(cycle_t cycle);
+    latency_t drain_write_buffer();
+
+    // nullptr if the cache isn't banked
+    std::shared_ptr<CacheBanks> banks_;
+
+    latency_t calculate_banked_access_latency(
+        const std::vector<std::pair<address_t, size_t>>& accesses,
+        const std::vector<latency_t>& latencies);
+
+    // nullptr if the cache doesn't prefetch
+    std::shared_ptr<Prefetcher> prefetcher_;
+    address_t program_counter_ = 0;
+    // blocks which were prefetched and not accessed yet
+    std::unordered_set<address_t> prefetched_blocks_;
+
+    bool use_prefetched_block(address_t address, bool late);
+    void train_prefetcher(address_t address, bool miss);
+    void prefetch_block(address_t address);
+
+    // a miss which is outstanding until ready_cycle
+    struct Mshr {
+        address_t address;
+        cycle_t ready_cycle;
+    };
+    std::vector<Mshr> mshr_entries_;
+    // protects mshr_entries_ in concurrent mode
+    std::mutex mshr_lock_;
+
+    std::unique_lock<std::mutex> lock_mshrs();
+
+    // set by read, write, read_at and write_at for the duration of the access
+    struct AccessState {
+        // all blocks of a timed access are issued in access_cycle
+        bool timed = false;
+        cycle_t access_cycle = 0;
+        // cycle in which the current miss accesses the next level data storage
+        cycle_t next_level_cycle = 0;
+    };
+    // the state of the current access if the cache isn't concurrent
+    AccessState access_state_;
+
+    class AccessScope {
+    public:
+        AccessScope(SetAssociativeCache* cache, AccessState access_state);
+        ~AccessScope();
+
+    private:
+        SetAssociativeCache* cache_;
+        AccessState previous_access_state_;
+    };
+
+    AccessState& access_state();
+    static std::vector<std::pair<const SetAssociativeCache*, AccessState>>&
+    get_thread_access_states();
+
+    void retire_mshrs(cycle_t cycle);
+    latency_t reserve_mshr();
+    latency_t merge_mshr(address_t address, latency_t latency);
+    void allocate_mshr(address_t address, cycle_t ready_cycle);
+
+    DataStorageTransaction read_next_level(address_t address, size_t num_bytes);
+    DataStorageTransaction write_next_level(address_t address, Data& data);
+
     address_t get_address_offset(address_t address);
     address_t get_address_index(address_t address);
     address_t get_address_tag(address_t address);
     address_t get_address_from_index_and_tag(address_t index, address_t tag);
 
+    void update_cache_block(address_t index, uint32_t block_index, address_t tag,
+                            Data& data, bool valid, bool dirty);
+    void update_cache_block_sectors(address_t index, uint32_t block_index,
+                                    address_t tag, Data& data, uint64_t valid_sectors,
+                                    uint64_t dirty_sectors);
+    void update_cache_block_bytes(address_t index, uint32_t block_index, address_t tag,
+                                  Data& data, address_t offset);
+    void update_dirty_sets(address_t index, uint32_t dirty_blocks_before);
+    DataStorageTransaction fill_cache_block(address_t index, uint32_t block_index,
+                                            address_t address,
+                                            CoherenceTransaction& coherence);
+
+    uint64_t get_sector_mask(address_t offset, size_t num_bytes);
+    uint64_t get_covered_sector_mask(address_t offset, size_t num_bytes);
+    latency_t read_next_level_sectors(address_t address, uint64_t sectors, Data& data,
+                                      int32_t& hit_level);
+    latency_t write_back_block(address_t index, uint32_t block_index,
+                               int32_t& hit_level);
+
     std::map<address_t, Data> align_write_transaction(address_t address, Data& data);
     DataStorageTransaction aligned_write(address_t address, Data& data);
+    DataStorageTransaction access_write(address_t address, Data& data);
 
     std::map<address_t, size_t> align_read_transaction(address_t address,
                                                        size_t num_bytes);
     DataStorageTransaction aligned_read(address_t address, size_t num_bytes);
+    DataStorageTransaction access_read(address_t address, size_t num_bytes);
+
+    DataStorageTransaction sectored_aligned_write(address_t address, Data& data);
+    DataStorageTransaction sectored_aligned_read(address_t address, size_t num_bytes);
 
-    DataStorageTransaction fill_data_from_next_level_data_storage(Data& data,
-                                                                  address_t address,
-                                                                  size_t num_bytes);
+    DataStorageTransaction fill_data_from_next_level_data_storage(
+        Data& data, address_t address, size_t num_bytes,
+        CoherenceTransaction& coherence);
 
     latency_t calculate_multi_block_access_latency(std::vector<latency_t> latencies);
 };
@@ -0,0 +1,147 @@
+#ifndef SKEWED_ASSOCIATIVE_CACHE_H
+#define SKEWED_ASSOCIATIVE_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "kachesim/cache_interface.h"
+#include "kachesim/cache_stats.h"
+#include "kachesim/data_storage.h"
+#include "kachesim/index_function.h"
+
+typedef enum SkewedReplacementPolicyType {
+    SKEWED_LRU,
+    SKEWED_NRU
+} SkewedReplacementPolicyType;
+
+namespace kachesim {
+/**
+ * represents a skewed-associative cache. Like a set-associative cache a block can be
+ * stored in one block of each way, but every way is indexed by a different hash of
+ * the address (IndexFunction with SKEWED_INDEX and the way as skew). Blocks which
+ * conflict in one way are spread over different sets in the other ways, so power of
+ * two strides don't thrash a single set.
+ *
+ *   sets: number of blocks per way, doesn't need to be a power of two
+ *
+ *   ways: number of ways, the cache holds sets * ways blocks like a
+ *   SetAssociativeCache with the same parameters
+ *
+ *   replacement_policy_type: as the candidates of a block lie in different sets
+ *   there is no per-set order, the replacement is approximated
+ *   SKEWED_LRU: every block stores the time of its last access in a global access
+ *   counter, the least recently used candidate is replaced
+ *   SKEWED_NRU: every block has a not recently used bit, the first candidate with the
+ *   bit cleared is replaced starting from a way which rotates with each replacement.
+ *   If all candidates were used recently their bits are cleared.
+ *
+ *   write_allocate, write_through: see SetAssociativeCache
+ *
+ *   if an access spans multiple blocks the latencies of the blocks are summed up
+ *
+ *   concurrent: (=true) reads and writes may be called from multiple threads at once,
+ *   the whole cache is locked for each access
+ */
+class SkewedAssociativeCache : public CacheInterface {
+public:
+    SkewedAssociativeCache(const std::string& name,
+                           std::shared_ptr<DataStorage> next_level_data_storage,
+                           bool write_allocate, bool write_through,
+                           latency_t miss_latency, latency_t hit_latency,
+                           size_t cache_block_size, size_t sets, size_t ways,
+                           SkewedReplacementPolicyType replacement_policy_type);
+
+    std::string get_name();
+    size_t size();
+    size_t get_address_space_size();
+
+    DataStorageTransaction write(address_t address, Data& data);
+    DataStorageTransaction read(address_t address, size_t num_bytes);
+    DataStorageTransaction flush();
+
+    std::shared_ptr<CacheInterface> clone(
+        std::shared_ptr<DataStorage> next_level_data_storage);
+
+    latency_t get_hit_latency();
+    latency_t get_miss_latency();
+    void set_hit_latency(latency_t hit_latency);
+    void set_miss_latency(latency_t miss_latency);
+
+    size_t get_sets();
+    size_t get_ways();
+    SkewedReplacementPolicyType get_replacement_policy_type();
+    size_t get_valid_block_count();
+
+    bool is_address_cached(address_t address);
+    bool is_address_dirty(address_t address);
+
+    uint8_t get(address_t address);
+
+    size_t get_dirty_block_count();
+
+    CacheStats get_stats();
+    void reset_stats();
+
+    void set_concurrent(bool concurrent);
+
+    void reset();
+
+private:
+    static constexpr size_t no_block_ = SIZE_MAX;
+
+    std::string name_;
+    std::shared_ptr<DataStorage> next_level_data_storage_;
+
+    bool write_allocate_;
+    bool write_through_;
+
+    latency_t miss_latency_;
+    latency_t hit_latency_;
+
+    size_t cache_block_size_;
+    size_t sets_;
+    size_t ways_;
+    SkewedReplacementPolicyType replacement_policy_type_;
+    uint32_t offset_bits_;
+
+    // index function i indexes way i
+    std::vector<IndexFunction> index_functions_;
+
+    // block b is stored in set b % sets_ of way b / sets_, its data starts at
+    // b * cache_block_size_
+    std::vector<uint8_t> data_;
+    std::vector<address_t> tags_;
+    std::vector<bool> valid_;
+    std::vector<bool> dirty_;
+    size_t valid_blocks_ = 0;
+    size_t dirty_blocks_ = 0;
+
+    // value of access_counter_ at the last access of a block, for SKEWED_LRU
+    std::vector<uint64_t> last_access_;
+    uint64_t access_counter_ = 0;
+    // recently used bits and the way the next search starts from, for SKEWED_NRU
+    std::vector<bool> recently_used_;
+    size_t next_way_ = 0;
+
+    CacheStats stats_;
+
+    bool concurrent_ = false;
+    std::mutex mutex_;
+
+    std::unique_lock<std::mutex> lock();
+
+    size_t get_block(size_t way, address_t block_address);
+    size_t find_block(address_t block_address);
+    address_t get_block_address(size_t block);
+    void touch_block(size_t block);
+    size_t get_replacement_block(address_t block_address);
+    size_t allocate_block(address_t block_address, latency_t& latency);
+
+    DataStorageTransaction aligned_write(address_t address, Data& data);
+    DataStorageTransaction aligned_read(address_t address, size_t num_bytes);
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SPARSE_MEMORY_H
+#define SPARSE_MEMORY_H
+
+#include <memory>
+#include <string>
+
+#include "kachesim/backing_store/sparse_backing_store.h"
+#include "kachesim/fake_memory.h"
+
+namespace kachesim {
+/**
+ * represents a FakeMemory whose bytes are stored in lazily allocated pages. Only
+ * written pages use host memory, which allows to model memories up to the full 64-bit
+ * address space. Bytes which were never written are read as 0.
+ *
+ * A clone shares the pages written so far copy-on-write with the original memory.
+ */
+class SparseMemory : public FakeMemory {
+public:
+    SparseMemory(const std::string& name, uint64_t size, latency_t read_latency,
+                 latency_t write_latency, size_t page_size = 4096);
+    SparseMemory(const std::string& name,
+                 std::shared_ptr<SparseBackingStore> backing_store,
+                 latency_t read_latency, latency_t write_latency);
+
+    size_t page_size();
+    size_t get_allocated_page_count();
+
+    std::shared_ptr<MemoryInterface> clone();
+
+    void reset();
+
+private:
+    std::shared_ptr<SparseBackingStore> sparse_backing_store();
+};
+}  // namespace kachesim
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef VICTIM_CACHE_H
+#define VICTIM_CACHE_H
+
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+#include "kachesim/data_storage_transaction.h"
+
+namespace kachesim {
+struct VictimCacheEntry {
+    address_t address;
+    Data data;
+    bool dirty;
+};
+
+/**
+ * a small fully associative buffer next to a cache which holds the blocks evicted from
+ * it. Misses of the cache probe the victim cache before going to the next level data
+ * storage and a hit moves the block back into the cache. If the victim cache is full
+ * the least recently inserted block is replaced.
+ *
+ *   entries: number of blocks the victim cache holds
+ *   latency: latency of a hit in the victim cache
+ */
+class VictimCache {
+public:
+    VictimCache(size_t cache_block_size, size_t entries, latency_t latency);
+    VictimCache(const VictimCache& victim_cache);
+
+    size_t size();
+    size_t get_entries();
+    size_t get_entry_count();
+    latency_t get_latency();
+
+    std::optional<VictimCacheEntry> insert(address_t address, Data& data, bool dirty);
+    std::optional<VictimCacheEntry> remove(address_t address);
+    bool contains(address_t address);
+
+    const std::list<VictimCacheEntry>& get_entry_list();
+
+    std::shared_ptr<VictimCache> clone();
+
+    void reset();
+
+private:
+    size_t cache_block_size_;
+    size_t entries_;
+    latency_t latency_;
+
+    // the most recently inserted block is at the front
+    std::list<VictimCacheEntry> entry_list_;
+    std::unordered_map<address_t, std::list<VictimCacheEntry>::iterator> entry_map_;
+};
+}  // namespace kachesim
+
+#endif
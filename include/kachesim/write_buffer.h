@@ -0,0 +1,92 @@
+#ifndef WRITE_BUFFER_H
+#define WRITE_BUFFER_H
+
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "kachesim/data_storage_transaction.h"
+
+typedef enum WriteBufferDrainPolicy {
+    DRAIN_WHEN_FULL,
+    DRAIN_EAGER
+} WriteBufferDrainPolicy;
+
+namespace kachesim {
+struct WriteBufferEntry {
+    // aligned to the granularity of the write buffer
+    address_t address;
+    Data data;
+    // byte i of the entry was written if valid[i] is set
+    std::vector<bool> valid;
+    // cycle in which the entry was allocated, its drain can't start earlier
+    cycle_t insert_cycle;
+    // a draining entry was written to the next level data storage and only occupies
+    // the buffer until drained_cycle, writes don't merge into it anymore
+    bool draining;
+    cycle_t drained_cycle;
+};
+
+/**
+ * a buffer between a cache and its next level data storage which absorbs the write
+ * throughs and write backs of the cache. Writes to the same granule merge into one
+ * entry, so a stream of stores reaches the next level as one write per granule. The
+ * buffer only holds the entries, the cache drains them and forwards buffered bytes to
+ * its reads from the next level.
+ *
+ *   entries: number of granules the buffer holds
+ *   granularity: size of a granule in bytes, a power of two
+ *   drain_policy:
+ *   DRAIN_WHEN_FULL: the oldest entry is only drained when a write needs a free entry
+ *   or the cache is flushed, a write waits until the drain completes
+ *   DRAIN_EAGER: entries drain in the background one after the other as soon as the
+ *   next level is free. Writes merge into an entry until its drain starts and only
+ *   wait if all entries are occupied. Without a timing model entries drained in the
+ *   background before a write needs a free entry.
+ */
+class WriteBuffer {
+public:
+    WriteBuffer(size_t entries, size_t granularity,
+                WriteBufferDrainPolicy drain_policy);
+    WriteBuffer(const WriteBuffer& write_buffer);
+
+    size_t size();
+    size_t get_entries();
+    size_t get_granularity();
+    WriteBufferDrainPolicy get_drain_policy();
+    size_t get_entry_count();
+    bool is_full();
+
+    bool merge(address_t address, Data& data);
+    void insert(address_t address, Data& data, cycle_t cycle);
+    void forward(address_t address, Data& data);
+
+    void set_draining(WriteBufferEntry& entry, cycle_t drained_cycle);
+    std::optional<cycle_t> get_first_drained_cycle();
+    cycle_t get_drain_cycle();
+    void retire(cycle_t cycle);
+    std::optional<WriteBufferEntry> remove_oldest();
+
+    std::list<WriteBufferEntry>& get_entry_list();
+
+    std::shared_ptr<WriteBuffer> clone();
+
+    void reset();
+
+private:
+    size_t entries_;
+    size_t granularity_;
+    WriteBufferDrainPolicy drain_policy_;
+
+    // the oldest entry is at the front
+    std::list<WriteBufferEntry> entry_list_;
+    // entries which aren't draining by address
+    std::unordered_map<address_t, std::list<WriteBufferEntry>::iterator> entry_map_;
+    // cycle in which the last drain completes, drains don't overlap
+    cycle_t drain_cycle_ = 0;
+};
+}  // namespace kachesim
+
+#endif
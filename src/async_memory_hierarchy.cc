@@ -0,0 +1,166 @@
+#include "kachesim/async_memory_hierarchy.h"
+
+#include <utility>
+
+namespace kachesim {
+AccessTask::AccessTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+AccessTask::AccessTask(AccessTask&& task) noexcept
+    : handle_(std::exchange(task.handle_, nullptr)) {}
+
+AccessTask::~AccessTask() {
+    if (handle_) {
+        handle_.destroy();
+    }
+}
+
+/**
+ * @brief passes the ownership of the coroutine to the caller
+ */
+std::coroutine_handle<AccessTask::promise_type> AccessTask::release() {
+    return std::exchange(handle_, nullptr);
+}
+
+AccessAwaitable::AccessAwaitable(AsyncMemoryHierarchy* hierarchy,
+                                 DataStorageTransactionType type, size_t port,
+                                 address_t address, size_t num_bytes, Data data)
+    : hierarchy_(hierarchy),
+      type_(type),
+      port_(port),
+      address_(address),
+      num_bytes_(num_bytes),
+      data_(data) {}
+
+/**
+ * @brief issues the access in the current cycle and resumes the coroutine when the
+ * access completes
+ */
+void AccessAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    MemoryHierarchy& memory_hierarchy = hierarchy_->memory_hierarchy_;
+
+    if (type_ == READ) {
+        dst_.emplace(memory_hierarchy.read(port_, address_, num_bytes_));
+    } else {
+        dst_.emplace(memory_hierarchy.write(port_, address_, data_));
+    }
+
+    hierarchy_->schedule(dst_->completion_cycle, handle);
+}
+
+DataStorageTransaction AccessAwaitable::await_resume() { return *dst_; }
+
+DelayAwaitable::DelayAwaitable(AsyncMemoryHierarchy* hierarchy, cycle_t cycles)
+    : hierarchy_(hierarchy), cycles_(cycles) {}
+
+void DelayAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    hierarchy_->schedule(hierarchy_->get_cycle() + cycles_, handle);
+}
+
+/**
+ * @brief switches the memory hierarchy to timed mode
+ */
+AsyncMemoryHierarchy::AsyncMemoryHierarchy(MemoryHierarchy& memory_hierarchy)
+    : memory_hierarchy_(memory_hierarchy) {
+    memory_hierarchy_.set_timed(true);
+}
+
+/**
+ * @brief destroys all coroutines which didn't finish
+ */
+AsyncMemoryHierarchy::~AsyncMemoryHierarchy() {
+    while (!scheduled_coroutines_.empty()) {
+        scheduled_coroutines_.top().handle.destroy();
+        scheduled_coroutines_.pop();
+    }
+}
+
+AccessAwaitable AsyncMemoryHierarchy::read_async(address_t address, size_t num_bytes) {
+    return read_async(0, address, num_bytes);
+}
+
+/**
+ * @brief reads through the first level cache of a port
+ * @return awaitable which returns the transaction of the read
+ */
+AccessAwaitable AsyncMemoryHierarchy::read_async(size_t port, address_t address,
+                                                 size_t num_bytes) {
+    return AccessAwaitable(this, READ, port, address, num_bytes, Data(0));
+}
+
+AccessAwaitable AsyncMemoryHierarchy::write_async(address_t address, const Data& data) {
+    return write_async(0, address, data);
+}
+
+/**
+ * @brief writes through the first level cache of a port
+ * @return awaitable which returns the transaction of the write
+ */
+AccessAwaitable AsyncMemoryHierarchy::write_async(size_t port, address_t address,
+                                                  const Data& data) {
+    return AccessAwaitable(this, WRITE, port, address, data.size(), data);
+}
+
+/**
+ * @brief suspends the coroutine for a number of cycles, e.g. to model computation
+ */
+DelayAwaitable AsyncMemoryHierarchy::delay(cycle_t cycles) {
+    return DelayAwaitable(this, cycles);
+}
+
+/**
+ * @brief starts a coroutine in the current cycle, it runs when run is called
+ */
+void AsyncMemoryHierarchy::spawn(AccessTask task) {
+    schedule(get_cycle(), task.release());
+}
+
+/**
+ * @brief resumes the coroutines in cycle order until all of them finished, the global
+ * clock is advanced to the cycle of each resumed coroutine
+ * @throws the exception of a coroutine which didn't handle it
+ */
+void AsyncMemoryHierarchy::run() {
+    while (!scheduled_coroutines_.empty()) {
+        ScheduledCoroutine scheduled_coroutine = scheduled_coroutines_.top();
+        scheduled_coroutines_.pop();
+
+        if (scheduled_coroutine.cycle > memory_hierarchy_.get_cycle()) {
+            memory_hierarchy_.advance_to(scheduled_coroutine.cycle);
+        }
+
+        std::coroutine_handle<> handle = scheduled_coroutine.handle;
+        handle.resume();
+
+        if (handle.done()) {
+            // only AccessTasks can await the awaitables of the hierarchy
+            auto task = std::coroutine_handle<AccessTask::promise_type>::from_address(
+                handle.address());
+            std::exception_ptr exception = task.promise().exception;
+            task.destroy();
+
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+        }
+    }
+}
+
+cycle_t AsyncMemoryHierarchy::get_cycle() const {
+    return memory_hierarchy_.get_cycle();
+}
+
+/**
+ * @brief returns the number of coroutines which didn't finish yet
+ */
+size_t AsyncMemoryHierarchy::get_pending_count() const {
+    return scheduled_coroutines_.size();
+}
+
+MemoryHierarchy& AsyncMemoryHierarchy::get_memory_hierarchy() {
+    return memory_hierarchy_;
+}
+
+void AsyncMemoryHierarchy::schedule(cycle_t cycle, std::coroutine_handle<> handle) {
+    scheduled_coroutines_.push({cycle, sequence_++, handle});
+}
+}  // namespace kachesim
@@ -0,0 +1,5 @@
+#include "kachesim/backing_store/backing_store.h"
+
+namespace kachesim {
+BackingStore::~BackingStore() = default;
+}  // namespace kachesim
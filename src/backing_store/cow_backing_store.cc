@@ -0,0 +1,83 @@
+#include "kachesim/backing_store/cow_backing_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+/**
+ * @param base the backing store shared with other memories, it has to outlive all
+ * writes to it
+ * @param page_size the size of the private pages
+ * @throws std::invalid_argument if there is no base
+ */
+CowBackingStore::CowBackingStore(std::shared_ptr<const BackingStore> base,
+                                 size_t page_size)
+    : SparseBackingStore(base != nullptr ? base->size() : 0, page_size), base_(base) {
+    if (base_ == nullptr) {
+        THROW_INVALID_ARGUMENT("copy-on-write backing store needs a base");
+    }
+}
+
+std::shared_ptr<const BackingStore> CowBackingStore::get_base() const { return base_; }
+
+/**
+ * @brief copies bytes into data, bytes of pages which were never written are read from
+ * the base
+ * @param address the address to read from
+ * @param data the buffer to copy to
+ * @param num_bytes the number of bytes to read
+ */
+void CowBackingStore::read(address_t address, uint8_t* data, size_t num_bytes) const {
+    while (num_bytes > 0) {
+        size_t offset = address & (page_size() - 1);
+        size_t chunk_size = std::min(num_bytes, page_size() - offset);
+
+        const uint8_t* page = find_page(address >> page_bits());
+
+        if (page == nullptr) {
+            base_->read(address, data, chunk_size);
+        } else {
+            memcpy(data, page + offset, chunk_size);
+        }
+
+        address += chunk_size;
+        data += chunk_size;
+        num_bytes -= chunk_size;
+    }
+}
+
+/**
+ * @brief copies bytes from data into private pages, pages are copied from the base on
+ * the first write
+ * @param address the address to write to
+ * @param data the buffer to copy from
+ * @param num_bytes the number of bytes to write
+ */
+void CowBackingStore::write(address_t address, const uint8_t* data, size_t num_bytes) {
+    while (num_bytes > 0) {
+        size_t offset = address & (page_size() - 1);
+        size_t chunk_size = std::min(num_bytes, page_size() - offset);
+        uint64_t page_number = address >> page_bits();
+
+        uint8_t* page = const_cast<uint8_t*>(find_page(page_number));
+
+        if (page == nullptr) {
+            page = find_or_allocate_page(page_number);
+
+            // the last page of the memory can be shorter than a full page
+            address_t page_address = address - offset;
+            base_->read(page_address, page,
+                        std::min<uint64_t>(page_size(), size() - page_address));
+        }
+
+        memcpy(page + offset, data, chunk_size);
+
+        address += chunk_size;
+        data += chunk_size;
+        num_bytes -= chunk_size;
+    }
+}
+}  // namespace kachesim
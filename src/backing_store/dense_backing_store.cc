@@ -0,0 +1,23 @@
+#include "kachesim/backing_store/dense_backing_store.h"
+
+#include <cstring>
+
+namespace kachesim {
+DenseBackingStore::DenseBackingStore(size_t size) : size_(size) { reset(); }
+
+size_t DenseBackingStore::size() const { return size_; }
+
+void DenseBackingStore::read(address_t address, uint8_t* data, size_t num_bytes) const {
+    memcpy(data, data_.data() + address, num_bytes);
+}
+
+void DenseBackingStore::write(address_t address, const uint8_t* data,
+                              size_t num_bytes) {
+    memcpy(data_.data() + address, data, num_bytes);
+}
+
+/**
+ * @brief sets all bytes to 0
+ */
+void DenseBackingStore::reset() { data_ = std::vector<uint8_t>(size_); }
+}  // namespace kachesim
@@ -0,0 +1,124 @@
+#include "kachesim/backing_store/mapped_backing_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+/**
+ * @param image_path the path to the binary memory image
+ * @param size the size of the memory, if the size is 0 the size of the image is used
+ * @throws std::runtime_error if the image can't be opened
+ * @throws std::invalid_argument if the image is larger than the memory
+ */
+MappedBackingStore::MappedBackingStore(const std::string& image_path, size_t size)
+    : image_path_(image_path), size_(size) {
+    struct stat image_stat;
+    if (stat(image_path_.c_str(), &image_stat) != 0) {
+        std::string err_msg = std::string("file ") + image_path_ +
+                              std::string(" can't be accessed: ") + strerror(errno);
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    image_size_ = image_stat.st_size;
+
+    if (size_ == 0) {
+        size_ = image_size_;
+    }
+
+    if (image_size_ > size_) {
+        std::string err_msg = std::string("image ") + image_path_ +
+                              std::string(" of size ") +
+                              int_to_hex<uint64_t>(image_size_) +
+                              std::string(" does not fit into size ") +
+                              int_to_hex<uint64_t>(size_);
+        THROW_INVALID_ARGUMENT(err_msg);
+    }
+
+    map();
+}
+
+MappedBackingStore::~MappedBackingStore() { unmap(); }
+
+/**
+ * @brief reserves the whole memory as zero filled anonymous mapping and maps the image
+ * privately on top of it
+ */
+void MappedBackingStore::map() {
+    if (size_ == 0) {
+        return;
+    }
+
+    void* memory = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED) {
+        std::string err_msg =
+            std::string("mapping memory for ") + image_path_ + ": " + strerror(errno);
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    data_ = static_cast<uint8_t*>(memory);
+
+    if (image_size_ == 0) {
+        return;
+    }
+
+    int fd = open(image_path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        unmap();
+        std::string err_msg =
+            std::string("file ") + image_path_ + " can't be opened: " + strerror(errno);
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    void* image = mmap(data_, image_size_, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_FIXED, fd, 0);
+    // the mapping stays valid after the file descriptor is closed
+    close(fd);
+
+    if (image == MAP_FAILED) {
+        unmap();
+        std::string err_msg =
+            std::string("file ") + image_path_ + " can't be mapped: " + strerror(errno);
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+}
+
+void MappedBackingStore::unmap() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+        data_ = nullptr;
+    }
+}
+
+size_t MappedBackingStore::size() const { return size_; }
+
+size_t MappedBackingStore::image_size() const { return image_size_; }
+
+std::string MappedBackingStore::get_image_path() const { return image_path_; }
+
+void MappedBackingStore::read(address_t address, uint8_t* data,
+                              size_t num_bytes) const {
+    memcpy(data, data_ + address, num_bytes);
+}
+
+void MappedBackingStore::write(address_t address, const uint8_t* data,
+                               size_t num_bytes) {
+    memcpy(data_ + address, data, num_bytes);
+}
+
+/**
+ * @brief discards all written pages, afterwards the memory contains the image again
+ */
+void MappedBackingStore::reset() {
+    unmap();
+    map();
+}
+}  // namespace kachesim
@@ -0,0 +1,150 @@
+#include "kachesim/backing_store/sparse_backing_store.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+SparseBackingStore::SparseBackingStore(size_t size, size_t page_size)
+    : size_(size), page_size_(page_size) {
+    if (page_size_ == 0 || (page_size_ & (page_size_ - 1)) != 0) {
+        std::string err_msg = std::string("page size ") +
+                              int_to_hex<uint64_t>(page_size_) +
+                              std::string(" is not a power of two");
+        THROW_INVALID_ARGUMENT(err_msg);
+    }
+
+    page_bits_ = clog2(page_size_);
+
+    // number of bits needed to address every page of the memory
+    uint32_t address_bits = size_ > 1 ? std::bit_width(size_ - 1) : 1;
+    uint32_t page_number_bits =
+        address_bits > page_bits_ ? address_bits - page_bits_ : 0;
+
+    levels_ = std::max<uint32_t>(1, (page_number_bits + radix_bits_ - 1) / radix_bits_);
+
+    reset();
+}
+
+size_t SparseBackingStore::size() const { return size_; }
+
+size_t SparseBackingStore::page_size() const { return page_size_; }
+
+/**
+ * @brief walks the radix table without allocating nodes or pages
+ * @param page_number the number of the page to look up
+ * @return the page or nullptr if the page was never written
+ */
+const uint8_t* SparseBackingStore::find_page(uint64_t page_number) const {
+    const SparseBackingStoreNode* node = root_.get();
+
+    for (uint32_t level = levels_ - 1; level > 0; level--) {
+        size_t i = (page_number >> (level * radix_bits_)) & radix_mask_;
+        if (node->children.empty() || node->children[i] == nullptr) {
+            return nullptr;
+        }
+        node = node->children[i].get();
+    }
+
+    if (node->pages.empty()) {
+        return nullptr;
+    }
+
+    return node->pages[page_number & radix_mask_].get();
+}
+
+/**
+ * @brief walks the radix table and allocates missing nodes and the page itself
+ * @param page_number the number of the page to look up
+ * @return the page, newly allocated pages are filled with 0
+ */
+uint8_t* SparseBackingStore::find_or_allocate_page(uint64_t page_number) {
+    SparseBackingStoreNode* node = root_.get();
+
+    for (uint32_t level = levels_ - 1; level > 0; level--) {
+        size_t i = (page_number >> (level * radix_bits_)) & radix_mask_;
+        if (node->children.empty()) {
+            node->children.resize(1 << radix_bits_);
+        }
+        if (node->children[i] == nullptr) {
+            node->children[i] = std::make_unique<SparseBackingStoreNode>();
+        }
+        node = node->children[i].get();
+    }
+
+    if (node->pages.empty()) {
+        node->pages.resize(1 << radix_bits_);
+    }
+
+    auto& page = node->pages[page_number & radix_mask_];
+
+    if (page == nullptr) {
+        page = std::unique_ptr<uint8_t[]>(new uint8_t[page_size_]());
+        allocated_pages_++;
+    }
+
+    return page.get();
+}
+
+/**
+ * @brief copies bytes into data, bytes of pages which were never written are 0
+ * @param address the address to read from
+ * @param data the buffer to copy to
+ * @param num_bytes the number of bytes to read
+ */
+void SparseBackingStore::read(address_t address, uint8_t* data,
+                              size_t num_bytes) const {
+    while (num_bytes > 0) {
+        size_t offset = address & (page_size_ - 1);
+        size_t chunk_size = std::min(num_bytes, page_size_ - offset);
+
+        const uint8_t* page = find_page(address >> page_bits_);
+
+        if (page == nullptr) {
+            memset(data, 0, chunk_size);
+        } else {
+            memcpy(data, page + offset, chunk_size);
+        }
+
+        address += chunk_size;
+        data += chunk_size;
+        num_bytes -= chunk_size;
+    }
+}
+
+/**
+ * @brief copies bytes from data into the pages, pages are allocated on demand
+ * @param address the address to write to
+ * @param data the buffer to copy from
+ * @param num_bytes the number of bytes to write
+ */
+void SparseBackingStore::write(address_t address, const uint8_t* data,
+                               size_t num_bytes) {
+    while (num_bytes > 0) {
+        size_t offset = address & (page_size_ - 1);
+        size_t chunk_size = std::min(num_bytes, page_size_ - offset);
+
+        uint8_t* page = find_or_allocate_page(address >> page_bits_);
+        memcpy(page + offset, data, chunk_size);
+
+        address += chunk_size;
+        data += chunk_size;
+        num_bytes -= chunk_size;
+    }
+}
+
+size_t SparseBackingStore::get_allocated_page_count() const { return allocated_pages_; }
+
+/**
+ * @brief drops all pages, the cost depends on the number of allocated pages and not on
+ * the size of the memory
+ */
+void SparseBackingStore::reset() {
+    root_ = std::make_unique<SparseBackingStoreNode>();
+    allocated_pages_ = 0;
+}
+}  // namespace kachesim
@@ -0,0 +1,84 @@
+#include "kachesim/cache_banks.h"
+
+#include <algorithm>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+CacheBanks::CacheBanks(size_t banks, size_t bank_width, latency_t busy_cycles,
+                       IndexFunctionType bank_function)
+    : banks_(banks),
+      bank_width_(bank_width),
+      busy_cycles_(busy_cycles),
+      bank_function_(bank_function, banks == 0 ? 1 : banks) {
+    if (banks_ == 0) {
+        THROW_INVALID_ARGUMENT("cache banks without banks");
+    }
+    if (bank_width_ == 0 || (bank_width_ & (bank_width_ - 1)) != 0) {
+        THROW_INVALID_ARGUMENT("bank width is not a power of two");
+    }
+
+    bank_width_bits_ = clog2(bank_width_);
+    free_cycles_ = std::vector<cycle_t>(banks_, 0);
+    units_ = std::vector<size_t>(banks_, 0);
+}
+
+std::shared_ptr<CacheBanks> CacheBanks::clone() {
+    return std::make_shared<CacheBanks>(*this);
+}
+
+size_t CacheBanks::get_banks() { return banks_; }
+
+size_t CacheBanks::get_bank_width() { return bank_width_; }
+
+latency_t CacheBanks::get_busy_cycles() { return busy_cycles_; }
+
+IndexFunctionType CacheBanks::get_bank_function() { return bank_function_.get_type(); }
+
+/**
+ * @brief returns the bank which holds an address
+ */
+size_t CacheBanks::get_bank(address_t address) {
+    return bank_function_.index(address >> bank_width_bits_);
+}
+
+/**
+ * @brief schedules an access to the banks. The access starts once all of its banks are
+ * free and keeps each bank busy for busy_cycles per unit it accesses in it. Units in
+ * the same bank are accessed one after the other.
+ * @param address the address of the access
+ * @param num_bytes the number of bytes accessed, at least 1
+ * @param cycle the cycle in which the access is issued
+ * @param latency the latency of the access without bank conflicts
+ * @return the cycle in which the access completes
+ */
+cycle_t CacheBanks::schedule(address_t address, size_t num_bytes, cycle_t cycle,
+                             latency_t latency) {
+    address_t first_unit = address >> bank_width_bits_;
+    address_t last_unit = (address + num_bytes - 1) >> bank_width_bits_;
+
+    cycle_t start = cycle;
+    size_t max_units = 1;
+
+    for (address_t unit = first_unit; unit <= last_unit; unit++) {
+        size_t bank = bank_function_.index(unit);
+        start = std::max(start, free_cycles_[bank]);
+        max_units = std::max(max_units, ++units_[bank]);
+    }
+
+    for (address_t unit = first_unit; unit <= last_unit; unit++) {
+        size_t bank = bank_function_.index(unit);
+        if (units_[bank] != 0) {
+            free_cycles_[bank] = start + units_[bank] * busy_cycles_;
+            units_[bank] = 0;
+        }
+    }
+
+    return start + latency + (max_units - 1) * busy_cycles_;
+}
+
+/**
+ * @brief frees all banks
+ */
+void CacheBanks::reset() { std::fill(free_cycles_.begin(), free_cycles_.end(), 0); }
+}  // namespace kachesim
@@ -1,23 +1,73 @@
 #include "kachesim/cache_block.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
 
 #include "kachesim/common.h"
 
 namespace kachesim {
-CacheBlock::CacheBlock(uint64_t size) : size_(size) { reset(); }
+CacheBlock::CacheBlock(uint64_t size, uint32_t sectors, bool byte_masks)
+    : size_(size), all_sectors_(bitmask<uint64_t>(sectors)) {
+    if (byte_masks) {
+        valid_bytes_ = std::vector<bool>(size_, false);
+    }
+    set_bytes_valid(false);
+    reset();
+}
+
+/**
+ * @brief creates a deep copy of a cache block including its data
+ */
+CacheBlock::CacheBlock(const CacheBlock& cache_block)
+    : size_(cache_block.size_),
+      all_sectors_(cache_block.all_sectors_),
+      tag_(cache_block.tag_),
+      generation_(cache_block.generation_),
+      dirty_(cache_block.dirty_),
+      valid_(cache_block.valid_),
+      valid_sectors_(cache_block.valid_sectors_),
+      dirty_sectors_(cache_block.dirty_sectors_),
+      valid_bytes_(cache_block.valid_bytes_),
+      valid_byte_count_(cache_block.valid_byte_count_) {
+    data_ = new uint8_t[size_];
+    memcpy(data_, cache_block.data_, size_);
+}
+
 CacheBlock::~CacheBlock() { delete[] data_; }
 
-void CacheBlock::set_valid() { valid_ = true; }
+void CacheBlock::set_valid(uint64_t generation) {
+    valid_ = true;
+    valid_sectors_ = all_sectors_;
+    set_bytes_valid(true);
+    generation_ = generation;
+}
 
-void CacheBlock::set_unvalid() { valid_ = false; }
+void CacheBlock::set_unvalid() {
+    valid_ = false;
+    valid_sectors_ = 0;
+    set_bytes_valid(false);
+}
 
-bool CacheBlock::is_valid() { return valid_; }
+/**
+ * @brief checks if the block is valid in the given generation
+ * @param generation the current generation of the cache the block belongs to
+ * @return true if the valid bit is set and the block was updated in generation
+ */
+bool CacheBlock::is_valid(uint64_t generation) {
+    return valid_ && generation_ == generation;
+}
 
-void CacheBlock::set_dirty() { dirty_ = true; }
+void CacheBlock::set_dirty() {
+    dirty_ = true;
+    dirty_sectors_ = all_sectors_;
+}
 
-void CacheBlock::set_not_dirty() { dirty_ = false; }
+void CacheBlock::set_not_dirty() {
+    dirty_ = false;
+    dirty_sectors_ = 0;
+}
 
 bool CacheBlock::is_dirty() { return dirty_; }
 
@@ -26,10 +76,14 @@ bool CacheBlock::is_dirty() { return dirty_; }
  * dirty
  * @param tag the tag of the data
  * @param data the data to stored
+ * @param valid the valid bit of the block
+ * @param dirty the dirty bit of the block
+ * @param generation the generation of the cache in which the block is updated
  * @throws std::out_of_range if the size of the data does not match the size of the
  * cache line
  */
-void CacheBlock::update(uint64_t tag, Data& data, bool valid, bool dirty) {
+void CacheBlock::update(uint64_t tag, Data& data, bool valid, bool dirty,
+                        uint64_t generation) {
     if (data.size() != size_) {
         std::string err_msg = std::string("data size with tag: ") +
                               int_to_hex<uint64_t>(tag) +
@@ -40,6 +94,10 @@ void CacheBlock::update(uint64_t tag, Data& data, bool valid, bool dirty) {
     tag_ = tag;
     valid_ = valid;
     dirty_ = dirty;
+    valid_sectors_ = valid ? all_sectors_ : 0;
+    dirty_sectors_ = dirty ? all_sectors_ : 0;
+    set_bytes_valid(valid);
+    generation_ = generation;
 
     // copy data into data_
     for (int i = 0; i < size_; i++) {
@@ -47,6 +105,90 @@ void CacheBlock::update(uint64_t tag, Data& data, bool valid, bool dirty) {
     }
 }
 
+/**
+ * update the cache block with the given tag and data and sets the valid and dirty bits
+ * of its sectors, the block is valid or dirty if any of its sectors is
+ * @param tag the tag of the data
+ * @param data the data to stored, the data of sectors which aren't valid is ignored
+ * @param valid_sectors bit i is set if sector i is valid
+ * @param dirty_sectors bit i is set if sector i is dirty
+ * @param generation the generation of the cache in which the block is updated
+ * @throws std::out_of_range if the size of the data does not match the size of the
+ * cache line
+ */
+void CacheBlock::update_sectors(uint64_t tag, Data& data, uint64_t valid_sectors,
+                                uint64_t dirty_sectors, uint64_t generation) {
+    update(tag, data, valid_sectors != 0, dirty_sectors != 0, generation);
+    valid_sectors_ = valid_sectors & all_sectors_;
+    dirty_sectors_ = dirty_sectors & all_sectors_;
+}
+
+/**
+ * writes data into a part of the cache block without loading the rest of it and sets
+ * the written bytes valid and the block dirty. If the block didn't hold the tag in the
+ * generation before, all other bytes become invalid. Only for blocks with byte masks.
+ * @param tag the tag of the data
+ * @param data the data to write
+ * @param offset the offset of the data in the block
+ * @param generation the generation of the cache in which the block is updated
+ * @throws std::out_of_range if the data doesn't fit into the block
+ * @throws std::runtime_error if the block has no byte masks
+ */
+void CacheBlock::update_bytes(uint64_t tag, Data& data, uint64_t offset,
+                              uint64_t generation) {
+    if (offset + data.size() > size_) {
+        THROW_OUT_OF_RANGE("data with tag " + int_to_hex<uint64_t>(tag) +
+                           " exceeds the cache line");
+    }
+    if (valid_bytes_.empty()) {
+        THROW_RUNTIME_ERROR("cache block has no byte masks");
+    }
+
+    if (!is_valid(generation) || tag_ != tag) {
+        set_bytes_valid(false);
+    }
+
+    tag_ = tag;
+    valid_ = true;
+    dirty_ = true;
+    valid_sectors_ = all_sectors_;
+    dirty_sectors_ = all_sectors_;
+    generation_ = generation;
+
+    for (size_t i = 0; i < data.size(); i++) {
+        data_[offset + i] = data[i];
+
+        if (!valid_bytes_[offset + i]) {
+            valid_bytes_[offset + i] = true;
+            valid_byte_count_++;
+        }
+    }
+}
+
+/**
+ * @brief checks if all bytes of a range of the block are valid, the valid bit of the
+ * block itself isn't checked
+ */
+bool CacheBlock::are_bytes_valid(uint64_t offset, uint64_t num_bytes) const {
+    if (is_complete()) {
+        return true;
+    }
+
+    for (uint64_t i = offset; i < offset + num_bytes; i++) {
+        if (!valid_bytes_[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CacheBlock::set_bytes_valid(bool valid) {
+    if (!valid_bytes_.empty()) {
+        std::fill(valid_bytes_.begin(), valid_bytes_.end(), valid);
+    }
+    valid_byte_count_ = valid || valid_bytes_.empty() ? size_ : 0;
+}
+
 uint64_t CacheBlock::get_tag() { return tag_; }
 
 Data CacheBlock::get_data() {
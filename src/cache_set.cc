@@ -1,5 +1,6 @@
 #include "kachesim/cache_set.h"
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 
@@ -8,15 +9,42 @@
 
 namespace kachesim {
 CacheSet::CacheSet(uint64_t cache_block_size, uint32_t ways,
-                   ReplacementPolicyType replacement_policy_type) {
+                   ReplacementPolicyType replacement_policy_type, uint32_t sectors,
+                   bool byte_masks)
+    : replacement_policy_type_(replacement_policy_type) {
     blocks_.reserve(ways);
 
     for (int i = 0; i < ways; i++) {
-        blocks_.push_back(
-            std::unique_ptr<CacheBlock>(new CacheBlock(cache_block_size)));
+        blocks_.push_back(std::unique_ptr<CacheBlock>(
+            new CacheBlock(cache_block_size, sectors, byte_masks)));
     }
 
-    switch (replacement_policy_type) {
+    dirty_mask_ = std::vector<uint64_t>((ways + 63) / 64, 0);
+
+    create_replacement_policy();
+}
+
+/**
+ * @brief creates a deep copy of a cache set including blocks and replacement state
+ */
+CacheSet::CacheSet(const CacheSet& cache_set)
+    : replacement_policy_(cache_set.replacement_policy_->clone()),
+      replacement_policy_type_(cache_set.replacement_policy_type_),
+      dirty_mask_(cache_set.dirty_mask_),
+      dirty_blocks_(cache_set.dirty_blocks_) {
+    blocks_.reserve(cache_set.blocks_.size());
+
+    for (const auto& block : cache_set.blocks_) {
+        blocks_.push_back(std::unique_ptr<CacheBlock>(new CacheBlock(*block)));
+    }
+}
+
+std::unique_ptr<CacheSet> CacheSet::clone() {
+    return std::unique_ptr<CacheSet>(new CacheSet(*this));
+}
+
+void CacheSet::create_replacement_policy() {
+    switch (replacement_policy_type_) {
         case ReplacementPolicyType::LRU:
             replacement_policy_ = std::make_shared<LeastRecentlyUsed>();
             break;
@@ -28,11 +56,13 @@ CacheSet::CacheSet(uint64_t cache_block_size, uint32_t ways,
 
 /**
  * @brief returns the index of a block in the cache set with the given tag
+ * @param tag the tag to search for
+ * @param generation the current generation of the cache
  * @return The index of block with given tag, -1 if no block with tag was found
  */
-int32_t CacheSet::get_block_index_with_tag(uint64_t tag) {
+int32_t CacheSet::get_block_index_with_tag(uint64_t tag, uint64_t generation) {
     for (int i = 0; i < blocks_.size(); i++) {
-        if (blocks_[i]->get_tag() == tag && blocks_[i]->is_valid()) {
+        if (blocks_[i]->get_tag() == tag && blocks_[i]->is_valid(generation)) {
             return i;
         }
     }
@@ -42,11 +72,12 @@ int32_t CacheSet::get_block_index_with_tag(uint64_t tag) {
 
 /**
  * @brief returns the index of a free block in the cache set
+ * @param generation the current generation of the cache
  * @return The index of a free block in the cache set, -1 if no block was found
  */
-int32_t CacheSet::get_free_block_index() {
+int32_t CacheSet::get_free_block_index(uint64_t generation) {
     for (int i = 0; i < blocks_.size(); i++) {
-        if (!blocks_[i]->is_valid()) {
+        if (!blocks_[i]->is_valid(generation)) {
             return i;
         }
     }
@@ -63,16 +94,87 @@ uint64_t CacheSet::get_block_tag(uint32_t block_index) {
 }
 
 void CacheSet::update_block(uint32_t block_index, uint64_t tag, Data& data, bool valid,
-                            bool dirty) {
-    blocks_[block_index]->update(tag, data, valid, dirty);
+                            bool dirty, uint64_t generation) {
+    blocks_[block_index]->update(tag, data, valid, dirty, generation);
+    update_dirty_mask(block_index, valid && dirty);
+}
+
+/**
+ * @brief updates a block and the valid and dirty bits of its sectors, a block is
+ * dirty if any of its valid sectors is dirty
+ */
+void CacheSet::update_block_sectors(uint32_t block_index, uint64_t tag, Data& data,
+                                    uint64_t valid_sectors, uint64_t dirty_sectors,
+                                    uint64_t generation) {
+    blocks_[block_index]->update_sectors(tag, data, valid_sectors,
+                                         valid_sectors & dirty_sectors, generation);
+    update_dirty_mask(block_index, (valid_sectors & dirty_sectors) != 0);
+}
+
+/**
+ * @brief writes data into a part of a block with byte masks, the block becomes dirty
+ */
+void CacheSet::update_block_bytes(uint32_t block_index, uint64_t tag, Data& data,
+                                  uint64_t offset, uint64_t generation) {
+    blocks_[block_index]->update_bytes(tag, data, offset, generation);
+    update_dirty_mask(block_index, true);
+}
+
+/**
+ * @brief keeps dirty mask and dirty block count in sync with a block
+ */
+void CacheSet::update_dirty_mask(uint32_t block_index, bool dirty) {
+    uint64_t& dirty_mask_word = dirty_mask_[block_index / 64];
+    uint64_t dirty_bit = 1ull << (block_index % 64);
+    bool was_dirty = (dirty_mask_word & dirty_bit) != 0;
+
+    if (dirty && !was_dirty) {
+        dirty_mask_word |= dirty_bit;
+        dirty_blocks_++;
+    } else if (!dirty && was_dirty) {
+        dirty_mask_word &= ~dirty_bit;
+        dirty_blocks_--;
+    }
 }
 
-bool CacheSet::is_block_valid(uint32_t block_index) {
-    return blocks_[block_index]->is_valid();
+bool CacheSet::is_block_valid(uint32_t block_index, uint64_t generation) {
+    return blocks_[block_index]->is_valid(generation);
 }
 
 bool CacheSet::is_block_dirty(uint32_t block_index) {
-    return blocks_[block_index]->is_dirty();
+    return (dirty_mask_[block_index / 64] & (1ull << (block_index % 64))) != 0;
+}
+
+uint64_t CacheSet::get_block_valid_sectors(uint32_t block_index) {
+    return blocks_[block_index]->get_valid_sectors();
+}
+
+bool CacheSet::are_block_bytes_valid(uint32_t block_index, uint64_t offset,
+                                     uint64_t num_bytes) {
+    return blocks_[block_index]->are_bytes_valid(offset, num_bytes);
+}
+
+bool CacheSet::is_block_complete(uint32_t block_index) {
+    return blocks_[block_index]->is_complete();
+}
+
+/**
+ * @brief returns the dirty sectors of a block, 0 if the block isn't dirty
+ */
+uint64_t CacheSet::get_block_dirty_sectors(uint32_t block_index) {
+    if (!is_block_dirty(block_index)) {
+        return 0;
+    }
+    return blocks_[block_index]->get_dirty_sectors();
+}
+
+/**
+ * @brief marks all blocks as not dirty without touching the blocks themselves. This is
+ * only intended to be used when all blocks of the set are invalidated at once.
+ */
+void CacheSet::clear_dirty_mask() {
+    std::fill(dirty_mask_.begin(), dirty_mask_.end(), 0);
+    dirty_blocks_ = 0;
 }
 
 void CacheSet::update_replacement_policy(uint32_t block_index) {
@@ -82,4 +184,19 @@ void CacheSet::update_replacement_policy(uint32_t block_index) {
 uint32_t CacheSet::get_replacement_index() {
     return replacement_policy_->get_replacement_index();
 }
+
+/**
+ * @brief invalidates all blocks and resets the replacement policy. This touches every
+ * block of the set, caches invalidate their sets by switching to a new generation
+ * instead.
+ */
+void CacheSet::reset() {
+    for (auto& block : blocks_) {
+        block->set_unvalid();
+        block->set_not_dirty();
+    }
+
+    clear_dirty_mask();
+    create_replacement_policy();
+}
 }  // namespace kachesim
@@ -0,0 +1,247 @@
+#include "kachesim/coherence_directory.h"
+
+#include <bit>
+#include <string>
+
+#include "kachesim/common.h"
+#include "kachesim/set_associative_cache.h"
+
+namespace kachesim {
+CoherenceDirectory::CoherenceDirectory(CoherenceProtocol protocol,
+                                       latency_t lookup_latency,
+                                       latency_t snoop_latency)
+    : protocol_(protocol),
+      lookup_latency_(lookup_latency),
+      snoop_latency_(snoop_latency) {}
+
+/**
+ * @brief registers the cache which is snooped for cache_id
+ * @throws std::out_of_range if cache_id exceeds the maximum number of caches
+ */
+void CoherenceDirectory::set_cache(size_t cache_id, SetAssociativeCache* cache) {
+    if (cache_id >= max_caches_) {
+        std::string err_msg = "coherence directory supports at most " +
+                              std::to_string(max_caches_) + " caches";
+        THROW_OUT_OF_RANGE(err_msg);
+    }
+
+    if (cache_id >= caches_.size()) {
+        caches_.resize(cache_id + 1, nullptr);
+    }
+    caches_[cache_id] = cache;
+}
+
+/**
+ * @brief requests a block for reading after a read miss of a cache. An owner of the
+ * block is downgraded, with MOESI a dirty owner forwards the block.
+ * @param cache_id the requesting cache
+ * @param address the address of the block
+ * @param data receives the block if it is forwarded, must have the size of a block
+ */
+CoherenceTransaction CoherenceDirectory::read(size_t cache_id, address_t address,
+                                              Data* data) {
+    CoherenceTransaction transaction;
+    transaction.latency = lookup_latency_;
+
+    uint64_t cache_bit = 1ull << cache_id;
+
+    auto it = entries_.find(address);
+    if (it == entries_.end()) {
+        // no other cache holds the block
+        entries_.insert({address, {cache_bit, static_cast<int32_t>(cache_id),
+                                   COHERENCE_EXCLUSIVE}});
+        return transaction;
+    }
+
+    DirectoryEntry& entry = it->second;
+
+    if (entry.owner != -1 && entry.owner != static_cast<int32_t>(cache_id)) {
+        SetAssociativeCache* owner = caches_[entry.owner];
+
+        transaction.interventions++;
+        transaction.latency += snoop_latency_;
+
+        bool dirty =
+            entry.state == COHERENCE_MODIFIED || entry.state == COHERENCE_OWNED;
+
+        if (dirty && protocol_ == MOESI) {
+            // the owner keeps the dirty block and forwards it
+            owner->snoop(address, false, false, data);
+            transaction.forwarded = true;
+            entry.state = COHERENCE_OWNED;
+        } else {
+            // the owner writes back a dirty block and keeps a shared copy
+            transaction.latency += owner->snoop(address, false, true, nullptr);
+            entry.owner = -1;
+            entry.state = COHERENCE_SHARED;
+        }
+    }
+
+    entry.sharers |= cache_bit;
+
+    interventions_ += transaction.interventions;
+
+    return transaction;
+}
+
+/**
+ * @brief requests a block for writing after a write hit or miss of a cache, all other
+ * copies of the block are invalidated. A dirty owner either writes the block back or,
+ * with MOESI, forwards it. The write of a cache which already owns the block
+ * exclusively doesn't need the directory and adds no latency.
+ * @param cache_id the requesting cache
+ * @param address the address of the block
+ * @param data receives the block if it is forwarded, nullptr if the requesting cache
+ * doesn't need the data of the block
+ * @param allocate if the requesting cache allocates the block, otherwise the write
+ * goes to the next level data storage and the block is dropped from all caches
+ */
+CoherenceTransaction CoherenceDirectory::write(size_t cache_id, address_t address,
+                                               Data* data, bool allocate) {
+    CoherenceTransaction transaction;
+
+    uint64_t cache_bit = 1ull << cache_id;
+    int32_t requester = static_cast<int32_t>(cache_id);
+
+    auto it = entries_.find(address);
+    if (it == entries_.end()) {
+        transaction.latency = lookup_latency_;
+        if (allocate) {
+            entries_.insert({address, {cache_bit, requester, COHERENCE_MODIFIED}});
+        }
+        return transaction;
+    }
+
+    DirectoryEntry& entry = it->second;
+
+    // silent upgrade from exclusive to modified
+    if (entry.owner == requester &&
+        (entry.state == COHERENCE_EXCLUSIVE || entry.state == COHERENCE_MODIFIED)) {
+        entry.state = COHERENCE_MODIFIED;
+        return transaction;
+    }
+
+    transaction.latency = lookup_latency_;
+
+    uint64_t other_sharers = entry.sharers & ~cache_bit;
+    bool is_sharer = (entry.sharers & cache_bit) != 0;
+
+    if (entry.owner != -1 && entry.owner != requester) {
+        SetAssociativeCache* owner = caches_[entry.owner];
+        bool dirty =
+            entry.state == COHERENCE_MODIFIED || entry.state == COHERENCE_OWNED;
+
+        transaction.interventions++;
+
+        // a sharer has an up to date copy and takes over the dirty block
+        if (dirty && allocate && !is_sharer && protocol_ == MOESI && data != nullptr) {
+            owner->snoop(address, true, false, data);
+            transaction.forwarded = true;
+        } else {
+            transaction.latency += owner->snoop(address, true, dirty && !is_sharer,
+                                                nullptr);
+        }
+
+        other_sharers &= ~(1ull << entry.owner);
+    }
+
+    while (other_sharers != 0) {
+        size_t sharer = std::countr_zero(other_sharers);
+        other_sharers &= other_sharers - 1;
+
+        caches_[sharer]->snoop(address, true, false, nullptr);
+        transaction.invalidations++;
+    }
+
+    if (transaction.invalidations > 0 || transaction.interventions > 0) {
+        transaction.latency += snoop_latency_;
+    }
+
+    if (allocate) {
+        entry = {cache_bit, requester, COHERENCE_MODIFIED};
+    } else {
+        entries_.erase(it);
+    }
+
+    invalidations_ += transaction.invalidations;
+    interventions_ += transaction.interventions;
+
+    return transaction;
+}
+
+void CoherenceDirectory::remove_sharer(
+    std::unordered_map<address_t, DirectoryEntry>::iterator it, size_t cache_id) {
+    DirectoryEntry& entry = it->second;
+
+    entry.sharers &= ~(1ull << cache_id);
+    if (entry.owner == static_cast<int32_t>(cache_id)) {
+        entry.owner = -1;
+        entry.state = COHERENCE_SHARED;
+    }
+
+    if (entry.sharers == 0) {
+        entries_.erase(it);
+    }
+}
+
+/**
+ * @brief notifies the directory that a cache evicted a block, a dirty block has to be
+ * written back by the cache itself
+ */
+void CoherenceDirectory::evict(size_t cache_id, address_t address) {
+    auto it = entries_.find(address);
+    if (it != entries_.end()) {
+        remove_sharer(it, cache_id);
+    }
+}
+
+/**
+ * @brief notifies the directory that a cache invalidated all its blocks
+ */
+void CoherenceDirectory::evict_all(size_t cache_id) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        auto next = std::next(it);
+        remove_sharer(it, cache_id);
+        it = next;
+    }
+}
+
+/**
+ * @brief returns the state of a block in a cache
+ */
+CoherenceState CoherenceDirectory::get_state(size_t cache_id, address_t address) {
+    auto it = entries_.find(address);
+    if (it == entries_.end() || (it->second.sharers & (1ull << cache_id)) == 0) {
+        return COHERENCE_INVALID;
+    }
+
+    if (it->second.owner == static_cast<int32_t>(cache_id)) {
+        return it->second.state;
+    }
+    return COHERENCE_SHARED;
+}
+
+CoherenceProtocol CoherenceDirectory::get_protocol() { return protocol_; }
+
+/**
+ * @brief returns the number of blocks cached by any of the caches
+ */
+size_t CoherenceDirectory::get_entry_count() { return entries_.size(); }
+
+uint64_t CoherenceDirectory::get_invalidation_count() { return invalidations_; }
+
+uint64_t CoherenceDirectory::get_intervention_count() { return interventions_; }
+
+/**
+ * @brief copies the directory with all entries, the caches of the copy have to be
+ * registered with set_cache
+ */
+std::shared_ptr<CoherenceDirectory> CoherenceDirectory::clone() {
+    auto directory = std::make_shared<CoherenceDirectory>(protocol_, lookup_latency_,
+                                                          snoop_latency_);
+    directory->entries_ = entries_;
+    directory->invalidations_ = invalidations_;
+    directory->interventions_ = interventions_;
+    return directory;
+}
+}  // namespace kachesim
@@ -67,5 +67,9 @@ std::string Data::to_string() {
 
 size_t Data::size() const { return size_; }
 
+uint8_t* Data::data() { return data_; }
+
+const uint8_t* Data::data() const { return data_; }
+
 Data::~Data() { delete[] data_; }
 }  // namespace kachesim
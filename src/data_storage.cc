@@ -3,4 +3,44 @@
 namespace kachesim {
 DataStorage::DataStorage() = default;
 DataStorage::~DataStorage() = default;
+
+/**
+ * @brief returns the number of addressable bytes, i.e. the size of the memory at the
+ * end of the hierarchy. Caches forward this to their next level data storage.
+ */
+size_t DataStorage::get_address_space_size() { return size(); }
+
+/**
+ * @brief writes data in timed mode, the access is issued in the given cycle and the
+ * transaction contains the cycle in which it completes. Data storages without internal
+ * timing state complete after their latency.
+ * @param cycle the cycle in which the access is issued
+ * @param address the address to write to
+ * @param data the data to write
+ */
+DataStorageTransaction DataStorage::write_at(cycle_t cycle, address_t address,
+                                             Data& data) {
+    auto dst = write(address, data);
+    dst.completion_cycle = cycle + dst.latency;
+    return dst;
+}
+
+/**
+ * @brief reads data in timed mode, see write_at
+ * @param cycle the cycle in which the access is issued
+ * @param address the address to read from
+ * @param num_bytes the number of bytes to read
+ */
+DataStorageTransaction DataStorage::read_at(cycle_t cycle, address_t address,
+                                            size_t num_bytes) {
+    auto dst = read(address, num_bytes);
+    dst.completion_cycle = cycle + dst.latency;
+    return dst;
+}
+
+/**
+ * @brief enables or disables concurrent accesses from multiple threads, data storages
+ * which aren't thread-safe by themselves override this
+ */
+void DataStorage::set_concurrent([[maybe_unused]] bool concurrent) {}
 }  // namespace kachesim
@@ -0,0 +1,120 @@
+#include "kachesim/dirty_page_bitmap.h"
+
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+DirtyPageBitmap::DirtyPageBitmap(size_t page_size) : page_size_(page_size) {
+    if (page_size_ == 0 || (page_size_ & (page_size_ - 1)) != 0) {
+        std::string err_msg = std::string("page size ") +
+                              int_to_hex<uint64_t>(page_size_) +
+                              std::string(" is not a power of two");
+        THROW_INVALID_ARGUMENT(err_msg);
+    }
+
+    page_bits_ = clog2(page_size_);
+}
+
+DirtyPageBitmap::DirtyPageBitmap(const DirtyPageBitmap& dirty_page_bitmap) {
+    *this = dirty_page_bitmap;
+}
+
+/**
+ * @brief copies all dirty pages, the cached last chunk is not copied since it points
+ * into the chunks of the other bitmap
+ */
+DirtyPageBitmap& DirtyPageBitmap::operator=(const DirtyPageBitmap& dirty_page_bitmap) {
+    page_size_ = dirty_page_bitmap.page_size_;
+    page_bits_ = dirty_page_bitmap.page_bits_;
+    chunks_ = dirty_page_bitmap.chunks_;
+    dirty_pages_ = dirty_page_bitmap.dirty_pages_;
+    last_chunk_ = nullptr;
+
+    return *this;
+}
+
+size_t DirtyPageBitmap::page_size() const { return page_size_; }
+
+/**
+ * @brief marks all pages which overlap with the address range as dirty
+ * @param address the first written address
+ * @param num_bytes the number of written bytes
+ */
+void DirtyPageBitmap::mark(address_t address, size_t num_bytes) {
+    if (num_bytes == 0) {
+        return;
+    }
+
+    uint64_t first_page = address >> page_bits_;
+    uint64_t last_page = (address + num_bytes - 1) >> page_bits_;
+
+    for (uint64_t page = first_page; page <= last_page; page++) {
+        uint64_t chunk_index = page >> chunk_bits_;
+
+        if (last_chunk_ == nullptr || chunk_index != last_chunk_index_) {
+            // chunks are value initialized to 0 and never move inside of the map
+            last_chunk_ = &chunks_[chunk_index];
+            last_chunk_index_ = chunk_index;
+        }
+
+        uint64_t bit = page & bitmask<uint64_t>(chunk_bits_);
+        uint64_t& word = (*last_chunk_)[bit / 64];
+        uint64_t mask = uint64_t(1) << (bit % 64);
+
+        if ((word & mask) == 0) {
+            word |= mask;
+            dirty_pages_++;
+        }
+    }
+}
+
+/**
+ * @brief checks if the page containing address is dirty
+ */
+bool DirtyPageBitmap::is_dirty(address_t address) const {
+    uint64_t page = address >> page_bits_;
+
+    auto it = chunks_.find(page >> chunk_bits_);
+    if (it == chunks_.end()) {
+        return false;
+    }
+
+    uint64_t bit = page & bitmask<uint64_t>(chunk_bits_);
+    return (it->second[bit / 64] >> (bit % 64)) & 1;
+}
+
+size_t DirtyPageBitmap::get_dirty_page_count() const { return dirty_pages_; }
+
+/**
+ * @brief returns the numbers of all dirty pages in ascending order
+ */
+std::vector<uint64_t> DirtyPageBitmap::get_dirty_pages() const {
+    std::vector<uint64_t> dirty_pages;
+    dirty_pages.reserve(dirty_pages_);
+
+    for (const auto& [chunk_index, chunk] : chunks_) {
+        for (uint32_t i = 0; i < chunk_words_; i++) {
+            uint64_t word = chunk[i];
+            while (word != 0) {
+                uint32_t bit = std::countr_zero(word);
+                dirty_pages.push_back((chunk_index << chunk_bits_) + i * 64 + bit);
+                word &= word - 1;
+            }
+        }
+    }
+
+    return dirty_pages;
+}
+
+/**
+ * @brief marks all pages as clean
+ */
+void DirtyPageBitmap::clear() {
+    chunks_.clear();
+    dirty_pages_ = 0;
+    last_chunk_ = nullptr;
+}
+}  // namespace kachesim
@@ -0,0 +1,356 @@
+#include "kachesim/dram_memory.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "kachesim/backing_store/dense_backing_store.h"
+#include "kachesim/common.h"
+
+namespace kachesim {
+// precharge cycle of a row which is open until an access to another row
+static constexpr cycle_t OPEN_ROW = std::numeric_limits<cycle_t>::max();
+
+DramMemory::DramMemory(const std::string& name, uint64_t size, latency_t read_latency,
+                       latency_t write_latency, size_t channels, size_t ranks,
+                       size_t banks, size_t row_size, size_t burst_size,
+                       DramRowPolicy row_policy, DramTimings timings)
+    : DramMemory(name, std::make_shared<DenseBackingStore>(size), read_latency,
+                 write_latency, channels, ranks, banks, row_size, burst_size,
+                 row_policy, timings) {}
+
+DramMemory::DramMemory(const std::string& name,
+                       std::shared_ptr<BackingStore> backing_store,
+                       latency_t read_latency, latency_t write_latency, size_t channels,
+                       size_t ranks, size_t banks, size_t row_size, size_t burst_size,
+                       DramRowPolicy row_policy, DramTimings timings)
+    : FakeMemory(name, backing_store, read_latency, write_latency),
+      channels_(channels),
+      ranks_(ranks),
+      banks_(banks),
+      row_size_(row_size),
+      burst_size_(burst_size),
+      row_policy_(row_policy),
+      timings_(timings) {
+    if (channels_ == 0 || ranks_ == 0 || banks_ == 0) {
+        THROW_INVALID_ARGUMENT("DRAM without channels, ranks or banks");
+    }
+    if (burst_size_ == 0 || row_size_ == 0 || row_size_ % burst_size_ != 0) {
+        THROW_INVALID_ARGUMENT("row size of DRAM is not a multiple of the burst size");
+    }
+
+    bank_states_ = std::vector<Bank>(channels_ * ranks_ * banks_);
+    data_buses_ = std::vector<std::map<cycle_t, cycle_t>>(channels_);
+}
+
+/**
+ * @brief write data to memory, the latency depends on the row buffers
+ * @param address the address to write to
+ * @param data the data to write
+ */
+DataStorageTransaction DramMemory::write(address_t address, Data& data) {
+    auto dst = FakeMemory::write(address, data);
+
+    auto memory_lock = lock();
+    dst.latency = write_latency_ + access(address, data.size());
+    return dst;
+}
+
+/**
+ * @brief read data from memory, the latency depends on the row buffers
+ * @param address the address to read from
+ * @param num_bytes the number of bytes to read
+ */
+DataStorageTransaction DramMemory::read(address_t address, size_t num_bytes) {
+    auto dst = FakeMemory::read(address, num_bytes);
+
+    auto memory_lock = lock();
+    dst.latency = read_latency_ + access(address, num_bytes);
+    return dst;
+}
+
+/**
+ * @brief writes data in timed mode, the commands of the write are scheduled after the
+ * latency of the controller
+ * @param cycle the cycle in which the access is issued
+ * @param address the address to write to
+ * @param data the data to write
+ */
+DataStorageTransaction DramMemory::write_at(cycle_t cycle, address_t address,
+                                            Data& data) {
+    auto dst = FakeMemory::write(address, data);
+
+    auto memory_lock = lock();
+    dst.completion_cycle = access_at(cycle + write_latency_, address, data.size());
+    dst.latency = dst.completion_cycle - cycle;
+    return dst;
+}
+
+/**
+ * @brief reads data in timed mode, see write_at
+ * @param cycle the cycle in which the access is issued
+ * @param address the address to read from
+ * @param num_bytes the number of bytes to read
+ */
+DataStorageTransaction DramMemory::read_at(cycle_t cycle, address_t address,
+                                           size_t num_bytes) {
+    auto dst = FakeMemory::read(address, num_bytes);
+
+    auto memory_lock = lock();
+    dst.completion_cycle = access_at(cycle + read_latency_, address, num_bytes);
+    dst.latency = dst.completion_cycle - cycle;
+    return dst;
+}
+
+size_t DramMemory::get_channels() { return channels_; }
+
+size_t DramMemory::get_ranks() { return ranks_; }
+
+size_t DramMemory::get_banks() { return banks_; }
+
+size_t DramMemory::get_row_size() { return row_size_; }
+
+size_t DramMemory::get_burst_size() { return burst_size_; }
+
+DramRowPolicy DramMemory::get_row_policy() { return row_policy_; }
+
+DramTimings DramMemory::get_timings() { return timings_; }
+
+DramStats DramMemory::get_stats() { return stats_; }
+
+void DramMemory::reset_stats() { stats_ = DramStats(); }
+
+/**
+ * @brief returns the channel, bank and row of an address
+ */
+DramMemory::Location DramMemory::locate(address_t address) {
+    address_t unit = address / row_size_;
+
+    size_t channel = unit % channels_;
+    unit /= channels_;
+    size_t bank = unit % banks_;
+    unit /= banks_;
+    size_t rank = unit % ranks_;
+    address_t row = unit / ranks_;
+
+    return {channel, (channel * ranks_ + rank) * banks_ + bank, row};
+}
+
+/**
+ * @brief returns the number of column accesses needed for an access
+ */
+size_t DramMemory::count_bursts(address_t address, size_t num_bytes) {
+    return (address + num_bytes - 1) / burst_size_ - address / burst_size_ + 1;
+}
+
+/**
+ * @brief updates the row buffers for an access without a timing model
+ * @return the latency of the access without the latency of the controller
+ */
+latency_t DramMemory::access(address_t address, size_t num_bytes) {
+    latency_t latency = 0;
+    address_t end = address + num_bytes;
+
+    for (address_t chunk = address; chunk < end;) {
+        address_t chunk_end =
+            std::min<address_t>(end, (chunk / row_size_ + 1) * row_size_);
+
+        Location location = locate(chunk);
+        Bank& bank = bank_states_[location.bank];
+
+        latency_t chunk_latency =
+            timings_.t_cas + count_bursts(chunk, chunk_end - chunk) * timings_.t_burst;
+
+        if (bank.row_open && bank.open_row == location.row) {
+            stats_.row_hits++;
+        } else if (bank.row_open) {
+            stats_.row_conflicts++;
+            chunk_latency += timings_.t_rp + timings_.t_rcd;
+        } else {
+            stats_.row_misses++;
+            chunk_latency += timings_.t_rcd;
+        }
+
+        bank.row_open = row_policy_ == OPEN_ROW_POLICY;
+        bank.open_row = location.row;
+
+        latency = std::max(latency, chunk_latency);
+        chunk = chunk_end;
+    }
+
+    return latency;
+}
+
+/**
+ * @brief schedules the rows of a timed access
+ * @param cycle the cycle in which the access reaches the DRAM
+ * @return the cycle in which the access completes
+ */
+cycle_t DramMemory::access_at(cycle_t cycle, address_t address, size_t num_bytes) {
+    newest_cycle_ = std::max(newest_cycle_, cycle);
+
+    cycle_t completion_cycle = cycle;
+    address_t end = address + num_bytes;
+
+    for (address_t chunk = address; chunk < end;) {
+        address_t chunk_end =
+            std::min<address_t>(end, (chunk / row_size_ + 1) * row_size_);
+
+        cycle_t chunk_completion_cycle =
+            schedule(cycle, locate(chunk), count_bursts(chunk, chunk_end - chunk));
+        completion_cycle = std::max(completion_cycle, chunk_completion_cycle);
+
+        chunk = chunk_end;
+    }
+
+    return completion_cycle;
+}
+
+/**
+ * @brief schedules the commands and the data transfer of an access to one row. A row
+ * hit uses the first window of its row in which it fits before the precharge, so it
+ * may overtake older accesses to other rows of the bank. Otherwise the newest row is
+ * precharged if it is still open and the row is activated.
+ * @param cycle the cycle in which the access reaches the DRAM
+ * @param location the bank and row of the access
+ * @param bursts the number of column accesses
+ * @return the cycle in which the data transfer completes
+ */
+cycle_t DramMemory::schedule(cycle_t cycle, const Location& location, size_t bursts) {
+    Bank& bank = bank_states_[location.bank];
+    latency_t transfer_cycles = bursts * timings_.t_burst;
+
+    // drop rows and transfers which are too old to affect new accesses
+    if (newest_cycle_ > history_cycles) {
+        cycle_t horizon = newest_cycle_ - history_cycles;
+
+        while (bank.row_windows.size() > 1 &&
+               bank.row_windows.front().precharge_cycle <= horizon) {
+            bank.row_windows.pop_front();
+        }
+
+        auto& data_bus = data_buses_[location.channel];
+        while (!data_bus.empty() && data_bus.begin()->second <= horizon) {
+            data_bus.erase(data_bus.begin());
+        }
+    }
+
+    for (auto& row_window : bank.row_windows) {
+        if (row_window.row != location.row) {
+            continue;
+        }
+
+        cycle_t column_cycle = std::max(cycle, row_window.column_cycle);
+        cycle_t data_cycle = find_data_bus_slot(
+            location.channel, column_cycle + timings_.t_cas, transfer_cycles);
+        column_cycle = data_cycle - timings_.t_cas;
+
+        if (row_window.precharge_cycle != OPEN_ROW &&
+            column_cycle + transfer_cycles > row_window.precharge_cycle) {
+            continue;
+        }
+
+        reserve_data_bus(location.channel, data_cycle, transfer_cycles);
+        row_window.column_cycle = column_cycle + transfer_cycles;
+        stats_.row_hits++;
+
+        return data_cycle + transfer_cycles;
+    }
+
+    cycle_t activate_cycle;
+
+    if (!bank.row_windows.empty() &&
+        bank.row_windows.back().precharge_cycle == OPEN_ROW) {
+        auto& open_window = bank.row_windows.back();
+        cycle_t precharge_cycle =
+            std::max({cycle, open_window.column_cycle,
+                      open_window.activate_cycle + timings_.t_ras});
+
+        open_window.precharge_cycle = precharge_cycle;
+        bank.activate_cycle = precharge_cycle + timings_.t_rp;
+        activate_cycle = bank.activate_cycle;
+        stats_.row_conflicts++;
+    } else {
+        activate_cycle = std::max(cycle, bank.activate_cycle);
+        stats_.row_misses++;
+    }
+
+    cycle_t data_cycle = find_data_bus_slot(
+        location.channel, activate_cycle + timings_.t_rcd + timings_.t_cas,
+        transfer_cycles);
+    cycle_t column_cycle = data_cycle - timings_.t_cas;
+    reserve_data_bus(location.channel, data_cycle, transfer_cycles);
+
+    RowWindow row_window = {location.row, activate_cycle,
+                            column_cycle + transfer_cycles, OPEN_ROW};
+
+    if (row_policy_ == CLOSED_ROW_POLICY) {
+        row_window.precharge_cycle =
+            std::max(row_window.column_cycle, activate_cycle + timings_.t_ras);
+        bank.activate_cycle = row_window.precharge_cycle + timings_.t_rp;
+    }
+
+    bank.row_windows.push_back(row_window);
+
+    return data_cycle + transfer_cycles;
+}
+
+/**
+ * @brief returns the first cycle from which the data bus of a channel is free for a
+ * number of cycles
+ */
+cycle_t DramMemory::find_data_bus_slot(size_t channel, cycle_t cycle,
+                                       latency_t cycles) {
+    auto& data_bus = data_buses_[channel];
+
+    auto it = data_bus.upper_bound(cycle);
+    if (it != data_bus.begin()) {
+        cycle = std::max(cycle, std::prev(it)->second);
+    }
+
+    for (; it != data_bus.end() && it->first < cycle + cycles; ++it) {
+        cycle = std::max(cycle, it->second);
+    }
+
+    return cycle;
+}
+
+/**
+ * @brief occupies the data bus of a channel, the cycles must be free
+ */
+void DramMemory::reserve_data_bus(size_t channel, cycle_t cycle, latency_t cycles) {
+    if (cycles != 0) {
+        data_buses_[channel].insert({cycle, cycle + cycles});
+    }
+}
+
+/**
+ * @brief creates an independent copy of the memory with the same row buffers and
+ * scheduling state, the content is shared copy-on-write like in FakeMemory
+ * @return the copy of the memory
+ */
+std::shared_ptr<MemoryInterface> DramMemory::clone() {
+    auto dram_memory = std::make_shared<DramMemory>(
+        get_name(), clone_backing_store(), read_latency_, write_latency_, channels_,
+        ranks_, banks_, row_size_, burst_size_, row_policy_, timings_);
+    dram_memory->dirty_pages_ = dirty_pages_;
+    dram_memory->concurrent_ = concurrent_;
+
+    dram_memory->bank_states_ = bank_states_;
+    dram_memory->data_buses_ = data_buses_;
+    dram_memory->newest_cycle_ = newest_cycle_;
+    dram_memory->stats_ = stats_;
+
+    return dram_memory;
+}
+
+/**
+ * @brief reset the content of the memory and close all rows
+ */
+void DramMemory::reset() {
+    FakeMemory::reset();
+
+    bank_states_ = std::vector<Bank>(channels_ * ranks_ * banks_);
+    data_buses_ = std::vector<std::map<cycle_t, cycle_t>>(channels_);
+    newest_cycle_ = 0;
+}
+}  // namespace kachesim
@@ -0,0 +1,188 @@
+#include "elf_parser.h"
+
+#include <elf.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+/**
+ * @brief copies a header of type T from the file, headers in the file are not
+ * necessarily aligned
+ * @throws std::runtime_error if the header exceeds the file
+ */
+template <typename T>
+static T read_elf_struct(const uint8_t* data, size_t size, uint64_t offset) {
+    if (offset > size || sizeof(T) > size - offset) {
+        std::string err_msg = std::string("ELF header at offset ") +
+                              int_to_hex<uint64_t>(offset) +
+                              std::string(" exceeds the file");
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    T value;
+    memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief reads the symbols of type function or object from a symbol table section
+ */
+template <typename Shdr, typename Sym>
+static void parse_elf_symbols(const uint8_t* data, size_t size,
+                              const std::vector<Shdr>& section_headers,
+                              const Shdr& symbol_table,
+                              std::vector<ElfSymbol>& symbols) {
+    if (symbol_table.sh_link >= section_headers.size()) {
+        THROW_RUNTIME_ERROR("ELF symbol table links to an invalid string table");
+    }
+
+    const Shdr& string_table = section_headers[symbol_table.sh_link];
+    if (string_table.sh_offset > size ||
+        string_table.sh_size > size - string_table.sh_offset) {
+        THROW_RUNTIME_ERROR("ELF string table exceeds the file");
+    }
+
+    const char* strings = reinterpret_cast<const char*>(data + string_table.sh_offset);
+
+    uint64_t entry_size =
+        symbol_table.sh_entsize != 0 ? symbol_table.sh_entsize : sizeof(Sym);
+    uint64_t num_symbols = symbol_table.sh_size / entry_size;
+
+    for (uint64_t i = 0; i < num_symbols; i++) {
+        auto symbol =
+            read_elf_struct<Sym>(data, size, symbol_table.sh_offset + i * entry_size);
+
+        uint8_t type = symbol.st_info & 0xf;
+        if (symbol.st_shndx == SHN_UNDEF || (type != STT_FUNC && type != STT_OBJECT)) {
+            continue;
+        }
+
+        std::string name;
+        if (symbol.st_name < string_table.sh_size) {
+            name = std::string(strings + symbol.st_name,
+                               strnlen(strings + symbol.st_name,
+                                       string_table.sh_size - symbol.st_name));
+        }
+
+        symbols.push_back({name, symbol.st_value, symbol.st_size,
+                           type == STT_FUNC ? ELF_SYMBOL_FUNCTION : ELF_SYMBOL_OBJECT});
+    }
+}
+
+/**
+ * @brief parses the program headers and symbol tables of an ELF file of one class
+ */
+template <typename Ehdr, typename Phdr, typename Shdr, typename Sym>
+static ElfImage parse_elf_class(const uint8_t* data, size_t size) {
+    ElfImage image;
+
+    auto header = read_elf_struct<Ehdr>(data, size, 0);
+
+    image.entry_point = header.e_entry;
+    image.is_64_bit = sizeof(Ehdr) == sizeof(Elf64_Ehdr);
+
+    // program headers
+    if (header.e_phnum > 0 && header.e_phentsize < sizeof(Phdr)) {
+        THROW_RUNTIME_ERROR("ELF program header size is invalid");
+    }
+
+    for (uint64_t i = 0; i < header.e_phnum; i++) {
+        auto program_header =
+            read_elf_struct<Phdr>(data, size, header.e_phoff + i * header.e_phentsize);
+
+        if (program_header.p_type != PT_LOAD) {
+            continue;
+        }
+
+        if (program_header.p_offset > size ||
+            program_header.p_filesz > size - program_header.p_offset) {
+            std::string err_msg = std::string("ELF segment ") + std::to_string(i) +
+                                  std::string(" exceeds the file");
+            THROW_RUNTIME_ERROR(err_msg);
+        }
+
+        if (program_header.p_filesz > program_header.p_memsz) {
+            std::string err_msg = std::string("ELF segment ") + std::to_string(i) +
+                                  std::string(" is larger in the file than in memory");
+            THROW_RUNTIME_ERROR(err_msg);
+        }
+
+        image.segments.push_back({program_header.p_paddr, program_header.p_vaddr,
+                                  program_header.p_offset, program_header.p_filesz,
+                                  program_header.p_memsz,
+                                  (program_header.p_flags & PF_R) != 0,
+                                  (program_header.p_flags & PF_W) != 0,
+                                  (program_header.p_flags & PF_X) != 0});
+    }
+
+    // section headers are optional and only needed for the symbols
+    if (header.e_shoff == 0 || header.e_shnum == 0) {
+        return image;
+    }
+
+    if (header.e_shentsize < sizeof(Shdr)) {
+        THROW_RUNTIME_ERROR("ELF section header size is invalid");
+    }
+
+    std::vector<Shdr> section_headers;
+    for (uint64_t i = 0; i < header.e_shnum; i++) {
+        section_headers.push_back(
+            read_elf_struct<Shdr>(data, size, header.e_shoff + i * header.e_shentsize));
+    }
+
+    // prefer the full symbol table and fall back to the dynamic symbols
+    for (uint32_t symbol_table_type : {SHT_SYMTAB, SHT_DYNSYM}) {
+        for (const auto& section_header : section_headers) {
+            if (section_header.sh_type == symbol_table_type) {
+                parse_elf_symbols<Shdr, Sym>(data, size, section_headers,
+                                             section_header, image.symbols);
+            }
+        }
+        if (!image.symbols.empty()) {
+            break;
+        }
+    }
+
+    std::stable_sort(image.symbols.begin(), image.symbols.end(),
+                     [](const ElfSymbol& a, const ElfSymbol& b) {
+                         return a.address < b.address;
+                     });
+
+    return image;
+}
+
+/**
+ * @brief parses an ELF32 or ELF64 file with the byte order of the host
+ * @param data the content of the file
+ * @param size the size of the file
+ * @return the entry point, the loadable segments and the symbols of the file
+ * @throws std::runtime_error if the file is not a valid ELF file
+ */
+ElfImage parse_elf(const uint8_t* data, size_t size) {
+    if (size < EI_NIDENT || memcmp(data, ELFMAG, SELFMAG) != 0) {
+        THROW_RUNTIME_ERROR("file is not an ELF file");
+    }
+
+    uint8_t host_data_encoding =
+        std::endian::native == std::endian::little ? ELFDATA2LSB : ELFDATA2MSB;
+    if (data[EI_DATA] != host_data_encoding) {
+        THROW_RUNTIME_ERROR("ELF files with a different byte order are not supported");
+    }
+
+    if (data[EI_CLASS] == ELFCLASS32) {
+        return parse_elf_class<Elf32_Ehdr, Elf32_Phdr, Elf32_Shdr, Elf32_Sym>(data,
+                                                                              size);
+    } else if (data[EI_CLASS] == ELFCLASS64) {
+        return parse_elf_class<Elf64_Ehdr, Elf64_Phdr, Elf64_Shdr, Elf64_Sym>(data,
+                                                                              size);
+    }
+
+    THROW_RUNTIME_ERROR("ELF class is unknown");
+}
+}  // namespace kachesim
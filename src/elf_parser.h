@@ -0,0 +1,13 @@
+#ifndef ELF_PARSER_H
+#define ELF_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "kachesim/elf_image.h"
+
+namespace kachesim {
+ElfImage parse_elf(const uint8_t* data, size_t size);
+}  // namespace kachesim
+
+#endif
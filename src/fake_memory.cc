@@ -1,21 +1,36 @@
 #include "kachesim/fake_memory.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 
+#include "elf_parser.h"
+#include "kachesim/backing_store/cow_backing_store.h"
+#include "kachesim/backing_store/dense_backing_store.h"
 #include "kachesim/common.h"
+#include "mapped_file.h"
 
 namespace kachesim {
 FakeMemory::FakeMemory(const std::string& name, uint64_t size, latency_t read_latency,
                        latency_t write_latency)
-    : name_(name), size_(size) {
+    : FakeMemory(name, std::make_shared<DenseBackingStore>(size), read_latency,
+                 write_latency) {}
+
+FakeMemory::FakeMemory(const std::string& name,
+                       std::shared_ptr<BackingStore> backing_store,
+                       latency_t read_latency, latency_t write_latency)
+    : backing_store_(backing_store), name_(name), size_(backing_store->size()) {
     read_latency_ = read_latency;
     write_latency_ = write_latency;
-    reset();
 }
 
 std::string FakeMemory::get_name() { return name_; }
@@ -28,18 +43,10 @@ size_t FakeMemory::size() { return size_; }
  * @param data the data to write
  */
 DataStorageTransaction FakeMemory::write(address_t address, Data& data) {
-    // check if address is in range
-    if (address + data.size() > size_) {
-        std::string err_msg =
-            std::string("write address ") + int_to_hex<uint64_t>(address) +
-            std::string(" + ") + int_to_hex<uint64_t>(data.size()) +
-            std::string(" is out of range for size ") + int_to_hex<uint64_t>(size_);
-        THROW_OUT_OF_RANGE(err_msg);
-    }
+    check_address_range("write", address, data.size());
 
-    for (int i = 0; i < data.size(); i++) {
-        data_[address + i] = data[i];
-    }
+    auto memory_lock = lock();
+    write_backing_store(address, data.data(), data.size());
 
     DataStorageTransaction dst = {WRITE, address, write_latency_, 0, data};
 
@@ -56,20 +63,12 @@ DataStorageTransaction FakeMemory::write(address_t address, Data& data) {
  * @return bytes read from memory
  */
 DataStorageTransaction FakeMemory::read(address_t address, size_t num_bytes) {
-    // check if address is in range
-    if (address + num_bytes > size_) {
-        std::string err_msg =
-            std::string("read address ") + int_to_hex<uint64_t>(address) +
-            std::string(" + ") + int_to_hex<uint64_t>(num_bytes) +
-            std::string(" is out of range for size ") + int_to_hex<uint64_t>(size_);
-        THROW_OUT_OF_RANGE(err_msg);
-    }
+    check_address_range("read", address, num_bytes);
 
     Data data = Data(num_bytes);
 
-    for (int i = 0; i < num_bytes; i++) {
-        data[i] = data_[address + i];
-    }
+    auto memory_lock = lock();
+    backing_store_->read(address, data.data(), num_bytes);
 
     DataStorageTransaction dst = {READ, address, read_latency_, 0, data};
 
@@ -79,15 +78,157 @@ DataStorageTransaction FakeMemory::read(address_t address, size_t num_bytes) {
     return dst;
 }
 
+// characters in hex memory files which are not hex digits
+static constexpr int8_t HEX_CHAR_SKIP = -1;
+static constexpr int8_t HEX_CHAR_NEWLINE = -2;
+static constexpr int8_t HEX_CHAR_INVALID = -3;
+
+// size of the chunks in which files are read, parsed and written
+static constexpr size_t FILE_CHUNK_SIZE = 16 * 1024 * 1024;
+
+/**
+ * @brief creates a table which maps each character to its hex value or to one of the
+ * HEX_CHAR_* constants
+ */
+static constexpr std::array<int8_t, 256> create_hex_char_table() {
+    std::array<int8_t, 256> table{};
+
+    for (int i = 0; i < 256; i++) {
+        table[i] = HEX_CHAR_INVALID;
+    }
+    for (int i = 0; i < 10; i++) {
+        table['0' + i] = i;
+    }
+    for (int i = 0; i < 6; i++) {
+        table['a' + i] = 10 + i;
+        table['A' + i] = 10 + i;
+    }
+
+    table[' '] = HEX_CHAR_SKIP;
+    table['\r'] = HEX_CHAR_SKIP;
+    table['\n'] = HEX_CHAR_NEWLINE;
+
+    return table;
+}
+
+static constexpr std::array<int8_t, 256> hex_char_table = create_hex_char_table();
+
+static constexpr char hex_digits[] = "0123456789abcdef";
+
 /**
- * @brief read memory from hex file
+ * @brief decodes the lines of a hex memory file and appends the bytes to data. Each
+ * line is read from right to left, the two right most hex digits are the byte with the
+ * lowest address. If a line has an odd number of hex digits the left most digit is the
+ * last byte.
+ * @param begin the first character of the first line
+ * @param end the character after the last line
+ * @param data the vector to append the decoded bytes to
+ * @param limit stop after the first line which makes data contain at least limit bytes
+ * @return true if the limit was reached
+ * @throws std::runtime_error if a character is not a hex digit
+ */
+static bool decode_hex_lines(const uint8_t* begin, const uint8_t* end,
+                             std::vector<uint8_t>& data,
+                             int64_t limit = std::numeric_limits<int64_t>::max()) {
+    std::vector<uint8_t> nibbles;
+
+    const uint8_t* c = begin;
+
+    while (c < end) {
+        nibbles.clear();
+
+        // collect the hex digits of the line
+        for (; c < end; c++) {
+            int8_t value = hex_char_table[*c];
+            if (value >= 0) {
+                nibbles.push_back(value);
+            } else if (value == HEX_CHAR_NEWLINE) {
+                c++;
+                break;
+            } else if (value == HEX_CHAR_INVALID) {
+                std::string err_msg = std::string("invalid character '") +
+                                      static_cast<char>(*c) +
+                                      std::string("' in hex memory file");
+                THROW_RUNTIME_ERROR(err_msg);
+            }
+        }
+
+        size_t num_bytes = (nibbles.size() + 1) / 2;
+        size_t data_index = data.size();
+        data.resize(data.size() + num_bytes);
+
+        // read nibbles from right to left
+        for (int64_t i = nibbles.size() - 1; i >= 0; i -= 2) {
+            uint8_t low = nibbles[i];
+            uint8_t high = i > 0 ? nibbles[i - 1] : 0;
+            data[data_index++] = (high << 4) | low;
+        }
+
+        if ((int64_t)data.size() >= limit) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief splits a file into chunks of about FILE_CHUNK_SIZE characters which end after
+ * a newline
+ * @param begin the first character of the file
+ * @param end the character after the last character of the file
+ * @return the begin of each chunk and the end of the last chunk
+ */
+static std::vector<const uint8_t*> split_into_line_chunks(const uint8_t* begin,
+                                                          const uint8_t* end) {
+    std::vector<const uint8_t*> chunk_boundaries = {begin};
+
+    const uint8_t* c = begin;
+
+    while (end - c > (int64_t)FILE_CHUNK_SIZE) {
+        c = static_cast<const uint8_t*>(memchr(c + FILE_CHUNK_SIZE, '\n',
+                                               end - c - FILE_CHUNK_SIZE));
+        if (c == nullptr) {
+            break;
+        }
+        c++;
+        chunk_boundaries.push_back(c);
+    }
+
+    if (chunk_boundaries.back() != end) {
+        chunk_boundaries.push_back(end);
+    }
+
+    return chunk_boundaries;
+}
+
+/**
+ * @brief checks if num_bytes starting from address fit into the memory
+ * @throws std::out_of_range if the range exceeds the memory
+ */
+void FakeMemory::check_address_range(const std::string& access, address_t address,
+                                     size_t num_bytes) {
+    if (address > size_ || num_bytes > size_ - address) {
+        std::string err_msg =
+            access + std::string(" address ") + int_to_hex<uint64_t>(address) +
+            std::string(" + ") + int_to_hex<uint64_t>(num_bytes) +
+            std::string(" is out of range for size ") + int_to_hex<uint64_t>(size_);
+        THROW_OUT_OF_RANGE(err_msg);
+    }
+}
+
+/**
+ * @brief read memory from hex file. The file is parsed in chunks, which can be decoded
+ * by multiple threads in parallel, and each chunk is copied into memory at once.
  * @param memory_file_path the path to the memory file
  * @param start_address the start address to read to
  * @param end_address the end address to read to (if the end_address is not set or is 0
  * it wont be considered)
+ * @param num_threads the number of threads used to decode the file
  */
 void FakeMemory::read_hex_memory_file(const std::string& memory_file_path,
-                                      address_t start_address, address_t end_address) {
+                                      address_t start_address, address_t end_address,
+                                      uint32_t num_threads) {
     // check if file exists
     std::filesystem::path p(memory_file_path);
     if (!std::filesystem::exists(p)) {
@@ -104,71 +245,76 @@ void FakeMemory::read_hex_memory_file(const std::string& memory_file_path,
         THROW_OUT_OF_RANGE(err_msg);
     }
 
-    std::ifstream memory_file;
+    num_threads = std::max<uint32_t>(num_threads, 1);
 
-    memory_file.open(memory_file_path, std::ios::in);
+    MappedFile memory_file(memory_file_path);
+
+    auto chunk_boundaries = split_into_line_chunks(
+        memory_file.data(), memory_file.data() + memory_file.size());
+    size_t num_chunks = chunk_boundaries.size() - 1;
+
+    // all lines are written until the first line which ends at or after end_address
+    int64_t limit = std::numeric_limits<int64_t>::max();
+    if (end_address != 0) {
+        limit = (int64_t)end_address - (int64_t)start_address;
+    }
 
-    if (memory_file.good()) {
-        char c;
-        char buffer[1024];
-        uint32_t buffer_index = 0;
-        uint64_t memory_address = start_address;
+    address_t memory_address = start_address;
+    int64_t bytes_written = 0;
 
-        while (memory_file.get(c)) {
-            // read into buffer until newline is found
-            if (c != ' ' && c != '\n') {
-                buffer[buffer_index] = c;
-                buffer_index++;
+    std::vector<std::vector<uint8_t>> chunk_data(
+        std::min<size_t>(num_threads, num_chunks));
+    std::vector<std::exception_ptr> chunk_exceptions(chunk_data.size());
+
+    for (size_t first_chunk = 0; first_chunk < num_chunks; first_chunk += num_threads) {
+        size_t batch_size = std::min<size_t>(num_threads, num_chunks - first_chunk);
+
+        auto decode_chunk = [&](size_t i) {
+            try {
+                chunk_data[i].clear();
+                decode_hex_lines(chunk_boundaries[first_chunk + i],
+                                 chunk_boundaries[first_chunk + i + 1], chunk_data[i]);
+            } catch (...) {
+                chunk_exceptions[i] = std::current_exception();
+            }
+        };
+
+        // decode a batch of chunks in parallel
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < batch_size; i++) {
+            threads.emplace_back(decode_chunk, i);
+        }
+        decode_chunk(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (size_t i = 0; i < batch_size; i++) {
+            if (chunk_exceptions[i]) {
+                std::rethrow_exception(chunk_exceptions[i]);
+            }
+
+            bool limit_reached = false;
+
+            // decode the chunk again to find the line at which the limit is reached
+            if (bytes_written + (int64_t)chunk_data[i].size() >= limit) {
+                chunk_data[i].clear();
+                limit_reached = decode_hex_lines(chunk_boundaries[first_chunk + i],
+                                                 chunk_boundaries[first_chunk + i + 1],
+                                                 chunk_data[i], limit - bytes_written);
             }
-            // if newline is found, convert buffer to data and write to memory
-            else if (c == '\n') {
-                buffer[buffer_index] = '\0';
-
-                size_t num_bytes;
-
-                // if buffer size is odd add one to make it even (because each byte are
-                // 2 chars)
-                if (buffer_index % 2 != 0) {
-                    num_bytes = buffer_index / 2 + 1;
-                } else {
-                    num_bytes = buffer_index / 2;
-                }
-
-                Data data(num_bytes);
-                uint32_t data_byte_index = 0;
-
-                char byte_chars[3];
-                byte_chars[2] = '\0';
-
-                // read buffer from right to left
-                for (int i = buffer_index - 1; i >= 0; i -= 2) {
-                    if (i - 1 == -1) {
-                        byte_chars[1] = buffer[i];
-                        byte_chars[0] = '0';
-                    } else {
-                        byte_chars[1] = buffer[i];
-                        byte_chars[0] = buffer[i - 1];
-                    }
-                    // convert byte_chars to integer
-                    uint32_t byte;
-                    std::stringstream ss;
-                    ss << byte_chars;
-                    ss >> std::hex >> byte;
-                    data[data_byte_index] = byte;
-                    data_byte_index++;
-                }
-                buffer_index = 0;
-
-                // write data to memory
-                write(memory_address, data);
-                memory_address += data.size();
-
-                if (end_address != 0 && memory_address >= end_address) {
-                    break;
-                }
+
+            check_address_range("write", memory_address, chunk_data[i].size());
+            write_backing_store(memory_address, chunk_data[i].data(),
+                                chunk_data[i].size());
+
+            memory_address += chunk_data[i].size();
+            bytes_written += chunk_data[i].size();
+
+            if (limit_reached) {
+                return;
             }
         }
-        memory_file.close();
     }
 }
 
@@ -177,6 +323,8 @@ void FakeMemory::read_hex_memory_file(const std::string& memory_file_path,
  * @param memory_file_path to write to
  * @param start_address the start address read from
  * @param end_address the end address to read from
+ * @param bytes_per_line number of bytes after which a new line is started, lines are
+ * aligned to multiples of bytes_per_line
  */
 void FakeMemory::write_hex_memory_file(const std::string& memory_file_path,
                                        address_t start_address, address_t end_address,
@@ -189,20 +337,44 @@ void FakeMemory::write_hex_memory_file(const std::string& memory_file_path,
         THROW_OUT_OF_RANGE(err_msg);
     }
 
+    if (bytes_per_line == 0) {
+        THROW_INVALID_ARGUMENT("bytes_per_line must not be 0");
+    }
+
     if (end_address == 0) {
         end_address = size_ - 1;
     }
 
+    uint64_t num_bytes = end_address - start_address + 1;
+
+    check_address_range("read", start_address, num_bytes);
+
     std::ofstream memory_file;
 
-    memory_file.open(memory_file_path, std::ios::out);
+    memory_file.open(memory_file_path, std::ios::out | std::ios::binary);
+
+    // two digits per byte and at most one newline per byte
+    std::vector<uint8_t> data(std::min<uint64_t>(FILE_CHUNK_SIZE, num_bytes));
+    std::string text;
+    text.reserve(data.size() * 3);
+
+    for (uint64_t offset = 0; offset < num_bytes; offset += data.size()) {
+        address_t address = start_address + offset;
+        size_t chunk_size = std::min<uint64_t>(data.size(), num_bytes - offset);
+        backing_store_->read(address, data.data(), chunk_size);
 
-    for (uint64_t i = start_address; i <= end_address; i++) {
-        memory_file << std::hex << std::setfill('0') << std::setw(2) << (int)data_[i];
-        if ((i + 1) % bytes_per_line == 0) {
-            memory_file << std::endl;
+        text.clear();
+        for (size_t i = 0; i < chunk_size; i++) {
+            text.push_back(hex_digits[data[i] >> 4]);
+            text.push_back(hex_digits[data[i] & 0xf]);
+            if ((address + i + 1) % bytes_per_line == 0) {
+                text.push_back('\n');
+            }
         }
+
+        memory_file.write(text.data(), text.size());
     }
+
     memory_file.close();
 }
 
@@ -234,21 +406,26 @@ void FakeMemory::read_bin_memory_file(const std::string& memory_file_path,
         THROW_OUT_OF_RANGE(err_msg);
     }
 
+    if (end_address < start_address) {
+        return;
+    }
+
+    // read the whole file but at most up to end_address
+    uint64_t num_bytes = std::min<uint64_t>(std::filesystem::file_size(p),
+                                            end_address - start_address + 1);
+
+    check_address_range("write", start_address, num_bytes);
+
     std::ifstream memory_file;
 
     memory_file.open(memory_file_path, std::ios::binary);
 
-    uint64_t memory_address = start_address;
+    std::vector<uint8_t> data(std::min<uint64_t>(FILE_CHUNK_SIZE, num_bytes));
 
-    if (memory_file.good()) {
-        char byte;
-        while (!memory_file.eof() && memory_address <= end_address) {
-            memory_file.get(byte);
-            Data data(1);
-            data.set<uint8_t>(byte);
-            write(memory_address, data);
-            memory_address++;
-        }
+    for (uint64_t offset = 0; offset < num_bytes; offset += data.size()) {
+        size_t chunk_size = std::min<uint64_t>(data.size(), num_bytes - offset);
+        memory_file.read(reinterpret_cast<char*>(data.data()), chunk_size);
+        write_backing_store(start_address + offset, data.data(), chunk_size);
     }
 
     memory_file.close();
@@ -266,24 +443,214 @@ void FakeMemory::write_bin_memory_file(const std::string& memory_file_path,
         end_address = size_ - 1;
     }
 
+    uint64_t num_bytes = end_address - start_address + 1;
+
+    check_address_range("read", start_address, num_bytes);
+
+    std::ofstream memory_file;
+
+    memory_file.open(memory_file_path, std::ios::binary);
+
+    std::vector<uint8_t> data(std::min<uint64_t>(FILE_CHUNK_SIZE, num_bytes));
+
+    for (uint64_t offset = 0; offset < num_bytes; offset += data.size()) {
+        size_t chunk_size = std::min<uint64_t>(data.size(), num_bytes - offset);
+        backing_store_->read(start_address + offset, data.data(), chunk_size);
+        memory_file.write(reinterpret_cast<const char*>(data.data()), chunk_size);
+    }
+
+    memory_file.close();
+}
+
+// header of incremental memory files, it is followed by the page numbers of the
+// stored pages in ascending order and then by the content of these pages
+struct IncrementalMemoryFileHeader {
+    char magic[8];
+    uint64_t memory_size;
+    uint64_t page_size;
+    uint64_t num_pages;
+};
+
+static constexpr char incremental_memory_file_magic[8] = {'K', 'S', 'I', 'M',
+                                                          'I', 'N', 'C', '1'};
+
+/**
+ * @brief read pages from an incremental memory file written by
+ * write_incremental_memory_file. Only the stored pages are overwritten, so a
+ * checkpoint can be restored by applying its incremental files in order.
+ * @param memory_file_path the path to the memory file
+ * @throws std::runtime_error if the file is not a valid incremental memory file or
+ * doesn't match the size or the page size of the memory
+ */
+void FakeMemory::read_incremental_memory_file(const std::string& memory_file_path) {
+    MappedFile memory_file(memory_file_path);
+
+    IncrementalMemoryFileHeader header;
+
+    if (memory_file.size() < sizeof(header)) {
+        std::string err_msg = std::string("file ") + memory_file_path +
+                              std::string(" is not an incremental memory file");
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    memcpy(&header, memory_file.data(), sizeof(header));
+
+    if (memcmp(header.magic, incremental_memory_file_magic, sizeof(header.magic)) !=
+        0) {
+        std::string err_msg = std::string("file ") + memory_file_path +
+                              std::string(" is not an incremental memory file");
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    if (header.memory_size != size_ || header.page_size != dirty_pages_.page_size()) {
+        std::string err_msg =
+            std::string("file ") + memory_file_path + std::string(" with size ") +
+            int_to_hex<uint64_t>(header.memory_size) + std::string(" and page size ") +
+            int_to_hex<uint64_t>(header.page_size) +
+            std::string(" doesn't match memory with size ") +
+            int_to_hex<uint64_t>(size_) + std::string(" and page size ") +
+            int_to_hex<uint64_t>(dirty_pages_.page_size());
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    uint64_t num_pages = (size_ + header.page_size - 1) / header.page_size;
+
+    // the index and all pages have to be contained in the file
+    uint64_t index_size = sizeof(uint64_t) * header.num_pages;
+    if (header.num_pages > num_pages ||
+        memory_file.size() - sizeof(header) < index_size) {
+        std::string err_msg = std::string("index of file ") + memory_file_path +
+                              std::string(" is truncated");
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    std::vector<uint64_t> page_numbers(header.num_pages);
+    memcpy(page_numbers.data(), memory_file.data() + sizeof(header), index_size);
+
+    uint64_t data_size = 0;
+    for (uint64_t i = 0; i < header.num_pages; i++) {
+        if (page_numbers[i] >= num_pages ||
+            (i > 0 && page_numbers[i] <= page_numbers[i - 1])) {
+            std::string err_msg = std::string("index of file ") + memory_file_path +
+                                  std::string(" is invalid");
+            THROW_RUNTIME_ERROR(err_msg);
+        }
+        address_t address = page_numbers[i] * header.page_size;
+        data_size += std::min<uint64_t>(header.page_size, size_ - address);
+    }
+
+    if (memory_file.size() - sizeof(header) - index_size < data_size) {
+        std::string err_msg =
+            std::string("file ") + memory_file_path + std::string(" is truncated");
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    const uint8_t* page_data = memory_file.data() + sizeof(header) + index_size;
+
+    for (uint64_t page_number : page_numbers) {
+        address_t address = page_number * header.page_size;
+        size_t num_bytes = std::min<uint64_t>(header.page_size, size_ - address);
+
+        write_backing_store(address, page_data, num_bytes);
+        page_data += num_bytes;
+    }
+}
+
+/**
+ * @brief write all dirty pages to an incremental memory file. The cost depends on the
+ * number of dirty pages and not on the size of the memory. The dirty pages aren't
+ * cleared, call clear_dirty_pages after the dump to only get the pages written in
+ * between for the next dump.
+ * @param memory_file_path to write to
+ */
+void FakeMemory::write_incremental_memory_file(const std::string& memory_file_path) {
+    std::vector<uint64_t> page_numbers = dirty_pages_.get_dirty_pages();
+
+    IncrementalMemoryFileHeader header;
+    memcpy(header.magic, incremental_memory_file_magic, sizeof(header.magic));
+    header.memory_size = size_;
+    header.page_size = dirty_pages_.page_size();
+    header.num_pages = page_numbers.size();
+
     std::ofstream memory_file;
 
     memory_file.open(memory_file_path, std::ios::binary);
 
-    for (uint64_t i = start_address; i <= end_address; i++) {
-        memory_file << data_[i];
+    memory_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    memory_file.write(reinterpret_cast<const char*>(page_numbers.data()),
+                      sizeof(uint64_t) * page_numbers.size());
+
+    // copy pages into a buffer to write them in large blocks
+    std::vector<uint8_t> data;
+    data.reserve(FILE_CHUNK_SIZE);
+
+    for (uint64_t page_number : page_numbers) {
+        address_t address = page_number * header.page_size;
+        size_t num_bytes = std::min<uint64_t>(header.page_size, size_ - address);
+
+        if (data.size() + num_bytes > FILE_CHUNK_SIZE) {
+            memory_file.write(reinterpret_cast<const char*>(data.data()), data.size());
+            data.clear();
+        }
+
+        size_t offset = data.size();
+        data.resize(offset + num_bytes);
+        backing_store_->read(address, data.data() + offset, num_bytes);
     }
 
+    memory_file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
     memory_file.close();
 }
 
+/**
+ * @brief load the PT_LOAD segments of an ELF32 or ELF64 file to their physical
+ * addresses. The file is mapped and each segment is copied in one piece, the BSS part
+ * of a segment is zero filled.
+ * @param elf_file_path the path to the ELF file
+ * @return the entry point, the loaded segments and the symbols of the file
+ * @throws std::runtime_error if the file is not a valid ELF file
+ * @throws std::out_of_range if a segment exceeds the memory
+ */
+ElfImage FakeMemory::load_elf(const std::string& elf_file_path) {
+    MappedFile elf_file(elf_file_path);
+
+    ElfImage image = parse_elf(elf_file.data(), elf_file.size());
+
+    // check all segments before memory is modified
+    for (const auto& segment : image.segments) {
+        check_address_range("load", segment.physical_address, segment.memory_size);
+    }
+
+    std::vector<uint8_t> zeros;
+
+    for (const auto& segment : image.segments) {
+        write_backing_store(segment.physical_address,
+                            elf_file.data() + segment.file_offset, segment.file_size);
+
+        // zero fill BSS
+        uint64_t bss_size = segment.memory_size - segment.file_size;
+        zeros.resize(std::min<uint64_t>(bss_size, FILE_CHUNK_SIZE));
+
+        for (uint64_t offset = 0; offset < bss_size; offset += zeros.size()) {
+            size_t num_bytes = std::min<uint64_t>(zeros.size(), bss_size - offset);
+            write_backing_store(segment.physical_address + segment.file_size + offset,
+                                zeros.data(), num_bytes);
+        }
+    }
+
+    return image;
+}
+
 /**
  * @brief set memory address to value. CAUTION: this method is intended for
  * debuggin purposes only and should not be used in a simulation
  * @param address the address to set
  * @param value the value to set
  */
-void FakeMemory::set(uint64_t address, uint8_t value) { data_[address] = value; }
+void FakeMemory::set(uint64_t address, uint8_t value) {
+    write_backing_store(address, &value, 1);
+}
 
 /**
  * @brief get memory address value. CAUTION: this method is intended for
@@ -291,10 +658,103 @@ void FakeMemory::set(uint64_t address, uint8_t value) { data_[address] = value;
  * @param address the address to get
  * @return the value at the address
  */
-uint8_t FakeMemory::get(uint64_t address) { return data_[address]; }
+uint8_t FakeMemory::get(uint64_t address) {
+    uint8_t value;
+    backing_store_->read(address, &value, 1);
+    return value;
+}
+
+std::shared_ptr<BackingStore> FakeMemory::get_backing_store() { return backing_store_; }
+
+/**
+ * @brief returns the size of the pages in which written bytes are tracked
+ * @return the size of a dirty page in bytes
+ */
+size_t FakeMemory::get_dirty_page_size() { return dirty_pages_.page_size(); }
+
+/**
+ * @brief returns the number of pages written since the last reset or
+ * clear_dirty_pages
+ * @return the number of dirty pages
+ */
+size_t FakeMemory::get_dirty_page_count() {
+    return dirty_pages_.get_dirty_page_count();
+}
+
+bool FakeMemory::is_page_dirty(address_t address) {
+    return dirty_pages_.is_dirty(address);
+}
+
+/**
+ * @brief marks all pages as clean without changing the content of the memory
+ */
+void FakeMemory::clear_dirty_pages() { dirty_pages_.clear(); }
 
 /**
- * @brief reset whole memory
+ * @brief creates an independent copy of the memory which shares the current content
+ * copy-on-write, see clone_backing_store
+ * @return the copy of the memory
  */
-void FakeMemory::reset() { data_ = std::vector<uint8_t>(size_); }
+std::shared_ptr<MemoryInterface> FakeMemory::clone() {
+    auto fake_memory = std::make_shared<FakeMemory>(name_, clone_backing_store(),
+                                                    read_latency_, write_latency_);
+    fake_memory->dirty_pages_ = dirty_pages_;
+    fake_memory->concurrent_ = concurrent_;
+
+    return fake_memory;
+}
+
+/**
+ * @brief creates a backing store for a copy of the memory. The current backing store
+ * is frozen as shared base and both memories get a private overlay on top of it, so
+ * afterwards reset restores the content at the time of the first clone. Cloning again
+ * before the memory is written reuses the base.
+ * @param page_size the size of the private pages of both overlays
+ * @return the backing store of the copy
+ */
+std::shared_ptr<BackingStore> FakeMemory::clone_backing_store(size_t page_size) {
+    std::shared_ptr<const BackingStore> base;
+
+    auto cow_backing_store = std::dynamic_pointer_cast<CowBackingStore>(backing_store_);
+
+    if (cow_backing_store != nullptr &&
+        cow_backing_store->get_allocated_page_count() == 0) {
+        base = cow_backing_store->get_base();
+    } else {
+        base = backing_store_;
+        backing_store_ = std::make_shared<CowBackingStore>(base, page_size);
+    }
+
+    return std::make_shared<CowBackingStore>(base, page_size);
+}
+
+/**
+ * @brief enables or disables concurrent reads and writes, which are serialized by a
+ * lock. Must not be called concurrently with accesses.
+ */
+void FakeMemory::set_concurrent(bool concurrent) { concurrent_ = concurrent; }
+
+std::unique_lock<std::mutex> FakeMemory::lock() {
+    if (!concurrent_) {
+        return std::unique_lock<std::mutex>();
+    }
+    return std::unique_lock<std::mutex>(mutex_);
+}
+
+/**
+ * @brief reset the backing store, this also marks all pages as clean
+ */
+void FakeMemory::reset() {
+    backing_store_->reset();
+    dirty_pages_.clear();
+}
+
+/**
+ * @brief writes to the backing store and marks the written pages as dirty
+ */
+void FakeMemory::write_backing_store(address_t address, const uint8_t* data,
+                                     size_t num_bytes) {
+    backing_store_->write(address, data, num_bytes);
+    dirty_pages_.mark(address, num_bytes);
+}
 }  // namespace kachesim
@@ -0,0 +1,441 @@
+#include "kachesim/fully_associative_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+FullyAssociativeCache::FullyAssociativeCache(
+    const std::string& name, std::shared_ptr<DataStorage> next_level_data_storage,
+    bool write_allocate, bool write_through, latency_t miss_latency,
+    latency_t hit_latency, size_t cache_block_size, size_t entries)
+    : name_(name),
+      next_level_data_storage_(next_level_data_storage),
+      write_allocate_(write_allocate),
+      write_through_(write_through),
+      miss_latency_(miss_latency),
+      hit_latency_(hit_latency),
+      cache_block_size_(cache_block_size),
+      entries_(entries) {
+    if (entries_ == 0 || entries_ >= no_entry_) {
+        THROW_INVALID_ARGUMENT("invalid number of entries of fully associative cache");
+    }
+
+    if (cache_block_size_ == 0 || (cache_block_size_ & (cache_block_size_ - 1)) != 0) {
+        THROW_INVALID_ARGUMENT("cache block size is not a power of two");
+    }
+
+    offset_bits_ = clog2(cache_block_size_);
+
+    data_ = std::vector<uint8_t>(entries_ * cache_block_size_, 0);
+    tags_ = std::vector<address_t>(entries_, 0);
+    dirty_ = std::vector<bool>(entries_, false);
+    previous_ = std::vector<uint32_t>(entries_, no_entry_);
+    next_ = std::vector<uint32_t>(entries_, no_entry_);
+    tag_index_.reserve(entries_);
+}
+
+/**
+ * @brief creates an independent copy of the cache with the same blocks and LRU order
+ * @param next_level_data_storage the data storage the copy forwards misses to
+ * @return the copy of the cache
+ */
+std::shared_ptr<CacheInterface> FullyAssociativeCache::clone(
+    std::shared_ptr<DataStorage> next_level_data_storage) {
+    auto cache = std::make_shared<FullyAssociativeCache>(
+        name_, next_level_data_storage, write_allocate_, write_through_, miss_latency_,
+        hit_latency_, cache_block_size_, entries_);
+
+    cache->data_ = data_;
+    cache->tags_ = tags_;
+    cache->dirty_ = dirty_;
+    cache->tag_index_ = tag_index_;
+    cache->dirty_blocks_ = dirty_blocks_;
+    cache->previous_ = previous_;
+    cache->next_ = next_;
+    cache->head_ = head_;
+    cache->tail_ = tail_;
+    cache->stats_ = stats_;
+
+    return cache;
+}
+
+std::string FullyAssociativeCache::get_name() { return name_; }
+
+/**
+ * @brief Returns the size of the cache in bytes
+ */
+size_t FullyAssociativeCache::size() { return entries_ * cache_block_size_; }
+
+size_t FullyAssociativeCache::get_address_space_size() {
+    return next_level_data_storage_->get_address_space_size();
+}
+
+latency_t FullyAssociativeCache::get_hit_latency() { return hit_latency_; }
+
+latency_t FullyAssociativeCache::get_miss_latency() { return miss_latency_; }
+
+void FullyAssociativeCache::set_hit_latency(latency_t hit_latency) {
+    hit_latency_ = hit_latency;
+}
+
+void FullyAssociativeCache::set_miss_latency(latency_t miss_latency) {
+    miss_latency_ = miss_latency;
+}
+
+size_t FullyAssociativeCache::get_entries() { return entries_; }
+
+/**
+ * @brief returns the number of entries which hold a block
+ */
+size_t FullyAssociativeCache::get_valid_entry_count() { return tag_index_.size(); }
+
+CacheStats FullyAssociativeCache::get_stats() { return stats_; }
+
+void FullyAssociativeCache::reset_stats() { stats_ = CacheStats(); }
+
+/**
+ * @brief enables or disables concurrent accesses, in concurrent mode every access
+ * locks the whole cache
+ */
+void FullyAssociativeCache::set_concurrent(bool concurrent) {
+    concurrent_ = concurrent;
+}
+
+std::unique_lock<std::mutex> FullyAssociativeCache::lock() {
+    if (!concurrent_) {
+        return std::unique_lock<std::mutex>();
+    }
+    return std::unique_lock<std::mutex>(mutex_);
+}
+
+/**
+ * @brief looks up the entry holding a block
+ * @param tag the block address shifted by the block offset
+ * @return the index of the entry or no_entry_ if the block isn't cached
+ */
+inline uint32_t FullyAssociativeCache::find_entry(address_t tag) {
+    auto it = tag_index_.find(tag);
+    return it == tag_index_.end() ? no_entry_ : it->second;
+}
+
+/**
+ * @brief removes an entry from the LRU order
+ */
+void FullyAssociativeCache::unlink_entry(uint32_t entry) {
+    uint32_t previous = previous_[entry];
+    uint32_t next = next_[entry];
+
+    if (previous != no_entry_) {
+        next_[previous] = next;
+    } else {
+        head_ = next;
+    }
+
+    if (next != no_entry_) {
+        previous_[next] = previous;
+    } else {
+        tail_ = previous;
+    }
+
+    previous_[entry] = no_entry_;
+    next_[entry] = no_entry_;
+}
+
+/**
+ * @brief makes an entry the most recently used one
+ */
+void FullyAssociativeCache::touch_entry(uint32_t entry) {
+    if (entry == head_) {
+        return;
+    }
+
+    // entries which aren't the head are linked if they have a previous entry
+    if (previous_[entry] != no_entry_) {
+        unlink_entry(entry);
+    }
+
+    next_[entry] = head_;
+    if (head_ != no_entry_) {
+        previous_[head_] = entry;
+    }
+    head_ = entry;
+
+    if (tail_ == no_entry_) {
+        tail_ = entry;
+    }
+}
+
+/**
+ * @brief takes a free entry for a block or replaces the least recently used one, a
+ * dirty block is written back to the next level data storage
+ * @param tag the tag of the new block
+ * @param latency the latency of the write back is added to it
+ * @return the index of the entry
+ */
+uint32_t FullyAssociativeCache::allocate_entry(address_t tag, latency_t& latency) {
+    uint32_t entry;
+
+    // entries are only freed all at once, so the valid entries are the first ones
+    if (tag_index_.size() < entries_) {
+        entry = tag_index_.size();
+    } else {
+        entry = tail_;
+        unlink_entry(entry);
+        tag_index_.erase(tags_[entry]);
+
+        if (dirty_[entry]) {
+            Data write_back_data =
+                Data(&data_[entry * cache_block_size_], cache_block_size_);
+            auto write_back_dst = next_level_data_storage_->write(
+                tags_[entry] << offset_bits_, write_back_data);
+            stats_.write_backs++;
+            latency += write_back_dst.latency;
+
+            dirty_[entry] = false;
+            dirty_blocks_--;
+        }
+    }
+
+    tags_[entry] = tag;
+    tag_index_.insert({tag, entry});
+    touch_entry(entry);
+
+    return entry;
+}
+
+DataStorageTransaction FullyAssociativeCache::aligned_read(address_t address,
+                                                           size_t num_bytes) {
+    address_t tag = address >> offset_bits_;
+    address_t offset = address & (cache_block_size_ - 1);
+
+    int32_t hit_level;
+    latency_t latency;
+
+    uint32_t entry = find_entry(tag);
+
+    if (entry != no_entry_) {
+        hit_level = 0;
+        latency = hit_latency_;
+        stats_.read_hits++;
+        touch_entry(entry);
+    } else {
+        latency = miss_latency_;
+        stats_.read_misses++;
+
+        auto next_level_dst =
+            next_level_data_storage_->read(address - offset, cache_block_size_);
+        hit_level = next_level_dst.hit_level + 1;
+        latency += next_level_dst.latency;
+
+        entry = allocate_entry(tag, latency);
+        std::memcpy(&data_[entry * cache_block_size_], next_level_dst.data.data(),
+                    cache_block_size_);
+    }
+
+    Data read_data = Data(&data_[entry * cache_block_size_ + offset], num_bytes);
+
+    DEBUG_PRINT("> %s r @ 0x%016llx : d=%s / e=%04d - %s\n", name_.c_str(),
+                static_cast<unsigned long long>(address), read_data.to_string().c_str(),
+                entry, hit_level == 0 ? "hit" : "miss");
+
+    DataStorageTransaction dst = {READ, address, latency, hit_level, read_data};
+    return dst;
+}
+
+DataStorageTransaction FullyAssociativeCache::aligned_write(address_t address,
+                                                            Data& data) {
+    address_t tag = address >> offset_bits_;
+    address_t offset = address & (cache_block_size_ - 1);
+
+    int32_t hit_level = -1;
+    latency_t latency;
+    bool written_back = false;
+
+    uint32_t entry = find_entry(tag);
+
+    if (entry != no_entry_) {
+        hit_level = 0;
+        latency = hit_latency_;
+        stats_.write_hits++;
+        touch_entry(entry);
+    } else {
+        latency = miss_latency_;
+        stats_.write_misses++;
+
+        if (write_allocate_) {
+            // a partial write needs the rest of the block from the next level data
+            // storage
+            if (data.size() != cache_block_size_) {
+                auto next_level_dst =
+                    next_level_data_storage_->read(address - offset, cache_block_size_);
+                hit_level = next_level_dst.hit_level + 1;
+                latency += next_level_dst.latency;
+
+                entry = allocate_entry(tag, latency);
+                std::memcpy(&data_[entry * cache_block_size_],
+                            next_level_dst.data.data(), cache_block_size_);
+            } else {
+                entry = allocate_entry(tag, latency);
+            }
+        } else {
+            auto next_level_dst = next_level_data_storage_->write(address, data);
+            hit_level = next_level_dst.hit_level + 1;
+            latency += next_level_dst.latency;
+            written_back = true;
+        }
+    }
+
+    if (entry != no_entry_) {
+        std::memcpy(&data_[entry * cache_block_size_ + offset], data.data(),
+                    data.size());
+
+        if (!dirty_[entry]) {
+            dirty_[entry] = true;
+            dirty_blocks_++;
+        }
+    }
+
+    if (write_through_ && !written_back) {
+        auto next_level_dst = next_level_data_storage_->write(address, data);
+        latency += next_level_dst.latency;
+    }
+
+    DEBUG_PRINT("> %s w @ 0x%016llx : d=%s / e=%04d - %s\n", name_.c_str(),
+                static_cast<unsigned long long>(address), data.to_string().c_str(),
+                entry, hit_level == 0 ? "hit" : "miss");
+
+    DataStorageTransaction dst = {WRITE, address, latency, hit_level, data};
+    return dst;
+}
+
+/**
+ * @brief write data to the cache, accesses may span multiple blocks
+ * @param address the address to write to
+ * @param data the data to write
+ */
+DataStorageTransaction FullyAssociativeCache::write(address_t address, Data& data) {
+    auto cache_lock = lock();
+
+    int32_t hit_level = -1;
+    latency_t latency = 0;
+
+    for (size_t bytes_written = 0; bytes_written < data.size();) {
+        address_t block_address = address + bytes_written;
+        size_t num_bytes =
+            std::min(cache_block_size_ - (block_address & (cache_block_size_ - 1)),
+                     data.size() - bytes_written);
+
+        Data block_data = Data(data.data() + bytes_written, num_bytes);
+        auto dst = aligned_write(block_address, block_data);
+
+        latency += dst.latency;
+        hit_level = std::max(hit_level, dst.hit_level);
+        bytes_written += num_bytes;
+    }
+
+    DataStorageTransaction dst = {WRITE, address, latency, hit_level, data};
+    return dst;
+}
+
+/**
+ * @brief read data from the cache, accesses may span multiple blocks
+ * @param address the address to read from
+ * @param num_bytes the number of bytes to read
+ */
+DataStorageTransaction FullyAssociativeCache::read(address_t address,
+                                                   size_t num_bytes) {
+    auto cache_lock = lock();
+
+    Data read_data = Data(num_bytes);
+    int32_t hit_level = -1;
+    latency_t latency = 0;
+
+    for (size_t bytes_read = 0; bytes_read < num_bytes;) {
+        address_t block_address = address + bytes_read;
+        size_t block_bytes =
+            std::min(cache_block_size_ - (block_address & (cache_block_size_ - 1)),
+                     num_bytes - bytes_read);
+
+        auto dst = aligned_read(block_address, block_bytes);
+        std::memcpy(read_data.data() + bytes_read, dst.data.data(), block_bytes);
+
+        latency += dst.latency;
+        hit_level = std::max(hit_level, dst.hit_level);
+        bytes_read += block_bytes;
+    }
+
+    DataStorageTransaction dst = {READ, address, latency, hit_level, read_data};
+    return dst;
+}
+
+bool FullyAssociativeCache::is_address_cached(address_t address) {
+    return find_entry(address >> offset_bits_) != no_entry_;
+}
+
+bool FullyAssociativeCache::is_address_dirty(address_t address) {
+    uint32_t entry = find_entry(address >> offset_bits_);
+    return entry != no_entry_ && dirty_[entry];
+}
+
+/**
+ * @brief returns the cached byte or 0. CAUTION: this method is intended for debugging
+ * and should not be used in a simulation
+ */
+uint8_t FullyAssociativeCache::get(address_t address) {
+    uint32_t entry = find_entry(address >> offset_bits_);
+    if (entry == no_entry_) {
+        return 0;
+    }
+    return data_[entry * cache_block_size_ + (address & (cache_block_size_ - 1))];
+}
+
+size_t FullyAssociativeCache::get_dirty_block_count() { return dirty_blocks_; }
+
+/**
+ * @brief flush the whole cache, dirty blocks are written back to the next level data
+ * storage
+ */
+DataStorageTransaction FullyAssociativeCache::flush() {
+    int32_t hit_level = 0;
+    latency_t latency = 0;
+
+    for (uint32_t entry = 0; entry < tag_index_.size() && dirty_blocks_ > 0; entry++) {
+        if (!dirty_[entry]) {
+            continue;
+        }
+
+        Data data = Data(&data_[entry * cache_block_size_], cache_block_size_);
+        auto next_level_dst =
+            next_level_data_storage_->write(tags_[entry] << offset_bits_, data);
+        stats_.write_backs++;
+
+        dirty_[entry] = false;
+        dirty_blocks_--;
+
+        hit_level = std::max(hit_level, next_level_dst.hit_level + 1);
+        latency += next_level_dst.latency;
+    }
+    reset();
+
+    Data data = Data(0);
+
+    DataStorageTransaction dst = {WRITE, 0, latency, hit_level, data};
+    return dst;
+}
+
+/**
+ * @brief invalidates all blocks without writing them back
+ */
+void FullyAssociativeCache::reset() {
+    tag_index_.clear();
+    std::fill(dirty_.begin(), dirty_.end(), false);
+    dirty_blocks_ = 0;
+
+    std::fill(previous_.begin(), previous_.end(), no_entry_);
+    std::fill(next_.begin(), next_.end(), no_entry_);
+    head_ = no_entry_;
+    tail_ = no_entry_;
+}
+}  // namespace kachesim
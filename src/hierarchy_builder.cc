@@ -0,0 +1,42 @@
+#include "kachesim/hierarchy_builder.h"
+
+namespace kachesim {
+HierarchyBuilder::HierarchyBuilder() = default;
+
+HierarchyBuilder::HierarchyBuilder(const HierarchyConfig& config) : config_(config) {}
+
+HierarchyBuilder& HierarchyBuilder::memory(const MemoryConfig& memory_config) {
+    config_.memories.push_back(memory_config);
+    return *this;
+}
+
+HierarchyBuilder& HierarchyBuilder::cache(const CacheConfig& cache_config) {
+    config_.caches.push_back(cache_config);
+    return *this;
+}
+
+HierarchyBuilder& HierarchyBuilder::coherence(const CoherenceConfig& coherence_config) {
+    config_.coherence = coherence_config;
+    return *this;
+}
+
+/**
+ * @brief shares base_image copy-on-write as content of the memory, see
+ * MemoryHierarchy
+ */
+HierarchyBuilder& HierarchyBuilder::base_image(
+    std::shared_ptr<const BackingStore> base_image) {
+    base_image_ = base_image;
+    return *this;
+}
+
+const HierarchyConfig& HierarchyBuilder::get_config() const { return config_; }
+
+/**
+ * @brief validates the config and instantiates the memory hierarchy
+ * @throws std::invalid_argument if the config is invalid
+ */
+std::unique_ptr<MemoryHierarchy> HierarchyBuilder::build() const {
+    return std::make_unique<MemoryHierarchy>(config_, base_image_);
+}
+}  // namespace kachesim
@@ -0,0 +1,670 @@
+#include "kachesim/hierarchy_config.h"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+static bool is_power_of_two(uint64_t x) { return x != 0 && (x & (x - 1)) == 0; }
+
+/**
+ * @throws std::invalid_argument if a parameter is invalid
+ */
+void MemoryConfig::validate() const {
+    if (name.empty()) {
+        THROW_INVALID_ARGUMENT("memory without a name");
+    }
+
+    if (size == 0 && (type == SPARSE_MEMORY || image.empty())) {
+        std::string msg = "size of memory '" + name + "' is 0";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (type == SPARSE_MEMORY) {
+        if (!image.empty()) {
+            std::string msg =
+                "memory '" + name + "' of type SparseMemory can't have an image";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+        if (!is_power_of_two(page_size)) {
+            std::string msg =
+                "page_size of memory '" + name + "' is not a power of two";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+    }
+
+    if (type == DRAM_MEMORY) {
+        if (channels == 0 || ranks == 0 || banks == 0) {
+            std::string msg = "channels, ranks or banks of memory '" + name + "' is 0";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+        if (burst_size == 0 || row_size == 0 || row_size % burst_size != 0) {
+            std::string msg = "row_size of memory '" + name +
+                              "' is not a multiple of burst_size";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+    }
+}
+
+/**
+ * @throws std::invalid_argument if a parameter is invalid
+ */
+void CacheConfig::validate() const {
+    if (name.empty()) {
+        THROW_INVALID_ARGUMENT("cache without a name");
+    }
+
+    if (next_level_data_storage.empty()) {
+        std::string msg = "cache '" + name + "' has no next_level_data_storage";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (!is_power_of_two(cache_block_size)) {
+        std::string msg =
+            "cache_block_size of cache '" + name + "' is not a power of two";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (sets == 0) {
+        std::string msg = "sets of cache '" + name + "' is 0";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (ways == 0) {
+        std::string msg = "ways of cache '" + name + "' is 0";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (multi_block_access == 0) {
+        std::string msg = "multi_block_access of cache '" + name + "' is 0";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (type == FULLY_ASSOCIATIVE_CACHE && sets != 1) {
+        std::string msg = "fully associative cache '" + name + "' has more than 1 set";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (type != SET_ASSOCIATIVE_CACHE &&
+        (mshrs != 0 || index_function != MODULO_INDEX || sectors != 1 ||
+         write_no_fetch || prefetcher != NO_PREFETCHER || victim_cache_size != 0 ||
+         write_buffer_entries != 0 || banks != 0)) {
+        std::string msg = "cache '" + name +
+                          "' can't have MSHRs, an index function, sectors, write no "
+                          "fetch, a prefetcher, a victim cache, a write buffer or "
+                          "banks, it isn't set associative";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (!is_power_of_two(sectors) || sectors > 64 || sectors > cache_block_size) {
+        std::string msg = "sectors of cache '" + name +
+                          "' is not a power of two between 1 and 64 which divides "
+                          "cache_block_size";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (sectors != 1 && victim_cache_size != 0) {
+        std::string msg = "sectored cache '" + name + "' can't have a victim cache";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (write_no_fetch && (sectors != 1 || victim_cache_size != 0)) {
+        std::string msg = "cache '" + name +
+                          "' without fetch on write can't be sectored or have a "
+                          "victim cache";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (prefetcher != NO_PREFETCHER && prefetch_degree == 0) {
+        std::string msg = "prefetch degree of cache '" + name + "' is 0";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (victim_cache_size % cache_block_size != 0) {
+        std::string msg = "victim cache size of cache '" + name +
+                          "' is not a multiple of cache_block_size";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (write_buffer_granularity != 0 && !is_power_of_two(write_buffer_granularity)) {
+        std::string msg = "write buffer granularity of cache '" + name +
+                          "' is not a power of two";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (bank_width != 0 && !is_power_of_two(bank_width)) {
+        std::string msg = "bank width of cache '" + name + "' is not a power of two";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+}
+
+/**
+ * @brief validates all memories and caches, checks that names are unique and that the
+ * next level data storage of each cache exists
+ * @throws std::invalid_argument if the hierarchy is invalid or contains a cycle
+ */
+void HierarchyConfig::validate() const {
+    if (memories.empty()) {
+        THROW_INVALID_ARGUMENT("memory hierarchy without a memory");
+    }
+
+    std::set<std::string> names;
+
+    auto add_name = [&names](const std::string& name) {
+        if (!names.insert(name).second) {
+            std::string msg = "data_storage name '" + name + "' is not unique";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+    };
+
+    for (const auto& memory : memories) {
+        memory.validate();
+        add_name(memory.name);
+    }
+
+    for (const auto& cache : caches) {
+        cache.validate();
+        add_name(cache.name);
+    }
+
+    for (const auto& cache : caches) {
+        if (names.count(cache.next_level_data_storage) == 0) {
+            std::string msg = "No data_storage with name " +
+                              cache.next_level_data_storage + " for cache '" +
+                              cache.name + "'";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+    }
+
+    get_topological_order();
+
+    if (coherence.enabled) {
+        validate_coherence();
+    }
+}
+
+/**
+ * @brief checks that all first level caches can be kept coherent
+ * @throws std::invalid_argument if they don't share a next level data storage and
+ * cache block size or if there are too many of them
+ */
+void HierarchyConfig::validate_coherence() const {
+    std::set<std::string> next_level_data_storages;
+    for (const auto& cache : caches) {
+        next_level_data_storages.insert(cache.next_level_data_storage);
+    }
+
+    const CacheConfig* first = nullptr;
+    size_t first_level_caches = 0;
+
+    for (const auto& cache : caches) {
+        if (next_level_data_storages.count(cache.name) != 0) {
+            continue;
+        }
+        first_level_caches++;
+
+        if (cache.type != SET_ASSOCIATIVE_CACHE) {
+            std::string msg = "cache '" + cache.name +
+                              "' can't be kept coherent, it isn't set associative";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+
+        if (cache.victim_cache_size != 0) {
+            std::string msg =
+                "cache '" + cache.name + "' with a victim cache can't be kept coherent";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+
+        if (cache.sectors != 1) {
+            std::string msg =
+                "sectored cache '" + cache.name + "' can't be kept coherent";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+
+        if (cache.write_no_fetch) {
+            std::string msg = "cache '" + cache.name +
+                              "' without fetch on write can't be kept coherent";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+
+        if (cache.write_buffer_entries != 0) {
+            std::string msg =
+                "cache '" + cache.name + "' with a write buffer can't be kept coherent";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+
+        if (first == nullptr) {
+            first = &cache;
+            continue;
+        }
+
+        if (cache.next_level_data_storage != first->next_level_data_storage ||
+            cache.cache_block_size != first->cache_block_size) {
+            std::string msg = "coherent caches '" + first->name + "' and '" +
+                              cache.name +
+                              "' don't share next_level_data_storage and "
+                              "cache_block_size";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+    }
+
+    if (first_level_caches > 64) {
+        THROW_INVALID_ARGUMENT("at most 64 first level caches can be kept coherent");
+    }
+}
+
+/**
+ * @brief orders the data storages such that every data storage comes after its next
+ * level data storage (Kahn's algorithm). Memories come first and data storages which
+ * are ready at the same time keep the order of the config.
+ * @return the names of the data storages, the first level caches are last
+ * @throws std::invalid_argument if the caches contain a cycle
+ */
+std::vector<std::string> HierarchyConfig::get_topological_order() const {
+    std::vector<std::string> order;
+    order.reserve(memories.size() + caches.size());
+
+    // caches which have the data storage as next level data storage
+    std::map<std::string, std::vector<size_t>> previous_levels;
+    for (size_t i = 0; i < caches.size(); i++) {
+        previous_levels[caches[i].next_level_data_storage].push_back(i);
+    }
+
+    for (const auto& memory : memories) {
+        order.push_back(memory.name);
+    }
+
+    // every cache has exactly one next level, so it's ready as soon as its next level
+    // has been ordered
+    for (size_t i = 0; i < order.size(); i++) {
+        auto it = previous_levels.find(order[i]);
+        if (it == previous_levels.end()) {
+            continue;
+        }
+        for (size_t cache_index : it->second) {
+            order.push_back(caches[cache_index].name);
+        }
+    }
+
+    if (order.size() == memories.size() + caches.size()) {
+        return order;
+    }
+
+    // all caches which weren't ordered lead into a cycle, follow one of them until a
+    // cache repeats to report the cycle
+    std::set<std::string> ordered(order.begin(), order.end());
+    std::map<std::string, std::string> next_levels;
+    std::string start;
+
+    for (const auto& cache : caches) {
+        next_levels[cache.name] = cache.next_level_data_storage;
+        if (start.empty() && ordered.count(cache.name) == 0) {
+            start = cache.name;
+        }
+    }
+
+    std::vector<std::string> path;
+    std::string current = start;
+
+    while (std::find(path.begin(), path.end(), current) == path.end()) {
+        path.push_back(current);
+        current = next_levels[current];
+    }
+
+    std::string cycle;
+    for (auto it = std::find(path.begin(), path.end(), current); it != path.end();
+         ++it) {
+        cycle += *it + " -> ";
+    }
+    cycle += current;
+
+    std::string msg = "cycle in memory hierarchy: " + cycle;
+    THROW_INVALID_ARGUMENT(msg);
+}
+
+static MemoryConfig memory_config_from_yaml_node(const YAML::Node& yaml_node,
+                                                 MemoryType type) {
+    MemoryConfig config;
+
+    config.name = yaml_node["name"].as<std::string>();
+    config.type = type;
+    config.read_latency = yaml_node["read_latency"].as<latency_t>();
+    config.write_latency = yaml_node["write_latency"].as<latency_t>();
+
+    // size is optional if an image is given
+    if (yaml_node["size"] || !yaml_node["image"]) {
+        config.size = yaml_node["size"].as<uint64_t>();
+    }
+
+    if (yaml_node["image"]) {
+        config.image = yaml_node["image"].as<std::string>();
+    }
+
+    if (yaml_node["page_size"]) {
+        config.page_size = yaml_node["page_size"].as<size_t>();
+    }
+
+    if (type != DRAM_MEMORY) {
+        return config;
+    }
+
+    if (yaml_node["channels"]) {
+        config.channels = yaml_node["channels"].as<size_t>();
+    }
+
+    if (yaml_node["ranks"]) {
+        config.ranks = yaml_node["ranks"].as<size_t>();
+    }
+
+    if (yaml_node["banks"]) {
+        config.banks = yaml_node["banks"].as<size_t>();
+    }
+
+    if (yaml_node["row_size"]) {
+        config.row_size = yaml_node["row_size"].as<size_t>();
+    }
+
+    if (yaml_node["burst_size"]) {
+        config.burst_size = yaml_node["burst_size"].as<size_t>();
+    }
+
+    if (yaml_node["row_policy"]) {
+        std::string row_policy_str = yaml_node["row_policy"].as<std::string>();
+
+        if (row_policy_str.compare("open") == 0) {
+            config.row_policy = OPEN_ROW_POLICY;
+        } else if (row_policy_str.compare("closed") == 0) {
+            config.row_policy = CLOSED_ROW_POLICY;
+        } else {
+            std::string msg = "row_policy '" + row_policy_str + "' for '" +
+                              config.name + "' unknown in yaml config";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+    }
+
+    if (yaml_node["timings"]) {
+        auto timings_node = yaml_node["timings"];
+        config.dram_timings.t_rcd = timings_node["t_rcd"].as<latency_t>();
+        config.dram_timings.t_cas = timings_node["t_cas"].as<latency_t>();
+        config.dram_timings.t_rp = timings_node["t_rp"].as<latency_t>();
+        config.dram_timings.t_ras = timings_node["t_ras"].as<latency_t>();
+
+        if (timings_node["t_burst"]) {
+            config.dram_timings.t_burst = timings_node["t_burst"].as<latency_t>();
+        }
+    }
+
+    return config;
+}
+
+static IndexFunctionType index_function_from_yaml_node(const YAML::Node& yaml_node,
+                                                       const std::string& name) {
+    std::string index_function_str = yaml_node.as<std::string>();
+
+    if (index_function_str.compare("modulo") == 0) {
+        return MODULO_INDEX;
+    } else if (index_function_str.compare("xor") == 0) {
+        return XOR_INDEX;
+    } else if (index_function_str.compare("prime_modulo") == 0) {
+        return PRIME_MODULO_INDEX;
+    } else if (index_function_str.compare("skewed") == 0) {
+        return SKEWED_INDEX;
+    }
+
+    std::string msg = "index function '" + index_function_str + "' for '" + name +
+                      "' unknown in yaml config";
+    THROW_INVALID_ARGUMENT(msg);
+}
+
+static CacheConfig cache_config_from_yaml_node(const YAML::Node& yaml_node,
+                                               CacheType type) {
+    CacheConfig config;
+
+    config.name = yaml_node["name"].as<std::string>();
+    config.type = type;
+
+    if (yaml_node["next_level_data_storage"]) {
+        config.next_level_data_storage =
+            yaml_node["next_level_data_storage"].as<std::string>();
+    } else {
+        throw std::runtime_error(
+            "data_storage '" + config.name +
+            "' does not contain 'next_level_data_storage' in yaml config");
+    }
+
+    config.write_allocate = yaml_node["write_allocate"].as<bool>();
+    config.write_through = yaml_node["write_through"].as<bool>();
+    config.miss_latency = yaml_node["miss_latency"].as<latency_t>();
+    config.hit_latency = yaml_node["hit_latency"].as<latency_t>();
+    config.cache_block_size = yaml_node["cache_block_size"].as<size_t>();
+
+    // a fully associative cache only has a number of entries
+    if (type == FULLY_ASSOCIATIVE_CACHE) {
+        config.ways = yaml_node["entries"].as<size_t>();
+        return config;
+    }
+
+    config.sets = yaml_node["sets"].as<size_t>();
+    config.ways = yaml_node["ways"].as<size_t>();
+
+    std::string replacement_policy_str =
+        yaml_node["replacement_policy"].as<std::string>();
+
+    // a skewed associative cache approximates the replacement policy
+    if (type == SKEWED_ASSOCIATIVE_CACHE) {
+        if (replacement_policy_str.compare("LRU") == 0) {
+            config.skewed_replacement_policy = SKEWED_LRU;
+        } else if (replacement_policy_str.compare("NRU") == 0) {
+            config.skewed_replacement_policy = SKEWED_NRU;
+        } else {
+            std::string msg = "replacement_policy '" + replacement_policy_str +
+                              "' for '" + config.name + "' unknown in yaml config";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+        return config;
+    }
+
+    if (replacement_policy_str.compare("LRU") == 0) {
+        config.replacement_policy = ReplacementPolicyType::LRU;
+    } else {
+        std::string msg = "replacement_policy '" + replacement_policy_str + "' for '" +
+                          config.name + "' unknown in yaml config";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    config.multi_block_access = yaml_node["multi_block_access"].as<size_t>();
+
+    if (yaml_node["mshrs"]) {
+        config.mshrs = yaml_node["mshrs"].as<size_t>();
+    }
+
+    if (yaml_node["index_function"]) {
+        config.index_function =
+            index_function_from_yaml_node(yaml_node["index_function"], config.name);
+    }
+
+    if (yaml_node["sectors"]) {
+        config.sectors = yaml_node["sectors"].as<size_t>();
+    }
+
+    if (yaml_node["write_no_fetch"]) {
+        config.write_no_fetch = yaml_node["write_no_fetch"].as<bool>();
+    }
+
+    if (yaml_node["prefetcher"]) {
+        auto prefetcher_node = yaml_node["prefetcher"];
+        std::string prefetcher_str = prefetcher_node["type"].as<std::string>();
+
+        if (prefetcher_str.compare("next_line") == 0) {
+            config.prefetcher = NEXT_LINE_PREFETCHER;
+        } else if (prefetcher_str.compare("stride") == 0) {
+            config.prefetcher = STRIDE_PREFETCHER;
+        } else if (prefetcher_str.compare("stream") == 0) {
+            config.prefetcher = STREAM_PREFETCHER;
+        } else {
+            std::string msg = "prefetcher '" + prefetcher_str + "' for '" +
+                              config.name + "' unknown in yaml config";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+
+        if (prefetcher_node["degree"]) {
+            config.prefetch_degree = prefetcher_node["degree"].as<size_t>();
+        }
+    }
+
+    if (yaml_node["victim_cache"]) {
+        auto victim_cache_node = yaml_node["victim_cache"];
+        config.victim_cache_size = victim_cache_node["size"].as<size_t>();
+
+        if (victim_cache_node["latency"]) {
+            config.victim_cache_latency =
+                victim_cache_node["latency"].as<latency_t>();
+        }
+    }
+
+    if (yaml_node["write_buffer"]) {
+        auto write_buffer_node = yaml_node["write_buffer"];
+        config.write_buffer_entries = write_buffer_node["entries"].as<size_t>();
+
+        if (write_buffer_node["granularity"]) {
+            config.write_buffer_granularity =
+                write_buffer_node["granularity"].as<size_t>();
+        }
+
+        if (write_buffer_node["drain"]) {
+            std::string drain_str = write_buffer_node["drain"].as<std::string>();
+
+            if (drain_str.compare("eager") == 0) {
+                config.write_buffer_drain_policy = DRAIN_EAGER;
+            } else if (drain_str.compare("when_full") == 0) {
+                config.write_buffer_drain_policy = DRAIN_WHEN_FULL;
+            } else {
+                std::string msg = "write buffer drain '" + drain_str + "' for '" +
+                                  config.name + "' unknown in yaml config";
+                THROW_INVALID_ARGUMENT(msg);
+            }
+        }
+    }
+
+    if (yaml_node["banks"]) {
+        auto banks_node = yaml_node["banks"];
+        config.banks = banks_node["count"].as<size_t>();
+
+        if (banks_node["width"]) {
+            config.bank_width = banks_node["width"].as<size_t>();
+        }
+
+        if (banks_node["busy_cycles"]) {
+            config.bank_busy_cycles = banks_node["busy_cycles"].as<latency_t>();
+        }
+
+        if (banks_node["function"]) {
+            config.bank_function =
+                index_function_from_yaml_node(banks_node["function"], config.name);
+        }
+    }
+
+    return config;
+}
+
+static CoherenceConfig coherence_config_from_yaml_node(const YAML::Node& yaml_node) {
+    CoherenceConfig config;
+    config.enabled = true;
+
+    std::string protocol_str = yaml_node["protocol"].as<std::string>();
+
+    if (protocol_str.compare("MESI") == 0) {
+        config.protocol = MESI;
+    } else if (protocol_str.compare("MOESI") == 0) {
+        config.protocol = MOESI;
+    } else {
+        std::string msg =
+            "coherence protocol '" + protocol_str + "' unknown in yaml config";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+
+    if (yaml_node["lookup_latency"]) {
+        config.lookup_latency = yaml_node["lookup_latency"].as<latency_t>();
+    }
+
+    if (yaml_node["snoop_latency"]) {
+        config.snoop_latency = yaml_node["snoop_latency"].as<latency_t>();
+    }
+
+    return config;
+}
+
+/**
+ * @brief lowers a yaml config into a hierarchy config, the result isn't validated
+ * @param yaml_config_string the yaml config with a sequence of 'data_storages' and an
+ * optional 'coherence' section
+ * @return the hierarchy config
+ * @throws std::runtime_error if the yaml config is malformed
+ */
+HierarchyConfig HierarchyConfig::from_yaml(const std::string& yaml_config_string) {
+    YAML::Node yaml_config = YAML::Load(yaml_config_string);
+
+    if (!yaml_config["data_storages"]) {
+        throw std::runtime_error("No 'nodes' in yaml config");
+    }
+
+    auto data_storages = yaml_config["data_storages"];
+
+    // check if nodes is a sequence
+    if (!data_storages.IsSequence()) {
+        throw std::runtime_error("'data_storages' in yaml config is not a sequence");
+    }
+
+    HierarchyConfig config;
+
+    for (const auto& data_storage : data_storages) {
+        if (!data_storage["name"]) {
+            throw std::runtime_error(
+                "No data_storage does not contain 'name' in yaml config");
+        }
+
+        if (!data_storage["type"]) {
+            throw std::runtime_error(
+                "No data_storage does not contain 'type' in yaml config");
+        }
+
+        std::string type = data_storage["type"].as<std::string>();
+
+        if (type.compare("FakeMemory") == 0) {
+            config.memories.push_back(
+                memory_config_from_yaml_node(data_storage, FAKE_MEMORY));
+        } else if (type.compare("SparseMemory") == 0) {
+            config.memories.push_back(
+                memory_config_from_yaml_node(data_storage, SPARSE_MEMORY));
+        } else if (type.compare("DramMemory") == 0) {
+            config.memories.push_back(
+                memory_config_from_yaml_node(data_storage, DRAM_MEMORY));
+        } else if (type.compare("SetAssociativeCache") == 0) {
+            config.caches.push_back(
+                cache_config_from_yaml_node(data_storage, SET_ASSOCIATIVE_CACHE));
+        } else if (type.compare("FullyAssociativeCache") == 0) {
+            config.caches.push_back(
+                cache_config_from_yaml_node(data_storage, FULLY_ASSOCIATIVE_CACHE));
+        } else if (type.compare("SkewedAssociativeCache") == 0) {
+            config.caches.push_back(
+                cache_config_from_yaml_node(data_storage, SKEWED_ASSOCIATIVE_CACHE));
+        } else {
+            std::string msg = "type '" + type + "' of data_storage '" +
+                              data_storage["name"].as<std::string>() +
+                              "' unknown in yaml config";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+    }
+
+    if (yaml_config["coherence"]) {
+        config.coherence = coherence_config_from_yaml_node(yaml_config["coherence"]);
+    }
+
+    return config;
+}
+}  // namespace kachesim
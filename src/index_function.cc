@@ -0,0 +1,67 @@
+#include "kachesim/index_function.h"
+
+#include <algorithm>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+static bool is_prime(size_t x) {
+    if (x < 2) {
+        return false;
+    }
+
+    for (size_t i = 2; i * i <= x; i++) {
+        if (x % i == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @param type the index function
+ * @param sets the number of sets of the cache
+ * @param skew selects the hash of SKEWED_INDEX, e.g. the way of a skewed associative
+ * cache
+ */
+IndexFunction::IndexFunction(IndexFunctionType type, size_t sets, size_t skew)
+    : type_(type), sets_(sets), skew_(skew) {
+    if (sets_ == 0) {
+        THROW_INVALID_ARGUMENT("index function without sets");
+    }
+
+    divisor_ = sets_;
+    if (type_ == PRIME_MODULO_INDEX) {
+        while (divisor_ > 1 && !is_prime(divisor_)) {
+            divisor_--;
+        }
+    }
+
+    if (divisor_ == 1) {
+        reciprocal_ = 0;
+        identity_mask_ = ~static_cast<address_t>(0);
+    } else {
+        reciprocal_ = ~static_cast<unsigned __int128>(0) / divisor_ + 1;
+        identity_mask_ = 0;
+    }
+
+    // 2 * fold_shift_ must stay below the width of an address
+    fold_shift_ = std::min<uint32_t>(clog2(divisor_), 31);
+    xor_mask_ = type_ == XOR_INDEX ? ~static_cast<address_t>(0) : 0;
+
+    // odd multiples of the golden ratio
+    skew_multiplier_ = 0x9e37'79b9'7f4a'7c15ull * (2 * skew_ + 1);
+    skew_mask_ = type_ == SKEWED_INDEX ? ~static_cast<address_t>(0) : 0;
+}
+
+IndexFunctionType IndexFunction::get_type() const { return type_; }
+
+size_t IndexFunction::get_sets() const { return sets_; }
+
+/**
+ * @brief returns the number of sets the index function maps to, the index is always
+ * smaller
+ */
+size_t IndexFunction::get_indexable_sets() const { return divisor_; }
+}  // namespace kachesim
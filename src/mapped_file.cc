@@ -0,0 +1,58 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+/**
+ * @param path the path of the file to map
+ * @throws std::runtime_error if the file can't be opened or mapped
+ */
+MappedFile::MappedFile(const std::string& path) : path_(path) {
+    int fd = open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::string err_msg =
+            std::string("file ") + path_ + " can't be opened: " + strerror(errno);
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        std::string err_msg =
+            std::string("file ") + path_ + " can't be accessed: " + strerror(errno);
+        THROW_RUNTIME_ERROR(err_msg);
+    }
+
+    size_ = file_stat.st_size;
+
+    // empty files can't be mapped
+    if (size_ > 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            std::string err_msg =
+                std::string("file ") + path_ + " can't be mapped: " + strerror(errno);
+            THROW_RUNTIME_ERROR(err_msg);
+        }
+        data_ = static_cast<const uint8_t*>(data);
+    }
+
+    // the mapping stays valid after the file descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+}  // namespace kachesim
@@ -2,231 +2,377 @@
 
 #include <algorithm>
 #include <iostream>
+#include <set>
 
+#include "kachesim/backing_store/cow_backing_store.h"
+#include "kachesim/backing_store/dense_backing_store.h"
+#include "kachesim/backing_store/mapped_backing_store.h"
 #include "kachesim/common.h"
 
 namespace kachesim {
 
 MemoryHierarchy::MemoryHierarchy() = default;
 
-MemoryHierarchy::MemoryHierarchy(const std::string& yaml_config_string) {
-    YAML::Node config = YAML::Load(yaml_config_string);
+MemoryHierarchy::MemoryHierarchy(const std::string& yaml_config_string)
+    : MemoryHierarchy(yaml_config_string, nullptr) {}
+
+/**
+ * @brief creates a memory hierarchy whose memory is a private copy-on-write overlay of
+ * base_image. Multiple hierarchies can share the same base image, each of them only
+ * stores the pages it writes. The memory in the yaml config must be of type FakeMemory
+ * or DramMemory and must not have an image.
+ * @param yaml_config_string the yaml config of the hierarchy
+ * @param base_image the shared image, nullptr if the memory shouldn't be shared
+ */
+MemoryHierarchy::MemoryHierarchy(const std::string& yaml_config_string,
+                                 std::shared_ptr<const BackingStore> base_image)
+    : MemoryHierarchy(HierarchyConfig::from_yaml(yaml_config_string), base_image) {}
+
+/**
+ * @brief creates a memory hierarchy from a typed config, see HierarchyBuilder
+ * @param config the config of the hierarchy
+ * @param base_image the shared image, nullptr if the memory shouldn't be shared
+ * @throws std::invalid_argument if the config is invalid
+ */
+MemoryHierarchy::MemoryHierarchy(const HierarchyConfig& config,
+                                 std::shared_ptr<const BackingStore> base_image)
+    : config_(config), base_image_(base_image) {
+    config_.validate();
+
+    // data storages are instantiated after their next level data storage
+    std::vector<std::string> data_storage_order = config_.get_topological_order();
+
+    for (const auto& memory_config : config_.memories) {
+        data_storage_map_.insert(
+            {memory_config.name, memory_from_config_(memory_config)});
+
+        if (memory_config.type == SPARSE_MEMORY) {
+            data_storage_type_map_.insert({memory_config.name, "SparseMemory"});
+        } else if (memory_config.type == DRAM_MEMORY) {
+            data_storage_type_map_.insert({memory_config.name, "DramMemory"});
+        } else {
+            data_storage_type_map_.insert({memory_config.name, "FakeMemory"});
+        }
+    }
 
-    // access data_storages
-    if (config["data_storages"]) {
-        auto data_storages = config["data_storages"];
+    std::map<std::string, const CacheConfig*> cache_configs;
+    for (const auto& cache_config : config_.caches) {
+        cache_configs.insert({cache_config.name, &cache_config});
+    }
 
-        // check if nodes is a sequence
-        if (!data_storages.IsSequence()) {
-            throw std::runtime_error(
-                "'data_storages' in yaml config is not a sequence");
+    for (const auto& data_storage_name : data_storage_order) {
+        auto it = cache_configs.find(data_storage_name);
+        if (it == cache_configs.end()) {
+            continue;
         }
 
-        // iterate over data_storages to collect names, types and dependencies
-        for (const auto& data_storage : data_storages) {
-            std::string data_storage_name_str;
-            std::string data_storage_type_str;
-            // access node name
-            if (data_storage["name"]) {
-                auto data_storage_name = Clone(data_storage["name"]);
-                data_storage_name_str = data_storage_name.as<std::string>();
-                data_storage_names_.push_back(data_storage_name_str);
-            } else {
-                throw std::runtime_error(
-                    "No data_storage does not contain 'name' in yaml config");
-            }
+        const CacheConfig& cache_config = *it->second;
+
+        data_storage_dependency_map_.insert(
+            {cache_config.name, cache_config.next_level_data_storage});
+        if (cache_config.type == FULLY_ASSOCIATIVE_CACHE) {
+            data_storage_type_map_.insert({cache_config.name, "FullyAssociativeCache"});
+        } else if (cache_config.type == SKEWED_ASSOCIATIVE_CACHE) {
+            data_storage_type_map_.insert(
+                {cache_config.name, "SkewedAssociativeCache"});
+        } else {
+            data_storage_type_map_.insert({cache_config.name, "SetAssociativeCache"});
+        }
 
-            // access data storage type
-            if (data_storage["type"]) {
-                auto data_storage_type = data_storage["type"];
-                data_storage_type_str = data_storage_type.as<std::string>();
-                data_storage_type_map_.insert(
-                    {data_storage_name_str, data_storage_type_str});
-            } else {
-                throw std::runtime_error(
-                    "No data_storage does not contain 'type' in yaml config");
-            }
+        auto next_level_data_storage =
+            data_storage_map_[cache_config.next_level_data_storage];
+        data_storage_map_.insert(
+            {cache_config.name,
+             cache_from_config_(cache_config, next_level_data_storage)});
+    }
 
-            if (data_storage_type_str.compare("SetAssociativeCache") == 0) {
-                if (data_storage["next_level_data_storage"]) {
-                    data_storage_dependency_map_.insert(
-                        {data_storage_name_str,
-                         data_storage["next_level_data_storage"].as<std::string>()});
-
-                } else {
-                    throw std::runtime_error(
-                        "No data_storage of type SetAssociativeCache does not contain "
-                        "'next_level_data_storage' in yaml config");
-                }
-            }
-        }
+    top_level_memory = std::dynamic_pointer_cast<MemoryInterface>(
+        data_storage_map_[data_storage_order[0]]);
+    // set data_storage_names_ to data_storage_order in reverse
+    data_storage_names_.clear();
+    for (auto it = data_storage_order.rbegin(); it != data_storage_order.rend(); ++it) {
+        data_storage_names_.push_back(*it);
+    }
 
-        // check data_storage_dependency_map_
-        for (const auto& [data_storages_name, next_level_data_storage_name] :
-             data_storage_dependency_map_) {
-            auto it = std::find(data_storage_names_.begin(), data_storage_names_.end(),
-                                next_level_data_storage_name);
-            if (it == data_storage_names_.end()) {
-                throw std::runtime_error("No data_storage with name " +
-                                         next_level_data_storage_name +
-                                         " in yaml config");
-            }
-        }
+    init_ports_();
+
+    if (config_.coherence.enabled) {
+        init_coherence_(std::make_shared<CoherenceDirectory>(
+            config_.coherence.protocol, config_.coherence.lookup_latency,
+            config_.coherence.snoop_latency));
+    }
+}
 
-        // order data storages by their dependencies
-        std::vector<std::string> data_storage_order;
+/**
+ * @brief collects the first level caches, which are the caches no other cache uses as
+ * next level data storage
+ */
+void MemoryHierarchy::init_ports_() {
+    std::set<std::string> next_level_data_storages;
+    for (const auto& cache_config : config_.caches) {
+        next_level_data_storages.insert(cache_config.next_level_data_storage);
+    }
 
-        // first add FakeMemories because they don't have a dependcy
-        for (const auto& data_storage_name : data_storage_names_) {
-            if (data_storage_type_map_[data_storage_name].compare("FakeMemory") == 0) {
-                data_storage_order.push_back(data_storage_name);
-            }
-        }
+    port_names_.clear();
+    first_level_caches_.clear();
 
-        // CAUTION: This is a naive implementation of topological sort and probably only
-        // works for linear memory hierarchies
-        while (data_storage_order.size() < data_storage_names_.size()) {
-            // add data storages which aren't already added and those next level data
-            // storages have already been added
-            for (const auto& data_storage_name : data_storage_names_) {
-                if (std::find(data_storage_order.begin(), data_storage_order.end(),
-                              data_storage_name) == data_storage_order.end()) {
-                    if (std::find(data_storage_order.begin(), data_storage_order.end(),
-                                  data_storage_dependency_map_[data_storage_name]) !=
-                        data_storage_order.end()) {
-                        data_storage_order.push_back(data_storage_name);
-                    }
-                }
-            }
+    for (const auto& cache_config : config_.caches) {
+        if (next_level_data_storages.count(cache_config.name) == 0) {
+            port_names_.push_back(cache_config.name);
+            first_level_caches_.push_back(std::dynamic_pointer_cast<CacheInterface>(
+                data_storage_map_[cache_config.name]));
         }
+    }
+}
 
-        // instantiate data storages
-        for (const auto& data_storage_name : data_storage_order) {
-            if (data_storage_type_map_[data_storage_name].compare("FakeMemory") == 0) {
-                std::shared_ptr<FakeMemory> fake_memory;
-
-                // TODO: fix this in the future
-                // since YAML:Nodes seems to be problematic when copying them from the
-                // loop where they are accessed iterate a second time over data storages
-                // to get node for current data storage
-                for (const auto& data_storage : data_storages) {
-                    if (data_storage["name"].as<std::string>().compare(
-                            data_storage_name) == 0) {
-                        fake_memory = fake_memory_from_yaml_node_(data_storage);
-                        break;
-                    }
-                }
-
-                data_storage_map_.insert({data_storage_name, fake_memory});
-            }
+/**
+ * @brief registers the first level caches at the coherence directory
+ */
+void MemoryHierarchy::init_coherence_(
+    std::shared_ptr<CoherenceDirectory> coherence_directory) {
+    coherence_directory_ = coherence_directory;
+
+    for (size_t port = 0; port < first_level_caches_.size(); port++) {
+        auto cache =
+            std::dynamic_pointer_cast<SetAssociativeCache>(first_level_caches_[port]);
+        cache->set_coherence_directory(coherence_directory_, port);
+    }
+}
 
-            else if (data_storage_type_map_[data_storage_name].compare(
-                         "SetAssociativeCache") == 0) {
-                std::shared_ptr<SetAssociativeCache> set_associative_cache;
-
-                auto next_level_data_storage =
-                    data_storage_map_[data_storage_dependency_map_[data_storage_name]];
-
-                // TODO: fix this in the future
-                // since YAML:Nodes seems to be problematic when copying them from the
-                // loop where they are accessed iterate a second time over data storages
-                // to get node for current data storage
-                for (const auto& data_storage : data_storages) {
-                    if (data_storage["name"].as<std::string>().compare(
-                            data_storage_name) == 0) {
-                        set_associative_cache = set_associative_cache_from_yaml_node_(
-                            data_storage, next_level_data_storage);
-                        break;
-                    }
-                }
-
-                data_storage_map_.insert({data_storage_name, set_associative_cache});
-            }
+const HierarchyConfig& MemoryHierarchy::get_config() const { return config_; }
+
+std::shared_ptr<CoherenceDirectory> MemoryHierarchy::get_coherence_directory() {
+    return coherence_directory_;
+}
+
+std::shared_ptr<MemoryInterface> MemoryHierarchy::memory_from_config_(
+    const MemoryConfig& config) {
+    if (config.type == SPARSE_MEMORY) {
+        if (base_image_ != nullptr) {
+            THROW_INVALID_ARGUMENT("base images can only be shared by memories of type "
+                                   "FakeMemory or DramMemory");
         }
 
-        top_level_memory = std::dynamic_pointer_cast<MemoryInterface>(
-            data_storage_map_[data_storage_order[0]]);
-        first_level_cache_ = std::dynamic_pointer_cast<CacheInterface>(
-            data_storage_map_[data_storage_order[data_storage_order.size() - 1]]);
-        // set data_storage_names_ to data_storage_order in reverse
-        data_storage_names_.clear();
-        for (auto it = data_storage_order.rbegin(); it != data_storage_order.rend();
-             ++it) {
-            data_storage_names_.push_back(*it);
+        auto sparse_memory = std::make_shared<SparseMemory>(
+            config.name, config.size, config.read_latency, config.write_latency,
+            config.page_size);
+        return sparse_memory;
+    }
+
+    std::shared_ptr<BackingStore> backing_store;
+
+    // with a shared base image the memory is a copy-on-write overlay and size is
+    // optional
+    if (base_image_ != nullptr) {
+        if (!config.image.empty()) {
+            std::string msg = "'" + config.name +
+                              "' can't have an image when a base image is shared";
+            THROW_INVALID_ARGUMENT(msg);
+        }
+        if (config.size != 0 && config.size != base_image_->size()) {
+            std::string msg =
+                "size of '" + config.name + "' doesn't match the base image";
+            THROW_INVALID_ARGUMENT(msg);
         }
 
+        backing_store = std::make_shared<CowBackingStore>(base_image_);
+    } else if (!config.image.empty()) {
+        // if an image is given it is mapped into the memory and size is optional
+        backing_store = std::make_shared<MappedBackingStore>(config.image, config.size);
     } else {
-        throw std::runtime_error("No 'nodes' in yaml config");
+        backing_store = std::make_shared<DenseBackingStore>(config.size);
     }
-}
 
-std::shared_ptr<FakeMemory> MemoryHierarchy::fake_memory_from_yaml_node_(
-    const YAML::Node& yaml_node) {
-    std::string name = yaml_node["name"].as<std::string>();
-    uint64_t size = yaml_node["size"].as<uint64_t>();
-    latency_t read_latency = yaml_node["read_latency"].as<latency_t>();
-    latency_t write_latency = yaml_node["write_latency"].as<latency_t>();
+    if (config.type == DRAM_MEMORY) {
+        auto dram_memory = std::make_shared<DramMemory>(
+            config.name, backing_store, config.read_latency, config.write_latency,
+            config.channels, config.ranks, config.banks, config.row_size,
+            config.burst_size, config.row_policy, config.dram_timings);
+        return dram_memory;
+    }
 
-    auto fake_memory =
-        std::make_shared<FakeMemory>(name, size, read_latency, write_latency);
+    auto fake_memory = std::make_shared<FakeMemory>(
+        config.name, backing_store, config.read_latency, config.write_latency);
     return fake_memory;
 }
 
-std::shared_ptr<SetAssociativeCache>
-MemoryHierarchy::set_associative_cache_from_yaml_node_(
-    const YAML::Node& yaml_node, std::shared_ptr<DataStorage> next_level_data_storage) {
-    std::string name = yaml_node["name"].as<std::string>();
-    bool write_allocate = yaml_node["write_allocate"].as<bool>();
-    bool write_through = yaml_node["write_through"].as<bool>();
-    latency_t miss_latency = yaml_node["miss_latency"].as<latency_t>();
-    latency_t hit_latency = yaml_node["hit_latency"].as<latency_t>();
-    size_t cache_block_size = yaml_node["cache_block_size"].as<size_t>();
-    size_t sets = yaml_node["sets"].as<size_t>();
-    size_t ways = yaml_node["ways"].as<size_t>();
-    std::string replacement_policy_str =
-        yaml_node["replacement_policy"].as<std::string>();
-
-    ReplacementPolicyType replacement_policy_type;
-
-    if (replacement_policy_str.compare("LRU") == 0) {
-        replacement_policy_type = ReplacementPolicyType::LRU;
-    } else {
-        std::string msg = "replacement_policy '" + replacement_policy_str + "' for '" +
-                          name + "' unknown in yaml config";
-        THROW_INVALID_ARGUMENT(msg);
+std::shared_ptr<CacheInterface> MemoryHierarchy::cache_from_config_(
+    const CacheConfig& config,
+    std::shared_ptr<DataStorage> next_level_data_storage) {
+    if (config.type == FULLY_ASSOCIATIVE_CACHE) {
+        auto fully_associative_cache = std::make_shared<FullyAssociativeCache>(
+            config.name, next_level_data_storage, config.write_allocate,
+            config.write_through, config.miss_latency, config.hit_latency,
+            config.cache_block_size, config.ways);
+        return fully_associative_cache;
     }
 
-    size_t multi_block_access = yaml_node["multi_block_access"].as<size_t>();
+    if (config.type == SKEWED_ASSOCIATIVE_CACHE) {
+        auto skewed_associative_cache = std::make_shared<SkewedAssociativeCache>(
+            config.name, next_level_data_storage, config.write_allocate,
+            config.write_through, config.miss_latency, config.hit_latency,
+            config.cache_block_size, config.sets, config.ways,
+            config.skewed_replacement_policy);
+        return skewed_associative_cache;
+    }
 
     auto set_associative_cache = std::make_shared<SetAssociativeCache>(
-        name, next_level_data_storage, write_allocate, write_through, miss_latency,
-        hit_latency, cache_block_size, sets, ways, replacement_policy_type,
-        multi_block_access);
+        config.name, next_level_data_storage, config.write_allocate,
+        config.write_through, config.miss_latency, config.hit_latency,
+        config.cache_block_size, config.sets, config.ways, config.replacement_policy,
+        config.multi_block_access, config.mshrs, config.index_function, config.sectors,
+        config.write_no_fetch);
+
+    set_associative_cache->set_prefetcher(Prefetcher::create(
+        config.prefetcher, config.cache_block_size, config.prefetch_degree));
+
+    if (config.victim_cache_size != 0) {
+        set_associative_cache->set_victim_cache(std::make_shared<VictimCache>(
+            config.cache_block_size, config.victim_cache_size / config.cache_block_size,
+            config.victim_cache_latency));
+    }
+
+    if (config.write_buffer_entries != 0) {
+        size_t granularity = config.write_buffer_granularity != 0
+                                 ? config.write_buffer_granularity
+                                 : config.cache_block_size;
+        set_associative_cache->set_write_buffer(
+            std::make_shared<WriteBuffer>(config.write_buffer_entries, granularity,
+                                          config.write_buffer_drain_policy));
+    }
+
+    if (config.banks != 0) {
+        size_t bank_width =
+            config.bank_width != 0 ? config.bank_width : config.cache_block_size;
+        set_associative_cache->set_banks(std::make_shared<CacheBanks>(
+            config.banks, bank_width, config.bank_busy_cycles, config.bank_function));
+    }
 
     return set_associative_cache;
 }
 
 DataStorageTransaction MemoryHierarchy::write(address_t address, Data& data) {
-    auto read_dst = first_level_cache_->write(address, data);
-    return read_dst;
+    return write(0, address, data);
 }
 
 DataStorageTransaction MemoryHierarchy::read(address_t address, size_t num_bytes) {
-    auto write_dst = first_level_cache_->read(address, num_bytes);
+    return read(0, address, num_bytes);
+}
+
+/**
+ * @brief write data through the first level cache of a port
+ * @param port the index of the port, see get_port
+ * @param address the address to write to
+ * @param data the data to write
+ */
+DataStorageTransaction MemoryHierarchy::write(size_t port, address_t address,
+                                              Data& data) {
+    if (timed_) {
+        return get_first_level_cache_(port)->write_at(cycle_, address, data);
+    }
+
+    auto write_dst = get_first_level_cache_(port)->write(address, data);
     return write_dst;
 }
 
+/**
+ * @brief read data through the first level cache of a port
+ * @param port the index of the port, see get_port
+ * @param address the address to read from
+ * @param num_bytes the number of bytes to read
+ */
+DataStorageTransaction MemoryHierarchy::read(size_t port, address_t address,
+                                             size_t num_bytes) {
+    if (timed_) {
+        return get_first_level_cache_(port)->read_at(cycle_, address, num_bytes);
+    }
+
+    auto read_dst = get_first_level_cache_(port)->read(address, num_bytes);
+    return read_dst;
+}
+
+/**
+ * @brief enables or disables the timed mode. In timed mode reads and writes are issued
+ * in the current cycle of the global clock and return the cycle in which they complete,
+ * so multiple accesses can be outstanding at once. The clock is advanced explicitly.
+ * @param timed if accesses are timed
+ * @throws std::runtime_error if the hierarchy is in concurrent mode, the ports share
+ * the global clock
+ */
+void MemoryHierarchy::set_timed(bool timed) {
+    if (timed && concurrent_) {
+        THROW_RUNTIME_ERROR("timed mode isn't supported in concurrent mode");
+    }
+    timed_ = timed;
+}
+
+bool MemoryHierarchy::is_timed() const { return timed_; }
+
+cycle_t MemoryHierarchy::get_cycle() const { return cycle_; }
+
+/**
+ * @brief advances the global clock
+ * @param cycles the number of cycles to advance
+ */
+void MemoryHierarchy::advance(cycle_t cycles) { cycle_ += cycles; }
+
+/**
+ * @brief advances the global clock to a cycle, e.g. the completion cycle of an access
+ * @throws std::invalid_argument if the cycle is in the past
+ */
+void MemoryHierarchy::advance_to(cycle_t cycle) {
+    if (cycle < cycle_) {
+        std::string msg = "cycle " + std::to_string(cycle) +
+                          " is before the current cycle " + std::to_string(cycle_);
+        THROW_INVALID_ARGUMENT(msg);
+    }
+    cycle_ = cycle;
+}
+
+CacheInterface* MemoryHierarchy::get_first_level_cache_(size_t port) {
+    if (port >= first_level_caches_.size()) {
+        std::string err_msg = std::string("port ") + std::to_string(port) +
+                              std::string(" is out of range for ") +
+                              std::to_string(first_level_caches_.size()) +
+                              std::string(" ports");
+        THROW_OUT_OF_RANGE(err_msg);
+    }
+    return first_level_caches_[port].get();
+}
+
+size_t MemoryHierarchy::get_port_count() const { return first_level_caches_.size(); }
+
+const std::vector<std::string>& MemoryHierarchy::get_port_names() const {
+    return port_names_;
+}
+
+/**
+ * @brief returns the port of a first level cache
+ * @param name the name of the first level cache
+ * @throws std::invalid_argument if there is no first level cache with the name
+ */
+size_t MemoryHierarchy::get_port(const std::string& name) const {
+    auto it = std::find(port_names_.begin(), port_names_.end(), name);
+    if (it == port_names_.end()) {
+        std::string msg = "no first level cache with name '" + name + "'";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+    return it - port_names_.begin();
+}
+
 DataStorageTransaction MemoryHierarchy::flush_all_caches() {
-    // strating from the first level cache iterate over all cache levels to flush
-    // them. Since the last level is a memory it can't be flushed
+    // strating from the first level caches iterate over all cache levels to flush
+    // them. Every cache is flushed before its next level, memories can't be flushed
     int32_t hit_level = 0;
     latency_t latency = 0;
 
-    for (int i = 0; i < data_storage_names_.size() - 1; i++) {
+    for (const auto& data_storage_name : data_storage_names_) {
         auto cache = std::dynamic_pointer_cast<CacheInterface>(
-            data_storage_map_[data_storage_names_[i]]);
-        auto flush_dst = cache->flush();
-        latency += flush_dst.latency;
+            data_storage_map_[data_storage_name]);
+        if (cache != nullptr) {
+            auto flush_dst = cache->flush();
+            latency += flush_dst.latency;
+        }
     }
     Data data = Data(0);
     DataStorageTransaction dst = {WRITE, 0, latency, hit_level, data};
@@ -234,6 +380,122 @@ DataStorageTransaction MemoryHierarchy::flush_all_caches() {
     return dst;
 }
 
-void MemoryHierarchy::reset() {}
+/**
+ * @brief returns the data storage with the given name, e.g. to change its latencies
+ * @throws std::invalid_argument if there is no data storage with the name
+ */
+std::shared_ptr<DataStorage> MemoryHierarchy::get_data_storage(
+    const std::string& name) {
+    auto it = data_storage_map_.find(name);
+    if (it == data_storage_map_.end()) {
+        std::string msg = "no data_storage with name '" + name + "'";
+        THROW_INVALID_ARGUMENT(msg);
+    }
+    return it->second;
+}
+
+/**
+ * @brief creates an independent copy of the memory hierarchy. All cache levels are
+ * copied with their tags, data, valid and dirty bits and replacement state, the memory
+ * is shared copy-on-write. The copy and the original can be used on different threads
+ * afterwards.
+ * @return the copy of the memory hierarchy
+ */
+std::unique_ptr<MemoryHierarchy> MemoryHierarchy::clone() {
+    auto memory_hierarchy = std::make_unique<MemoryHierarchy>();
+
+    memory_hierarchy->config_ = config_;
+    memory_hierarchy->data_storage_names_ = data_storage_names_;
+    memory_hierarchy->data_storage_type_map_ = data_storage_type_map_;
+    memory_hierarchy->data_storage_dependency_map_ = data_storage_dependency_map_;
+    memory_hierarchy->base_image_ = base_image_;
+    memory_hierarchy->timed_ = timed_;
+    memory_hierarchy->cycle_ = cycle_;
+    memory_hierarchy->concurrent_ = concurrent_;
+
+    // data_storage_names_ starts with the first level cache, so the next level data
+    // storage of each cache is cloned before the cache itself
+    for (auto it = data_storage_names_.rbegin(); it != data_storage_names_.rend();
+         ++it) {
+        auto data_storage = data_storage_map_[*it];
+
+        auto memory = std::dynamic_pointer_cast<MemoryInterface>(data_storage);
+        auto cache = std::dynamic_pointer_cast<CacheInterface>(data_storage);
+
+        std::shared_ptr<DataStorage> data_storage_clone;
+        if (memory != nullptr) {
+            data_storage_clone = memory->clone();
+        } else if (cache != nullptr) {
+            data_storage_clone = cache->clone(
+                memory_hierarchy->data_storage_map_[data_storage_dependency_map_[*it]]);
+        }
+
+        memory_hierarchy->data_storage_map_.insert({*it, data_storage_clone});
+    }
+
+    memory_hierarchy->top_level_memory = std::dynamic_pointer_cast<MemoryInterface>(
+        memory_hierarchy->data_storage_map_[data_storage_names_.back()]);
+    memory_hierarchy->init_ports_();
+
+    if (coherence_directory_ != nullptr) {
+        memory_hierarchy->init_coherence_(coherence_directory_->clone());
+    }
+
+    return memory_hierarchy;
+}
+
+/**
+ * @brief enables or disables concurrent accesses through different ports, each port
+ * may then be used by its own thread. Only data storages reachable from more than one
+ * port are locked, private first level caches stay lock-free. Flushes, resets and
+ * clones must not run concurrently with accesses.
+ * @param concurrent if different ports may be accessed at the same time
+ * @throws std::runtime_error if the first level caches are kept coherent, snoops
+ * access other first level caches, or if the hierarchy is in timed mode
+ */
+void MemoryHierarchy::set_concurrent(bool concurrent) {
+    if (concurrent && coherence_directory_ != nullptr) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported for coherent caches");
+    }
+    if (concurrent && timed_) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported in timed mode");
+    }
+    concurrent_ = concurrent;
+
+    std::map<std::string, size_t> port_counts;
+
+    for (const auto& port_name : port_names_) {
+        // data storages are visited once per port, the chain ends at a memory
+        std::string data_storage_name = port_name;
+        while (true) {
+            port_counts[data_storage_name]++;
+
+            auto it = data_storage_dependency_map_.find(data_storage_name);
+            if (it == data_storage_dependency_map_.end()) {
+                break;
+            }
+            data_storage_name = it->second;
+        }
+    }
+
+    for (const auto& [data_storage_name, port_count] : port_counts) {
+        data_storage_map_[data_storage_name]->set_concurrent(concurrent &&
+                                                             port_count > 1);
+    }
+}
+
+/**
+ * @brief reset all cache levels, this invalidates all cached blocks without writing
+ * them back. The content of the top level memory is kept.
+ */
+void MemoryHierarchy::reset() {
+    for (const auto& data_storage_name : data_storage_names_) {
+        auto cache = std::dynamic_pointer_cast<CacheInterface>(
+            data_storage_map_[data_storage_name]);
+        if (cache != nullptr) {
+            cache->reset();
+        }
+    }
+}
 
 }  // namespace kachesim
@@ -0,0 +1,30 @@
+#include "kachesim/prefetcher/next_line_prefetcher.h"
+
+namespace kachesim {
+NextLinePrefetcher::NextLinePrefetcher(size_t cache_block_size, size_t degree)
+    : cache_block_size_(cache_block_size), degree_(degree) {}
+
+std::vector<address_t> NextLinePrefetcher::access([[maybe_unused]] address_t pc,
+                                                  address_t address, bool miss) {
+    std::vector<address_t> addresses;
+    if (!miss) {
+        return addresses;
+    }
+
+    address_t block_address = address - address % cache_block_size_;
+    for (size_t i = 1; i <= degree_; i++) {
+        // blocks past the end of the address space wrap around
+        if (block_address + i * cache_block_size_ < block_address) {
+            break;
+        }
+        addresses.push_back(block_address + i * cache_block_size_);
+    }
+    return addresses;
+}
+
+std::shared_ptr<Prefetcher> NextLinePrefetcher::clone() {
+    return std::make_shared<NextLinePrefetcher>(*this);
+}
+
+void NextLinePrefetcher::reset() {}
+}  // namespace kachesim
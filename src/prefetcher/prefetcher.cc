@@ -0,0 +1,34 @@
+#include "kachesim/prefetcher/prefetcher.h"
+
+#include "kachesim/common.h"
+#include "kachesim/prefetcher/next_line_prefetcher.h"
+#include "kachesim/prefetcher/stream_prefetcher.h"
+#include "kachesim/prefetcher/stride_prefetcher.h"
+
+namespace kachesim {
+Prefetcher::~Prefetcher() = default;
+
+/**
+ * @brief creates a prefetcher with its default parameters
+ * @param type the type of the prefetcher
+ * @param cache_block_size the block size of the cache the prefetcher is attached to
+ * @param degree the number of blocks prefetched ahead
+ * @return the prefetcher, nullptr for NO_PREFETCHER
+ */
+std::shared_ptr<Prefetcher> Prefetcher::create(PrefetcherType type,
+                                               size_t cache_block_size,
+                                               size_t degree) {
+    switch (type) {
+        case NO_PREFETCHER:
+            return nullptr;
+        case NEXT_LINE_PREFETCHER:
+            return std::make_shared<NextLinePrefetcher>(cache_block_size, degree);
+        case STRIDE_PREFETCHER:
+            return std::make_shared<StridePrefetcher>(cache_block_size, degree);
+        case STREAM_PREFETCHER:
+            return std::make_shared<StreamPrefetcher>(cache_block_size, degree);
+        default:
+            THROW_INVALID_ARGUMENT("invalid PrefetcherType");
+    }
+}
+}  // namespace kachesim
@@ -0,0 +1,104 @@
+#include "kachesim/prefetcher/stream_prefetcher.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+StreamPrefetcher::StreamPrefetcher(size_t cache_block_size, size_t degree,
+                                   size_t streams)
+    : cache_block_size_(cache_block_size), degree_(degree) {
+    if (streams == 0) {
+        THROW_INVALID_ARGUMENT("stream prefetcher without streams");
+    }
+    streams_ = std::vector<StreamBuffer>(streams);
+}
+
+/**
+ * @brief checks if a block lies between the last block of a stream and the last
+ * prefetched block
+ */
+bool StreamPrefetcher::is_in_stream(const StreamBuffer& stream, address_t block) {
+    if (!stream.valid || stream.direction == 0) {
+        return false;
+    }
+
+    int64_t distance =
+        static_cast<int64_t>(block - stream.last_block) * stream.direction;
+    int64_t window =
+        static_cast<int64_t>(stream.next_block - stream.last_block) * stream.direction;
+    return distance > 0 && distance <= window;
+}
+
+/**
+ * @brief moves the stream to block and prefetches until it is degree blocks ahead
+ * @return the addresses of the blocks to prefetch
+ */
+std::vector<address_t> StreamPrefetcher::advance(StreamBuffer& stream,
+                                                 address_t block) {
+    std::vector<address_t> addresses;
+
+    stream.last_block = block;
+    stream.last_use = accesses_;
+
+    address_t end_block = block + stream.direction * static_cast<int64_t>(degree_ + 1);
+    address_t max_block = std::numeric_limits<address_t>::max() / cache_block_size_;
+    while (stream.next_block != end_block) {
+        // blocks which leave the address space wrap around and aren't prefetched
+        bool wrapped = stream.direction > 0 ? stream.next_block < block
+                                            : stream.next_block > block;
+        if (!wrapped && stream.next_block <= max_block) {
+            addresses.push_back(stream.next_block * cache_block_size_);
+        }
+        stream.next_block += stream.direction;
+    }
+    return addresses;
+}
+
+std::vector<address_t> StreamPrefetcher::access([[maybe_unused]] address_t pc,
+                                                address_t address, bool miss) {
+    address_t block = address / cache_block_size_;
+    accesses_++;
+
+    for (auto& stream : streams_) {
+        if (is_in_stream(stream, block)) {
+            return advance(stream, block);
+        }
+    }
+
+    if (!miss) {
+        return {};
+    }
+
+    // a miss next to the start of a new stream sets its direction
+    for (auto& stream : streams_) {
+        if (stream.valid && stream.direction == 0 &&
+            (block == stream.last_block + 1 || block == stream.last_block - 1)) {
+            stream.direction = block == stream.last_block + 1 ? 1 : -1;
+            stream.next_block = block + stream.direction;
+            return advance(stream, block);
+        }
+    }
+
+    auto lru_stream = std::min_element(
+        streams_.begin(), streams_.end(), [](const auto& a, const auto& b) {
+            if (a.valid != b.valid) {
+                return !a.valid;
+            }
+            return a.last_use < b.last_use;
+        });
+    *lru_stream = {true, block, block, 0, accesses_};
+
+    return {};
+}
+
+std::shared_ptr<Prefetcher> StreamPrefetcher::clone() {
+    return std::make_shared<StreamPrefetcher>(*this);
+}
+
+void StreamPrefetcher::reset() {
+    std::fill(streams_.begin(), streams_.end(), StreamBuffer());
+    accesses_ = 0;
+}
+}  // namespace kachesim
@@ -0,0 +1,74 @@
+#include "kachesim/prefetcher/stride_prefetcher.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+StridePrefetcher::StridePrefetcher(size_t cache_block_size, size_t degree,
+                                   size_t table_size)
+    : cache_block_size_(cache_block_size), degree_(degree) {
+    if (table_size == 0) {
+        THROW_INVALID_ARGUMENT("table size of stride prefetcher is 0");
+    }
+    table_ = std::vector<StridePrefetcherEntry>(table_size);
+}
+
+std::vector<address_t> StridePrefetcher::access(address_t pc, address_t address,
+                                                [[maybe_unused]] bool miss) {
+    std::vector<address_t> addresses;
+    auto& entry = table_[pc % table_.size()];
+
+    // another instruction takes over the entry
+    if (!entry.valid || entry.pc != pc) {
+        entry = {true, pc, address, 0, 0};
+        return addresses;
+    }
+
+    int64_t stride = static_cast<int64_t>(address - entry.last_address);
+    if (stride == 0) {
+        return addresses;
+    }
+
+    if (stride == entry.stride) {
+        entry.confidence = std::min(entry.confidence + 1, max_confidence_);
+    } else {
+        entry.stride = stride;
+        entry.confidence = 0;
+    }
+    entry.last_address = address;
+
+    if (entry.confidence == 0) {
+        return addresses;
+    }
+
+    // strides smaller than a block lead to the same block multiple times
+    address_t block_address = address - address % cache_block_size_;
+    for (size_t i = 1; i <= degree_; i++) {
+        // strides which leave the address space wrap around
+        address_t distance = static_cast<address_t>(std::abs(stride)) * i;
+        if (stride < 0 ? distance > address : address + distance < address) {
+            break;
+        }
+
+        address_t prefetch_address = address + static_cast<address_t>(stride * i);
+        prefetch_address -= prefetch_address % cache_block_size_;
+
+        if (prefetch_address != block_address &&
+            std::find(addresses.begin(), addresses.end(), prefetch_address) ==
+                addresses.end()) {
+            addresses.push_back(prefetch_address);
+        }
+    }
+    return addresses;
+}
+
+std::shared_ptr<Prefetcher> StridePrefetcher::clone() {
+    return std::make_shared<StridePrefetcher>(*this);
+}
+
+void StridePrefetcher::reset() {
+    std::fill(table_.begin(), table_.end(), StridePrefetcherEntry());
+}
+}  // namespace kachesim
@@ -30,6 +30,21 @@ void LeastRecentlyUsed::remove(uint32_t index) {
     size_--;
 }
 
+/**
+ * @brief creates an independent copy with the same order of indices
+ */
+std::shared_ptr<ReplacementPolicy> LeastRecentlyUsed::clone() {
+    auto lru = std::make_shared<LeastRecentlyUsed>();
+
+    for (const auto& dll_node : dll_.get_nodes()) {
+        auto node = lru->dll_.insert_tail(dll_node->value);
+        lru->map_.insert({dll_node->value, node});
+    }
+    lru->size_ = size_;
+
+    return lru;
+}
+
 std::string LeastRecentlyUsed::to_string() {
     std::stringstream ss;
 
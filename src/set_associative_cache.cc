@@ -1,5 +1,8 @@
 #include "kachesim/set_associative_cache.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
@@ -16,7 +19,9 @@ SetAssociativeCache::SetAssociativeCache(
     const std::string& name, std::shared_ptr<DataStorage> next_level_data_storage,
     bool write_allocate, bool write_through, latency_t miss_latency,
     latency_t hit_latency, size_t cache_block_size, size_t sets, size_t ways,
-    ReplacementPolicyType replacement_policy_type, size_t multi_block_access)
+    ReplacementPolicyType replacement_policy_type, size_t multi_block_access,
+    size_t mshrs, IndexFunctionType index_function_type, size_t sectors,
+    bool write_no_fetch)
 
     : name_(name),
       next_level_data_storage_(next_level_data_storage),
@@ -28,22 +33,474 @@ SetAssociativeCache::SetAssociativeCache(
       sets_(sets),
       ways_(ways),
       replacement_policy_type_(replacement_policy_type),
-      multi_block_access_(multi_block_access) {
-    offset_mask_ = bitmask<uint64_t>(clog2(cache_block_size_));
-    index_mask_ = bitmask<uint64_t>(clog2(sets_)) << clog2(cache_block_size_);
-    tag_mask_ = ~offset_mask_ & ~index_mask_;
+      multi_block_access_(multi_block_access),
+      mshrs_(mshrs),
+      sectors_(sectors),
+      write_no_fetch_(write_no_fetch),
+      offset_bits_(clog2(cache_block_size_)),
+      index_function_(index_function_type, sets_) {
+    offset_mask_ = bitmask<uint64_t>(offset_bits_);
+
+    if (sectors_ == 0 || sectors_ > 64 || (sectors_ & (sectors_ - 1)) != 0 ||
+        sectors_ > cache_block_size_) {
+        THROW_INVALID_ARGUMENT("sectors of cache '" + name_ +
+                               "' is not a power of two between 1 and 64 which "
+                               "divides the cache block size");
+    }
+    sector_size_ = cache_block_size_ / sectors_;
+    sector_bits_ = clog2(sector_size_);
 
-    reset();
+    if (write_no_fetch_ && sectors_ > 1) {
+        THROW_INVALID_ARGUMENT("cache '" + name_ +
+                               "' can't be sectored without fetch on write");
+    }
+
+    cache_sets_.reserve(sets_);
+
+    for (int i = 0; i < sets_; i++) {
+        cache_sets_.push_back(std::unique_ptr<CacheSet>(
+            new CacheSet(cache_block_size_, ways_, replacement_policy_type_, sectors_,
+                         write_no_fetch_)));
+    }
+
+    dirty_sets_ = std::vector<uint64_t>((sets_ + 63) / 64, 0);
+}
+
+/**
+ * @brief creates a deep copy of a cache which is connected to another next level data
+ * storage
+ */
+SetAssociativeCache::SetAssociativeCache(
+    const SetAssociativeCache& cache,
+    std::shared_ptr<DataStorage> next_level_data_storage)
+    : name_(cache.name_),
+      write_allocate_(cache.write_allocate_),
+      write_through_(cache.write_through_),
+      miss_latency_(cache.miss_latency_),
+      hit_latency_(cache.hit_latency_),
+      cache_block_size_(cache.cache_block_size_),
+      sets_(cache.sets_),
+      ways_(cache.ways_),
+      multi_block_access_(cache.multi_block_access_),
+      mshrs_(cache.mshrs_),
+      sectors_(cache.sectors_),
+      sector_size_(cache.sector_size_),
+      sector_bits_(cache.sector_bits_),
+      write_no_fetch_(cache.write_no_fetch_),
+      offset_mask_(cache.offset_mask_),
+      offset_bits_(cache.offset_bits_),
+      index_function_(cache.index_function_),
+      replacement_policy_type_(cache.replacement_policy_type_),
+      generation_(cache.generation_),
+      dirty_sets_(cache.dirty_sets_),
+      dirty_blocks_(cache.dirty_blocks_),
+      next_level_data_storage_(next_level_data_storage) {
+    cache_sets_.reserve(sets_);
+
+    for (const auto& cache_set : cache.cache_sets_) {
+        cache_sets_.push_back(cache_set->clone());
+    }
+
+    mshr_entries_ = cache.mshr_entries_;
+
+    // the copy gets its own locks and the stats of all shards of the original
+    set_concurrent(cache.concurrent_);
+    for (const auto& stats_shard : cache.stats_shards_) {
+        stats_shards_[0].stats += stats_shard.stats;
+    }
+
+    if (cache.prefetcher_ != nullptr) {
+        prefetcher_ = cache.prefetcher_->clone();
+    }
+    program_counter_ = cache.program_counter_;
+    prefetched_blocks_ = cache.prefetched_blocks_;
+
+    if (cache.victim_cache_ != nullptr) {
+        victim_cache_ = cache.victim_cache_->clone();
+    }
+
+    if (cache.write_buffer_ != nullptr) {
+        write_buffer_ = cache.write_buffer_->clone();
+    }
+
+    if (cache.banks_ != nullptr) {
+        banks_ = cache.banks_->clone();
+    }
+}
+
+/**
+ * @brief creates an independent copy of the cache with the same tags, data, valid and
+ * dirty bits and replacement state
+ * @param next_level_data_storage the data storage the copy forwards misses to
+ * @return the copy of the cache
+ */
+std::shared_ptr<CacheInterface> SetAssociativeCache::clone(
+    std::shared_ptr<DataStorage> next_level_data_storage) {
+    return std::shared_ptr<SetAssociativeCache>(
+        new SetAssociativeCache(*this, next_level_data_storage));
 }
 
 std::string SetAssociativeCache::get_name() { return name_; }
 
+latency_t SetAssociativeCache::get_hit_latency() { return hit_latency_; }
+
+latency_t SetAssociativeCache::get_miss_latency() { return miss_latency_; }
+
+void SetAssociativeCache::set_hit_latency(latency_t hit_latency) {
+    hit_latency_ = hit_latency;
+}
+
+void SetAssociativeCache::set_miss_latency(latency_t miss_latency) {
+    miss_latency_ = miss_latency;
+}
+
+size_t SetAssociativeCache::get_mshrs() { return mshrs_; }
+
+size_t SetAssociativeCache::get_sectors() { return sectors_; }
+
+bool SetAssociativeCache::get_write_no_fetch() { return write_no_fetch_; }
+
+/**
+ * @brief returns the number of misses which are still outstanding in a cycle
+ */
+size_t SetAssociativeCache::get_outstanding_miss_count(cycle_t cycle) {
+    auto mshr_lock = lock_mshrs();
+    return std::count_if(
+        mshr_entries_.begin(), mshr_entries_.end(),
+        [cycle](const Mshr& mshr) { return mshr.ready_cycle > cycle; });
+}
+
+/**
+ * @brief frees the MSHRs of all misses which completed until cycle
+ */
+void SetAssociativeCache::retire_mshrs(cycle_t cycle) {
+    if (!access_state().timed) {
+        return;
+    }
+
+    auto mshr_lock = lock_mshrs();
+    mshr_entries_.erase(
+        std::remove_if(mshr_entries_.begin(), mshr_entries_.end(),
+                       [cycle](const Mshr& mshr) { return mshr.ready_cycle <= cycle; }),
+        mshr_entries_.end());
+}
+
+/**
+ * @brief waits for a free MSHR if all of them are in use
+ * @return the cycles the current access has to wait
+ */
+latency_t SetAssociativeCache::reserve_mshr() {
+    AccessState& access = access_state();
+
+    if (!access.timed || mshrs_ == 0) {
+        return 0;
+    }
+
+    auto mshr_lock = lock_mshrs();
+    if (mshr_entries_.size() < mshrs_) {
+        return 0;
+    }
+
+    auto first_ready = std::min_element(
+        mshr_entries_.begin(), mshr_entries_.end(),
+        [](const Mshr& a, const Mshr& b) { return a.ready_cycle < b.ready_cycle; });
+    cycle_t ready_cycle = first_ready->ready_cycle;
+    mshr_entries_.erase(first_ready);
+
+    count(&CacheStats::mshr_stalls);
+
+    // in concurrent mode the miss of another thread may complete before this access
+    return ready_cycle > access.access_cycle ? ready_cycle - access.access_cycle : 0;
+}
+
+/**
+ * @brief merges a hit into the MSHR of the block if its miss is still outstanding
+ * @param address the address of the block
+ * @param latency the latency of the hit
+ * @return the latency of the hit, which lasts at least until the miss completed
+ */
+latency_t SetAssociativeCache::merge_mshr(address_t address, latency_t latency) {
+    AccessState& access = access_state();
+
+    if (!access.timed) {
+        return latency;
+    }
+
+    auto mshr_lock = lock_mshrs();
+    for (const auto& mshr : mshr_entries_) {
+        if (mshr.address == address && mshr.ready_cycle > access.access_cycle) {
+            count(&CacheStats::mshr_merges);
+            return std::max<latency_t>(latency, mshr.ready_cycle - access.access_cycle);
+        }
+    }
+    return latency;
+}
+
+/**
+ * @brief tracks a miss of the block which is outstanding until ready_cycle
+ */
+void SetAssociativeCache::allocate_mshr(address_t address, cycle_t ready_cycle) {
+    if (!access_state().timed) {
+        return;
+    }
+
+    auto mshr_lock = lock_mshrs();
+    for (auto& mshr : mshr_entries_) {
+        if (mshr.address == address) {
+            mshr.ready_cycle = ready_cycle;
+            return;
+        }
+    }
+    mshr_entries_.push_back({address, ready_cycle});
+}
+
+/**
+ * @brief reads from the next level data storage, in timed mode the read is issued in
+ * the next level cycle of the access and its latency lasts until it completes
+ */
+DataStorageTransaction SetAssociativeCache::read_next_level(address_t address,
+                                                            size_t num_bytes) {
+    AccessState& access = access_state();
+
+    count(&CacheStats::next_level_bytes_read, num_bytes);
+
+    if (!access.timed) {
+        auto dst = next_level_data_storage_->read(address, num_bytes);
+        if (write_buffer_ != nullptr) {
+            write_buffer_->forward(address, dst.data);
+        }
+        return dst;
+    }
+
+    auto dst =
+        next_level_data_storage_->read_at(access.next_level_cycle, address, num_bytes);
+    dst.latency = dst.completion_cycle - access.next_level_cycle;
+    if (write_buffer_ != nullptr) {
+        write_buffer_->forward(address, dst.data);
+    }
+    return dst;
+}
+
+/**
+ * @brief writes to the next level data storage, in timed mode the write is issued in
+ * the next level cycle of the access and posted, so it adds no latency. If the cache
+ * has a write buffer the write goes there instead.
+ */
+DataStorageTransaction SetAssociativeCache::write_next_level(address_t address,
+                                                             Data& data) {
+    AccessState& access = access_state();
+
+    if (write_buffer_ != nullptr) {
+        return write_to_buffer(address, data);
+    }
+
+    count(&CacheStats::next_level_bytes_written, data.size());
+
+    if (!access.timed) {
+        return next_level_data_storage_->write(address, data);
+    }
+
+    auto dst =
+        next_level_data_storage_->write_at(access.next_level_cycle, address, data);
+    dst.latency = 0;
+    return dst;
+}
+
+/**
+ * @brief enables or disables concurrent accesses. In concurrent mode every aligned
+ * access locks the stripe of sets its index belongs to, the dirty tracking is updated
+ * atomically and stats are counted per thread. Must not be called concurrently with
+ * accesses.
+ * @param concurrent if reads and writes may be called from multiple threads at once
+ */
+void SetAssociativeCache::set_concurrent(bool concurrent) {
+    if (concurrent && prefetcher_ != nullptr) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported for caches with a "
+                            "prefetcher");
+    }
+    if (concurrent && victim_cache_ != nullptr) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported for caches with a victim "
+                            "cache");
+    }
+    if (concurrent && write_buffer_ != nullptr) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported for caches with a write "
+                            "buffer");
+    }
+    if (concurrent && banks_ != nullptr) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported for banked caches");
+    }
+
+    CacheStats stats = get_stats();
+
+    concurrent_ = concurrent;
+
+    if (concurrent_) {
+        set_lock_count_ = std::min(sets_, max_set_locks_);
+        set_locks_ = std::make_unique<std::mutex[]>(set_lock_count_);
+        stats_shards_ = std::vector<CacheStatsShard>(stats_shard_count_);
+    } else {
+        set_lock_count_ = 0;
+        set_locks_.reset();
+        stats_shards_ = std::vector<CacheStatsShard>(1);
+    }
+
+    stats_shards_[0].stats = stats;
+}
+
+bool SetAssociativeCache::is_concurrent() { return concurrent_; }
+
+/**
+ * @brief locks the stripe of sets the index belongs to, if the cache isn't concurrent
+ * nothing is locked
+ */
+std::unique_lock<std::mutex> SetAssociativeCache::lock_set(address_t index) {
+    if (!concurrent_) {
+        return std::unique_lock<std::mutex>();
+    }
+    return std::unique_lock<std::mutex>(set_locks_[index % set_lock_count_]);
+}
+
+/**
+ * @brief locks the MSHRs, if the cache isn't concurrent nothing is locked
+ */
+std::unique_lock<std::mutex> SetAssociativeCache::lock_mshrs() {
+    if (!concurrent_) {
+        return std::unique_lock<std::mutex>();
+    }
+    return std::unique_lock<std::mutex>(mshr_lock_);
+}
+
+/**
+ * @brief returns the states of the accesses to concurrent caches the calling thread is
+ * in, the innermost last. There is at most one access per cache level.
+ */
+std::vector<std::pair<const SetAssociativeCache*, SetAssociativeCache::AccessState>>&
+SetAssociativeCache::get_thread_access_states() {
+    thread_local std::vector<std::pair<const SetAssociativeCache*, AccessState>>
+        access_states;
+    return access_states;
+}
+
+/**
+ * @brief returns the state of the current access. In concurrent mode every thread
+ * accesses the cache with its own state, outside of an access it is untimed.
+ */
+SetAssociativeCache::AccessState& SetAssociativeCache::access_state() {
+    if (!concurrent_) {
+        return access_state_;
+    }
+
+    auto& access_states = get_thread_access_states();
+    for (auto it = access_states.rbegin(); it != access_states.rend(); it++) {
+        if (it->first == this) {
+            return it->second;
+        }
+    }
+
+    thread_local AccessState untimed_access_state;
+    untimed_access_state = AccessState();
+    return untimed_access_state;
+}
+
+/**
+ * @brief sets the state of an access until the scope ends, the previous state is
+ * restored afterwards
+ */
+SetAssociativeCache::AccessScope::AccessScope(SetAssociativeCache* cache,
+                                              AccessState access_state)
+    : cache_(cache) {
+    if (cache_->concurrent_) {
+        get_thread_access_states().push_back({cache_, access_state});
+    } else {
+        previous_access_state_ = cache_->access_state_;
+        cache_->access_state_ = access_state;
+    }
+}
+
+SetAssociativeCache::AccessScope::~AccessScope() {
+    if (cache_->concurrent_) {
+        get_thread_access_states().pop_back();
+    } else {
+        cache_->access_state_ = previous_access_state_;
+    }
+}
+
+// threads are numbered in the order they first count stats, the number selects the
+// stats shard of the thread
+static size_t get_thread_number() {
+    static std::atomic<size_t> thread_count = 0;
+    thread_local size_t thread_number = thread_count.fetch_add(1);
+    return thread_number;
+}
+
+static uint64_t load_counter(uint64_t& counter) {
+    return std::atomic_ref<uint64_t>(counter).load(std::memory_order_relaxed);
+}
+
+void SetAssociativeCache::count(uint64_t CacheStats::*counter, uint64_t amount) {
+    if (!concurrent_) {
+        stats_shards_[0].stats.*counter += amount;
+        return;
+    }
+
+    auto& stats = stats_shards_[get_thread_number() % stats_shards_.size()].stats;
+    std::atomic_ref<uint64_t>(stats.*counter).fetch_add(amount,
+                                                        std::memory_order_relaxed);
+}
+
+/**
+ * @brief returns the stats summed over all threads
+ */
+CacheStats SetAssociativeCache::get_stats() {
+    CacheStats stats;
+    for (auto& stats_shard : stats_shards_) {
+        stats.read_hits += load_counter(stats_shard.stats.read_hits);
+        stats.read_misses += load_counter(stats_shard.stats.read_misses);
+        stats.write_hits += load_counter(stats_shard.stats.write_hits);
+        stats.write_misses += load_counter(stats_shard.stats.write_misses);
+        stats.write_backs += load_counter(stats_shard.stats.write_backs);
+        stats.mshr_merges += load_counter(stats_shard.stats.mshr_merges);
+        stats.mshr_stalls += load_counter(stats_shard.stats.mshr_stalls);
+        stats.prefetches_issued += load_counter(stats_shard.stats.prefetches_issued);
+        stats.prefetches_useful += load_counter(stats_shard.stats.prefetches_useful);
+        stats.prefetches_late += load_counter(stats_shard.stats.prefetches_late);
+        stats.prefetches_polluting +=
+            load_counter(stats_shard.stats.prefetches_polluting);
+        stats.prefetches_dropped += load_counter(stats_shard.stats.prefetches_dropped);
+        stats.victim_hits += load_counter(stats_shard.stats.victim_hits);
+        stats.sector_misses += load_counter(stats_shard.stats.sector_misses);
+        stats.deferred_fills += load_counter(stats_shard.stats.deferred_fills);
+        stats.write_buffer_merges +=
+            load_counter(stats_shard.stats.write_buffer_merges);
+        stats.write_buffer_drains +=
+            load_counter(stats_shard.stats.write_buffer_drains);
+        stats.write_buffer_stalls +=
+            load_counter(stats_shard.stats.write_buffer_stalls);
+        stats.bank_conflicts += load_counter(stats_shard.stats.bank_conflicts);
+        stats.next_level_bytes_read +=
+            load_counter(stats_shard.stats.next_level_bytes_read);
+        stats.next_level_bytes_written +=
+            load_counter(stats_shard.stats.next_level_bytes_written);
+    }
+    return stats;
+}
+
+void SetAssociativeCache::reset_stats() {
+    for (auto& stats_shard : stats_shards_) {
+        stats_shard.stats = CacheStats();
+    }
+}
+
 /**
  * @brief Returns the size of the cache in bytes
  * @return The size of the cache in bytes
  */
 inline size_t SetAssociativeCache::size() { return sets_ * ways_ * cache_block_size_; }
 
+size_t SetAssociativeCache::get_address_space_size() {
+    return next_level_data_storage_->get_address_space_size();
+}
+
 /*
  * @brief calculates the offset of the address (n LSBs, while 2^n is the cache block
  * size)
@@ -60,7 +517,7 @@ inline address_t SetAssociativeCache::get_address_offset(address_t address) {
  * @return the offset of the address
  */
 inline address_t SetAssociativeCache::get_address_index(uint64_t address) {
-    return (address & index_mask_) >> clog2(cache_block_size_);
+    return index_function_.index(address >> offset_bits_);
 }
 
 /**
@@ -69,13 +526,12 @@ inline address_t SetAssociativeCache::get_address_index(uint64_t address) {
  * @return the tag of the address
  */
 inline address_t SetAssociativeCache::get_address_tag(address_t address) {
-    return (address & tag_mask_) >> (clog2(cache_block_size_) + clog2(sets_));
+    return index_function_.tag(address >> offset_bits_);
 }
 
 inline address_t SetAssociativeCache::get_address_from_index_and_tag(address_t index,
                                                                      address_t tag) {
-    return (tag << (clog2(cache_block_size_) + clog2(sets_))) |
-           (index << clog2(cache_block_size_));
+    return index_function_.block_address(index, tag) << offset_bits_;
 }
 
 /**
@@ -103,6 +559,597 @@ latency_t SetAssociativeCache::calculate_multi_block_access_latency(
                            sequential_access_latencies.end(), 0);
 }
 
+/**
+ * @brief calculates the latency of an access from the banks of the cache. All aligned
+ * transactions are issued at once, each starts when its banks are free. Without a
+ * timing model the banks are free at the start of every access.
+ * @param accesses the address and size of all aligned transactions
+ * @param latencies the latencies of all aligned transactions
+ * @return the latency of the access
+ */
+latency_t SetAssociativeCache::calculate_banked_access_latency(
+    const std::vector<std::pair<address_t, size_t>>& accesses,
+    const std::vector<latency_t>& latencies) {
+    AccessState& access = access_state();
+
+    cycle_t cycle = 0;
+    if (access.timed) {
+        cycle = access.access_cycle;
+    } else {
+        banks_->reset();
+    }
+
+    cycle_t completion_cycle = cycle;
+    for (size_t i = 0; i < accesses.size(); i++) {
+        auto [address, num_bytes] = accesses[i];
+        cycle_t block_completion_cycle =
+            banks_->schedule(address, num_bytes, cycle, latencies[i]);
+        if (block_completion_cycle > cycle + latencies[i]) {
+            count(&CacheStats::bank_conflicts);
+        }
+        completion_cycle = std::max(completion_cycle, block_completion_cycle);
+    }
+
+    return completion_cycle - cycle;
+}
+
+/**
+ * @brief keeps the cache coherent with the other caches registered at the directory
+ * @param directory the directory shared by all coherent caches
+ * @param coherence_id the id of the cache in the directory
+ */
+void SetAssociativeCache::set_coherence_directory(
+    std::shared_ptr<CoherenceDirectory> directory, size_t coherence_id) {
+    if (victim_cache_ != nullptr) {
+        THROW_RUNTIME_ERROR("caches with a victim cache can't be kept coherent");
+    }
+    if (sectors_ > 1) {
+        THROW_RUNTIME_ERROR("sectored caches can't be kept coherent");
+    }
+    if (write_no_fetch_) {
+        THROW_RUNTIME_ERROR("caches without fetch on write can't be kept coherent");
+    }
+    if (write_buffer_ != nullptr) {
+        THROW_RUNTIME_ERROR("caches with a write buffer can't be kept coherent");
+    }
+
+    coherence_directory_ = directory;
+    coherence_id_ = coherence_id;
+    coherence_directory_->set_cache(coherence_id_, this);
+}
+
+/**
+ * @brief handles a snoop of the coherence directory for a block of this cache
+ * @param address the address of the block
+ * @param invalidate if the block is invalidated, otherwise it is kept as shared copy
+ * @param write_back if a dirty block is written back to the next level data storage
+ * and becomes clean
+ * @param data receives the data of the block if not nullptr
+ * @return the latency of the write back
+ */
+latency_t SetAssociativeCache::snoop(address_t address, bool invalidate,
+                                     bool write_back, Data* data) {
+    address_t tag = get_address_tag(address);
+    address_t index = get_address_index(address);
+
+    int32_t block_index =
+        cache_sets_[index]->get_block_index_with_tag(tag, generation_);
+    if (block_index == -1) {
+        return 0;
+    }
+
+    latency_t latency = 0;
+    bool dirty = cache_sets_[index]->is_block_dirty(block_index);
+    Data block_data = cache_sets_[index]->get_block_data(block_index);
+
+    if (data != nullptr) {
+        std::copy(block_data.data(), block_data.data() + cache_block_size_,
+                  data->data());
+    }
+
+    if (dirty && write_back) {
+        auto write_back_dst =
+            write_next_level(get_address_from_index_and_tag(index, tag), block_data);
+        count(&CacheStats::write_backs);
+        latency += write_back_dst.latency;
+        dirty = false;
+    }
+
+    if (invalidate) {
+        update_cache_block(index, block_index, tag, block_data, false, false);
+        if (prefetcher_ != nullptr) {
+            prefetched_blocks_.erase(get_address_from_index_and_tag(index, tag));
+        }
+    } else {
+        update_cache_block(index, block_index, tag, block_data, true, dirty);
+    }
+
+    DEBUG_PRINT("> %s s @ 0x%016llx : i=%02lld / b=%04d - snooped%s%s\n",
+                name_.c_str(), address, index, block_index,
+                invalidate ? ", invalidated" : "", write_back ? ", written back" : "");
+
+    return latency;
+}
+
+/**
+ * @brief reads a block from the next level data storage. If the cache has a victim
+ * cache the block is taken from it on a hit, which counts as hit on this level. If the
+ * cache is coherent the block is requested from the directory first, which may forward
+ * it from its owner.
+ * @param address the address of the block
+ * @param write if the block is read to be written
+ * @param coherence accumulates the coherence actions
+ * @param dirty set if the block was dirty in the victim cache
+ */
+DataStorageTransaction SetAssociativeCache::read_next_level_block(
+    address_t address, bool write, CoherenceTransaction& coherence, bool& dirty) {
+    dirty = false;
+
+    if (victim_cache_ != nullptr) {
+        auto entry = victim_cache_->remove(address);
+        if (entry.has_value()) {
+            count(&CacheStats::victim_hits);
+            dirty = entry->dirty;
+
+            DataStorageTransaction dst = {READ, address, victim_cache_->get_latency(),
+                                          -1, entry->data};
+            return dst;
+        }
+    }
+
+    if (coherence_directory_ != nullptr) {
+        Data data = Data(cache_block_size_);
+
+        CoherenceTransaction transaction =
+            write ? coherence_directory_->write(coherence_id_, address, &data, true)
+                  : coherence_directory_->read(coherence_id_, address, &data);
+        coherence += transaction;
+
+        // a forwarded block counts as hit on the next level
+        if (transaction.forwarded) {
+            DataStorageTransaction dst = {READ, address, 0, 0, data};
+            return dst;
+        }
+    }
+
+    return read_next_level(address, cache_block_size_);
+}
+
+/**
+ * @brief requests the permission to write a block from the coherence directory, which
+ * invalidates all other copies
+ * @param address the address of the block
+ * @param allocate if the block is kept in this cache
+ * @param coherence accumulates the coherence actions
+ */
+void SetAssociativeCache::request_write(address_t address, bool allocate,
+                                        CoherenceTransaction& coherence) {
+    if (coherence_directory_ != nullptr) {
+        coherence +=
+            coherence_directory_->write(coherence_id_, address, nullptr, allocate);
+    }
+}
+
+/**
+ * @brief evicts a valid block. A dirty block is written back to the next level data
+ * storage, if the cache has a victim cache the block is moved there instead and only
+ * the block replaced in the victim cache is written back. The coherence directory is
+ * notified and prefetched blocks which were never accessed are counted.
+ * @return the latency of the write back
+ */
+latency_t SetAssociativeCache::evict_block(address_t index, uint32_t block_index) {
+    if (!cache_sets_[index]->is_block_valid(block_index, generation_)) {
+        return 0;
+    }
+
+    address_t tag = cache_sets_[index]->get_block_tag(block_index);
+    address_t address = get_address_from_index_and_tag(index, tag);
+    bool dirty = cache_sets_[index]->is_block_dirty(block_index);
+    Data data = cache_sets_[index]->get_block_data(block_index);
+
+    if (coherence_directory_ != nullptr) {
+        coherence_directory_->evict(coherence_id_, address);
+    }
+
+    if (prefetcher_ != nullptr && prefetched_blocks_.erase(address) != 0) {
+        count(&CacheStats::prefetches_polluting);
+    }
+
+    if (victim_cache_ == nullptr) {
+        int32_t hit_level = 0;
+        return write_back_block(index, block_index, hit_level);
+    }
+
+    auto replaced = victim_cache_->insert(address, data, dirty);
+    if (!replaced.has_value() || !replaced->dirty) {
+        return 0;
+    }
+
+    auto write_back_dst = write_next_level(replaced->address, replaced->data);
+    count(&CacheStats::write_backs);
+    return write_back_dst.latency;
+}
+
+/**
+ * @brief attaches a victim cache to the cache, nullptr removes it. Blocks held by a
+ * removed victim cache are dropped.
+ * @throws std::runtime_error if the cache is in concurrent mode or coherent
+ */
+void SetAssociativeCache::set_victim_cache(std::shared_ptr<VictimCache> victim_cache) {
+    if (victim_cache != nullptr && concurrent_) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported for caches with a victim "
+                            "cache");
+    }
+    if (victim_cache != nullptr && coherence_directory_ != nullptr) {
+        THROW_RUNTIME_ERROR("caches with a victim cache can't be kept coherent");
+    }
+    if (victim_cache != nullptr && sectors_ > 1) {
+        THROW_RUNTIME_ERROR("sectored caches can't have a victim cache");
+    }
+    if (victim_cache != nullptr && write_no_fetch_) {
+        THROW_RUNTIME_ERROR("caches without fetch on write can't have a victim cache");
+    }
+
+    victim_cache_ = victim_cache;
+}
+
+std::shared_ptr<VictimCache> SetAssociativeCache::get_victim_cache() {
+    return victim_cache_;
+}
+
+/**
+ * @brief attaches a write buffer to the cache, nullptr removes it. Entries held by a
+ * removed write buffer are dropped.
+ * @throws std::runtime_error if the cache is in concurrent mode or coherent
+ */
+void SetAssociativeCache::set_write_buffer(std::shared_ptr<WriteBuffer> write_buffer) {
+    if (write_buffer != nullptr && concurrent_) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported for caches with a write "
+                            "buffer");
+    }
+    if (write_buffer != nullptr && coherence_directory_ != nullptr) {
+        THROW_RUNTIME_ERROR("caches with a write buffer can't be kept coherent");
+    }
+
+    write_buffer_ = write_buffer;
+}
+
+std::shared_ptr<WriteBuffer> SetAssociativeCache::get_write_buffer() {
+    return write_buffer_;
+}
+
+/**
+ * @brief divides the cache into banks, nullptr removes them
+ * @throws std::runtime_error if the cache is in concurrent mode
+ */
+void SetAssociativeCache::set_banks(std::shared_ptr<CacheBanks> banks) {
+    if (banks != nullptr && concurrent_) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported for banked caches");
+    }
+
+    banks_ = banks;
+}
+
+std::shared_ptr<CacheBanks> SetAssociativeCache::get_banks() { return banks_; }
+
+/**
+ * @brief writes to the write buffer, each granule of the write merges into its entry
+ * or allocates a new one. Only the time the write waits for a free entry is latency.
+ */
+DataStorageTransaction SetAssociativeCache::write_to_buffer(address_t address,
+                                                            Data& data) {
+    AccessState& access = access_state();
+
+    cycle_t cycle = access.timed ? access.next_level_cycle : 0;
+    latency_t latency = 0;
+
+    if (access.timed) {
+        advance_write_buffer(cycle);
+    }
+
+    address_t granularity = write_buffer_->get_granularity();
+    address_t end = address + data.size();
+
+    for (address_t chunk_address = address; chunk_address < end;) {
+        address_t chunk_end = std::min(end, (chunk_address | (granularity - 1)) + 1);
+
+        Data chunk = Data(chunk_end - chunk_address);
+        for (size_t i = 0; i < chunk.size(); i++) {
+            chunk[i] = data[chunk_address - address + i];
+        }
+
+        if (write_buffer_->merge(chunk_address, chunk)) {
+            count(&CacheStats::write_buffer_merges);
+        } else {
+            latency += free_write_buffer_entry(cycle + latency);
+            write_buffer_->insert(chunk_address, chunk, cycle + latency);
+        }
+
+        chunk_address = chunk_end;
+    }
+
+    DataStorageTransaction dst = {WRITE, address, latency, -1, data};
+    dst.completion_cycle = cycle + latency;
+    return dst;
+}
+
+/**
+ * @brief writes the written bytes of a write buffer entry to the next level data
+ * storage, each run of consecutive bytes with one access. In timed mode the entry
+ * starts draining in cycle and stays in the write buffer until the drain completes.
+ * @return the latency of the drain
+ */
+latency_t SetAssociativeCache::drain_write_buffer_entry(WriteBufferEntry& entry,
+                                                        cycle_t cycle) {
+    AccessState& access = access_state();
+
+    latency_t latency = 0;
+    cycle_t drained_cycle = cycle;
+
+    size_t offset = 0;
+    while (offset < entry.valid.size()) {
+        if (!entry.valid[offset]) {
+            offset++;
+            continue;
+        }
+
+        size_t end = offset + 1;
+        while (end < entry.valid.size() && entry.valid[end]) {
+            end++;
+        }
+
+        Data run_data = Data(end - offset);
+        for (size_t i = 0; i < run_data.size(); i++) {
+            run_data[i] = entry.data[offset + i];
+        }
+        count(&CacheStats::next_level_bytes_written, run_data.size());
+
+        if (access.timed) {
+            auto dst = next_level_data_storage_->write_at(cycle, entry.address + offset,
+                                                          run_data);
+            drained_cycle = std::max(drained_cycle, dst.completion_cycle);
+        } else {
+            auto dst =
+                next_level_data_storage_->write(entry.address + offset, run_data);
+            latency += dst.latency;
+        }
+
+        offset = end;
+    }
+
+    count(&CacheStats::write_buffer_drains);
+
+    if (access.timed) {
+        write_buffer_->set_draining(entry, drained_cycle);
+        return drained_cycle - cycle;
+    }
+    return latency;
+}
+
+/**
+ * @brief makes room for a new entry in the write buffer. Without a timing model eager
+ * drains happened in the background, with DRAIN_WHEN_FULL the oldest entry is drained
+ * if the buffer is full. In timed mode a full buffer waits for the first entry to
+ * finish draining.
+ * @param cycle the cycle in which the entry is needed
+ * @return the number of cycles the write waits for the entry
+ */
+latency_t SetAssociativeCache::free_write_buffer_entry(cycle_t cycle) {
+    if (!access_state().timed) {
+        if (write_buffer_->get_drain_policy() == DRAIN_EAGER) {
+            drain_write_buffer();
+            return 0;
+        }
+
+        if (!write_buffer_->is_full()) {
+            return 0;
+        }
+
+        count(&CacheStats::write_buffer_stalls);
+        auto entry = write_buffer_->remove_oldest();
+        return drain_write_buffer_entry(*entry, 0);
+    }
+
+    write_buffer_->retire(cycle);
+    if (!write_buffer_->is_full()) {
+        return 0;
+    }
+
+    count(&CacheStats::write_buffer_stalls);
+
+    auto drained_cycle = write_buffer_->get_first_drained_cycle();
+    if (!drained_cycle.has_value()) {
+        // no entry is draining, the oldest one starts now
+        auto& entry = write_buffer_->get_entry_list().front();
+        cycle_t start = std::max(cycle, write_buffer_->get_drain_cycle());
+        drain_write_buffer_entry(entry, start);
+        drained_cycle = entry.drained_cycle;
+    }
+
+    write_buffer_->retire(*drained_cycle);
+    return *drained_cycle - cycle;
+}
+
+/**
+ * @brief frees the write buffer entries whose drain completed until cycle. With eager
+ * draining the entries whose drain could start before cycle are drained one after the
+ * other.
+ */
+void SetAssociativeCache::advance_write_buffer(cycle_t cycle) {
+    if (write_buffer_->get_drain_policy() == DRAIN_EAGER) {
+        for (auto& entry : write_buffer_->get_entry_list()) {
+            if (entry.draining) {
+                continue;
+            }
+
+            // writes in cycle still merge into the entry
+            cycle_t start =
+                std::max(entry.insert_cycle, write_buffer_->get_drain_cycle());
+            if (start >= cycle) {
+                break;
+            }
+            drain_write_buffer_entry(entry, start);
+        }
+    }
+
+    write_buffer_->retire(cycle);
+}
+
+/**
+ * @brief writes all entries of the write buffer to the next level data storage which
+ * aren't draining already
+ * @return the summed up latency of the drains
+ */
+latency_t SetAssociativeCache::drain_write_buffer() {
+    latency_t latency = 0;
+
+    while (write_buffer_->get_entry_count() > 0) {
+        auto entry = write_buffer_->remove_oldest();
+        if (!entry->draining) {
+            latency += drain_write_buffer_entry(*entry, 0);
+        }
+    }
+
+    return latency;
+}
+
+/**
+ * @brief removes a block from the victim cache because it is written without being
+ * loaded, a dirty block is written back first
+ * @return the latency of the write back
+ */
+latency_t SetAssociativeCache::drop_victim_block(address_t address) {
+    if (victim_cache_ == nullptr) {
+        return 0;
+    }
+
+    auto entry = victim_cache_->remove(address);
+    if (!entry.has_value() || !entry->dirty) {
+        return 0;
+    }
+
+    auto write_back_dst = write_next_level(entry->address, entry->data);
+    count(&CacheStats::write_backs);
+    return write_back_dst.latency;
+}
+
+/**
+ * @brief attaches a prefetcher to the cache, nullptr disables prefetching
+ * @throws std::runtime_error if the cache is in concurrent mode
+ */
+void SetAssociativeCache::set_prefetcher(std::shared_ptr<Prefetcher> prefetcher) {
+    if (concurrent_ && prefetcher != nullptr) {
+        THROW_RUNTIME_ERROR("concurrent mode isn't supported for caches with a "
+                            "prefetcher");
+    }
+
+    prefetcher_ = prefetcher;
+    prefetched_blocks_.clear();
+}
+
+std::shared_ptr<Prefetcher> SetAssociativeCache::get_prefetcher() {
+    return prefetcher_;
+}
+
+/**
+ * @brief sets the program counter of the instruction issuing the following accesses,
+ * the prefetcher can use it to tell the access streams of instructions apart
+ */
+void SetAssociativeCache::set_program_counter(address_t pc) { program_counter_ = pc; }
+
+/**
+ * @brief counts the first access to a prefetched block
+ * @param address the address of the block
+ * @param late if the prefetch was still outstanding
+ * @return if the block was prefetched and not accessed before
+ */
+bool SetAssociativeCache::use_prefetched_block(address_t address, bool late) {
+    if (prefetcher_ == nullptr || prefetched_blocks_.erase(address) == 0) {
+        return false;
+    }
+
+    count(&CacheStats::prefetches_useful);
+    if (late) {
+        count(&CacheStats::prefetches_late);
+    }
+    return true;
+}
+
+/**
+ * @brief reports a demand access to the prefetcher and prefetches the blocks it
+ * predicts. Prefetches are speculative, blocks outside of the memory are dropped.
+ * @param address the address of the access
+ * @param miss if the access would have missed without prefetching
+ */
+void SetAssociativeCache::train_prefetcher(address_t address, bool miss) {
+    if (prefetcher_ == nullptr) {
+        return;
+    }
+
+    size_t address_space_size = next_level_data_storage_->get_address_space_size();
+
+    for (address_t prefetch_address :
+         prefetcher_->access(program_counter_, address, miss)) {
+        address_t block_address =
+            prefetch_address - get_address_offset(prefetch_address);
+        if (block_address >= address_space_size ||
+            address_space_size - block_address < cache_block_size_) {
+            continue;
+        }
+        prefetch_block(block_address);
+    }
+}
+
+/**
+ * @brief loads a block from the next level data storage without delaying the current
+ * access. Blocks which are already cached are skipped, in timed mode the prefetch is
+ * dropped if no MSHR is free.
+ * @param address the address of the block
+ */
+void SetAssociativeCache::prefetch_block(address_t address) {
+    AccessState& access = access_state();
+
+    address_t tag = get_address_tag(address);
+    address_t index = get_address_index(address);
+
+    if (cache_sets_[index]->get_block_index_with_tag(tag, generation_) != -1) {
+        return;
+    }
+
+    if (access.timed) {
+        retire_mshrs(access.access_cycle);
+        if (mshrs_ != 0 && mshr_entries_.size() >= mshrs_) {
+            count(&CacheStats::prefetches_dropped);
+            return;
+        }
+    }
+
+    // the prefetch is issued after the lookup of the access which triggered it
+    access.next_level_cycle = access.access_cycle + miss_latency_;
+
+    CoherenceTransaction coherence;
+    bool dirty = false;
+    auto next_level_dst = read_next_level_block(address, false, coherence, dirty);
+
+    int32_t block_index = cache_sets_[index]->get_free_block_index(generation_);
+
+    if (block_index == -1) {
+        block_index = cache_sets_[index]->get_replacement_index();
+        evict_block(index, block_index);
+    }
+
+    update_cache_block(index, block_index, tag, next_level_dst.data, true, dirty);
+    cache_sets_[index]->update_replacement_policy(block_index);
+
+    allocate_mshr(address,
+                  access.next_level_cycle + next_level_dst.latency + coherence.latency);
+    prefetched_blocks_.insert(address);
+    count(&CacheStats::prefetches_issued);
+
+    DEBUG_PRINT("> %s p @ 0x%016llx : i=%02lld / b=%04d - prefetched block\n",
+                name_.c_str(), address, index, block_index);
+}
+
 /**
  * @brief aligns a transaction to the cache block size
  * @param address the address to align
@@ -164,11 +1211,14 @@ std::map<address_t, Data> SetAssociativeCache::align_write_transaction(
 }
 
 DataStorageTransaction SetAssociativeCache::fill_data_from_next_level_data_storage(
-    Data& data, uint64_t address, size_t num_bytes) {
+    Data& data, uint64_t address, size_t num_bytes, CoherenceTransaction& coherence) {
     address_t offset = get_address_offset(address);
 
     // load data from next level data storage
-    auto next_level_dst = next_level_data_storage_->read(address - offset, num_bytes);
+    // the block is written, so it's dirty anyway
+    bool dirty = false;
+    auto next_level_dst =
+        read_next_level_block(address - offset, true, coherence, dirty);
     auto next_level_data = next_level_dst.data;
 
     Data fill_data = Data(num_bytes);
@@ -193,6 +1243,254 @@ DataStorageTransaction SetAssociativeCache::fill_data_from_next_level_data_stora
     return dst;
 }
 
+/**
+ * @brief updates a cache block in the current generation and keeps track of the sets
+ * which contain dirty blocks
+ * @param index the index of the cache set
+ * @param block_index the index of the block in the cache set
+ * @param tag the tag of the data
+ * @param data the data to store in the block
+ * @param valid the valid bit of the block
+ * @param dirty the dirty bit of the block
+ */
+void SetAssociativeCache::update_cache_block(address_t index, uint32_t block_index,
+                                             address_t tag, Data& data, bool valid,
+                                             bool dirty) {
+    uint64_t all_sectors = bitmask<uint64_t>(sectors_);
+    update_cache_block_sectors(index, block_index, tag, data, valid ? all_sectors : 0,
+                               dirty ? all_sectors : 0);
+}
+
+/**
+ * @brief updates a cache block and the valid and dirty bits of its sectors in the
+ * current generation and keeps track of the sets which contain dirty blocks
+ * @param valid_sectors bit i is set if sector i is valid
+ * @param dirty_sectors bit i is set if sector i is dirty
+ */
+void SetAssociativeCache::update_cache_block_sectors(address_t index,
+                                                     uint32_t block_index,
+                                                     address_t tag, Data& data,
+                                                     uint64_t valid_sectors,
+                                                     uint64_t dirty_sectors) {
+    uint32_t dirty_blocks_before = cache_sets_[index]->get_dirty_block_count();
+    cache_sets_[index]->update_block_sectors(block_index, tag, data, valid_sectors,
+                                             dirty_sectors, generation_);
+    update_dirty_sets(index, dirty_blocks_before);
+}
+
+/**
+ * @brief writes data into a part of a cache block without loading the rest of it, see
+ * CacheBlock::update_bytes
+ * @param offset the offset of the data in the block
+ */
+void SetAssociativeCache::update_cache_block_bytes(address_t index,
+                                                   uint32_t block_index, address_t tag,
+                                                   Data& data, address_t offset) {
+    uint32_t dirty_blocks_before = cache_sets_[index]->get_dirty_block_count();
+    cache_sets_[index]->update_block_bytes(block_index, tag, data, offset, generation_);
+    update_dirty_sets(index, dirty_blocks_before);
+}
+
+/**
+ * @brief keeps track of the dirty blocks and the sets which contain dirty blocks after
+ * a block of a set was updated
+ * @param dirty_blocks_before the number of dirty blocks of the set before the update
+ */
+void SetAssociativeCache::update_dirty_sets(address_t index,
+                                            uint32_t dirty_blocks_before) {
+    uint32_t dirty_blocks_after = cache_sets_[index]->get_dirty_block_count();
+
+    uint64_t dirty_set_bit = 1ull << (index % 64);
+
+    // in concurrent mode sets sharing the counter and the word of dirty_sets_ may be
+    // updated by other threads at the same time
+    if (concurrent_) {
+        if (dirty_blocks_after == dirty_blocks_before) {
+            return;
+        }
+
+        // the difference wraps modulo 2^64 if the count drops, so fetch_add subtracts
+        size_t difference =
+            static_cast<size_t>(dirty_blocks_after) - dirty_blocks_before;
+        std::atomic_ref<size_t>(dirty_blocks_).fetch_add(difference,
+                                                         std::memory_order_relaxed);
+
+        std::atomic_ref<uint64_t> dirty_sets_word(dirty_sets_[index / 64]);
+        if (dirty_blocks_after > 0) {
+            dirty_sets_word.fetch_or(dirty_set_bit, std::memory_order_relaxed);
+        } else {
+            dirty_sets_word.fetch_and(~dirty_set_bit, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    dirty_blocks_ = dirty_blocks_ + dirty_blocks_after - dirty_blocks_before;
+
+    if (dirty_blocks_after > 0) {
+        dirty_sets_[index / 64] |= dirty_set_bit;
+    } else {
+        dirty_sets_[index / 64] &= ~dirty_set_bit;
+    }
+}
+
+/**
+ * @brief returns the sectors which contain at least one byte of the range
+ * @param offset the offset of the range in the block
+ * @param num_bytes the size of the range, at least 1
+ */
+uint64_t SetAssociativeCache::get_sector_mask(address_t offset, size_t num_bytes) {
+    address_t first = offset >> sector_bits_;
+    address_t last = (offset + num_bytes - 1) >> sector_bits_;
+    return bitmask<uint64_t>(last - first + 1) << first;
+}
+
+/**
+ * @brief returns the sectors which are completely contained in the range
+ * @param offset the offset of the range in the block
+ * @param num_bytes the size of the range
+ */
+uint64_t SetAssociativeCache::get_covered_sector_mask(address_t offset,
+                                                      size_t num_bytes) {
+    address_t first = (offset + sector_size_ - 1) >> sector_bits_;
+    address_t end = (offset + num_bytes) >> sector_bits_;
+    if (end <= first) {
+        return 0;
+    }
+    return bitmask<uint64_t>(end - first) << first;
+}
+
+/**
+ * @brief reads sectors of a block from the next level data storage, each run of
+ * consecutive sectors is read with one access
+ * @param address the address of the block
+ * @param sectors the sectors to read
+ * @param data the data of the block, the read sectors are copied into it
+ * @param hit_level raised to the hit level of the reads on this level
+ * @return the summed up latency of the reads
+ */
+latency_t SetAssociativeCache::read_next_level_sectors(address_t address,
+                                                       uint64_t sectors, Data& data,
+                                                       int32_t& hit_level) {
+    latency_t latency = 0;
+
+    while (sectors != 0) {
+        uint32_t first = std::countr_zero(sectors);
+        uint32_t length = std::countr_one(sectors >> first);
+        sectors &= ~(bitmask<uint64_t>(length) << first);
+
+        address_t offset = first * sector_size_;
+        auto next_level_dst = read_next_level(address + offset, length * sector_size_);
+        for (size_t i = 0; i < length * sector_size_; i++) {
+            data[offset + i] = next_level_dst.data[i];
+        }
+
+        if (next_level_dst.hit_level + 1 > hit_level) {
+            hit_level = next_level_dst.hit_level + 1;
+        }
+        latency += next_level_dst.latency;
+    }
+
+    return latency;
+}
+
+/**
+ * @brief writes the dirty sectors of a block back to the next level data storage, each
+ * run of consecutive dirty sectors is written with one access. A block which was
+ * allocated by a write without fetch only writes back its valid bytes. The block itself
+ * isn't changed.
+ * @param hit_level raised to the hit level of the writes on this level
+ * @return the summed up latency of the writes
+ */
+latency_t SetAssociativeCache::write_back_block(address_t index, uint32_t block_index,
+                                                int32_t& hit_level) {
+    uint64_t dirty_sectors = cache_sets_[index]->get_block_dirty_sectors(block_index);
+    if (dirty_sectors == 0) {
+        return 0;
+    }
+
+    address_t tag = cache_sets_[index]->get_block_tag(block_index);
+    address_t address = get_address_from_index_and_tag(index, tag);
+    Data data = cache_sets_[index]->get_block_data(block_index);
+
+    latency_t latency = 0;
+
+    auto write_back_range = [&](address_t offset, size_t num_bytes) {
+        Data range_data = Data(num_bytes);
+        for (size_t i = 0; i < num_bytes; i++) {
+            range_data[i] = data[offset + i];
+        }
+
+        auto next_level_dst = write_next_level(address + offset, range_data);
+
+        if (next_level_dst.hit_level + 1 > hit_level) {
+            hit_level = next_level_dst.hit_level + 1;
+        }
+        latency += next_level_dst.latency;
+    };
+
+    if (!cache_sets_[index]->is_block_complete(block_index)) {
+        address_t offset = 0;
+        while (offset < cache_block_size_) {
+            if (!cache_sets_[index]->are_block_bytes_valid(block_index, offset, 1)) {
+                offset++;
+                continue;
+            }
+
+            address_t end = offset + 1;
+            while (end < cache_block_size_ &&
+                   cache_sets_[index]->are_block_bytes_valid(block_index, end, 1)) {
+                end++;
+            }
+
+            write_back_range(offset, end - offset);
+            offset = end;
+        }
+    } else {
+        while (dirty_sectors != 0) {
+            uint32_t first = std::countr_zero(dirty_sectors);
+            uint32_t length = std::countr_one(dirty_sectors >> first);
+            dirty_sectors &= ~(bitmask<uint64_t>(length) << first);
+
+            write_back_range(first * sector_size_, length * sector_size_);
+        }
+    }
+
+    count(&CacheStats::write_backs);
+    return latency;
+}
+
+/**
+ * @brief loads a block which was allocated by a write without fetch from the next
+ * level data storage, the bytes which weren't written are taken from it. The block
+ * becomes complete and stays dirty.
+ * @param address the address of the block
+ * @param coherence accumulates the coherence actions
+ * @return the read from the next level data storage with the merged block as data
+ */
+DataStorageTransaction SetAssociativeCache::fill_cache_block(
+    address_t index, uint32_t block_index, address_t address,
+    CoherenceTransaction& coherence) {
+    bool dirty = false;
+    auto next_level_dst = read_next_level_block(address, false, coherence, dirty);
+
+    Data block_data = cache_sets_[index]->get_block_data(block_index);
+    Data fill_data = next_level_dst.data;
+
+    for (size_t i = 0; i < cache_block_size_; i++) {
+        if (cache_sets_[index]->are_block_bytes_valid(block_index, i, 1)) {
+            fill_data[i] = block_data[i];
+        }
+    }
+
+    address_t tag = cache_sets_[index]->get_block_tag(block_index);
+    update_cache_block(index, block_index, tag, fill_data, true, true);
+    count(&CacheStats::deferred_fills);
+
+    DataStorageTransaction dst = {READ, address, next_level_dst.latency,
+                                  next_level_dst.hit_level, fill_data};
+    return dst;
+}
+
 /**
  * @brief write data to single cache block
  * @param address the address to write to
@@ -201,26 +1499,57 @@ DataStorageTransaction SetAssociativeCache::fill_data_from_next_level_data_stora
  */
 DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
                                                           Data& data) {
+    if (sectors_ > 1) {
+        return sectored_aligned_write(address, data);
+    }
+
+    AccessState& access = access_state();
+
     address_t offset = get_address_offset(address);
     address_t tag = get_address_tag(address);
     address_t index = get_address_index(address);
 
+    // the set stays locked until the next level data storage finished the access
+    auto set_lock = lock_set(index);
+
     bool written_back = false;
+    // if the block is fetched from the next level data storage in an MSHR
+    bool fetched = false;
+    bool prefetch_hit = false;
 
     int32_t hit_level = -1;
     latency_t latency = 0;
+    CoherenceTransaction coherence;
+
+    retire_mshrs(access.access_cycle);
 
     // check if target cache set already contains tag
-    int32_t block_index = cache_sets_[index]->get_block_index_with_tag(tag);
+    int32_t block_index =
+        cache_sets_[index]->get_block_index_with_tag(tag, generation_);
 
     // TODO: may be move to CacheSet in the future
     if (block_index != -1) {
         // block with tag found -> hit -> update block
         hit_level = 0;
-        latency = hit_latency_;
+        latency = merge_mshr(address - offset, hit_latency_);
+        access.next_level_cycle = access.access_cycle + hit_latency_;
+        count(&CacheStats::write_hits);
+        prefetch_hit = use_prefetched_block(address - offset, latency > hit_latency_);
+
+        request_write(address - offset, true, coherence);
 
         // check if its a partial write
-        if (data.size() != cache_block_size_) {
+        if (data.size() != cache_block_size_ && write_no_fetch_) {
+            // partial write, the block may not have been loaded yet
+            update_cache_block_bytes(index, block_index, tag, data, offset);
+            cache_sets_[index]->update_replacement_policy(block_index);
+
+            DEBUG_PRINT(
+                "> %s w @ 0x%016llx : d=%s / i=%02lld / b=%04d - partial write to "
+                "cached block without fetch\n",
+                name_.c_str(), address, data.to_string().c_str(), index, block_index);
+
+        } else if (data.size() != cache_block_size_) {
             // partial write
             Data update_data = Data(cache_block_size_);
             Data cache_block_data = cache_sets_[index]->get_block_data(block_index);
@@ -239,7 +1568,7 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
                 update_data[i] = cache_block_data[i];
             }
 
-            cache_sets_[index]->update_block(block_index, tag, update_data, true, true);
+            update_cache_block(index, block_index, tag, update_data, true, true);
             cache_sets_[index]->update_replacement_policy(block_index);
 
             DEBUG_PRINT(
@@ -250,7 +1579,7 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
 
         } else {
             // full write
-            cache_sets_[index]->update_block(block_index, tag, data, true, true);
+            update_cache_block(index, block_index, tag, data, true, true);
             cache_sets_[index]->update_replacement_policy(block_index);
 
             DEBUG_PRINT(
@@ -261,26 +1590,56 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
     } else {
         // block with tag not found -> miss
         latency = miss_latency_;
+        access.next_level_cycle = access.access_cycle + miss_latency_;
+
+        // full writes and writes which aren't allocated don't load the block, so a
+        // copy in the victim cache is dropped
+        if (!write_allocate_ || data.size() == cache_block_size_) {
+            latency += drop_victim_block(address - offset);
+        }
 
         if (write_allocate_) {
             // check if there is a free block
-            block_index = cache_sets_[index]->get_free_block_index();
+            block_index = cache_sets_[index]->get_free_block_index(generation_);
+
+            if (data.size() != cache_block_size_ && write_no_fetch_) {
+                // partial write without fetch, only the written bytes become valid
+                if (block_index == -1) {
+                    block_index = cache_sets_[index]->get_replacement_index();
+                    latency += evict_block(index, block_index);
+                }
+
+                update_cache_block_bytes(index, block_index, tag, data, offset);
+                cache_sets_[index]->update_replacement_policy(block_index);
+
+                // no other level is accessed
+                hit_level = -1;
+
+                DEBUG_PRINT(
+                    "> %s w @ 0x%016llx : d=%s / i=%02lld / b=%04d - partial write "
+                    "without fetch\n",
+                    name_.c_str(), address, data.to_string().c_str(), index,
+                    block_index);
 
-            if (block_index != -1) {
+            } else if (block_index != -1) {
                 // free block found -> miss -> write to block
                 // check if its a partial write
                 if (data.size() != cache_block_size_) {
                     // partial write
+                    latency += reserve_mshr();
+                    access.next_level_cycle = access.access_cycle + latency;
+                    fetched = true;
+
                     auto update_dst = fill_data_from_next_level_data_storage(
-                        data, address, cache_block_size_);
+                        data, address, cache_block_size_, coherence);
 
                     hit_level = update_dst.hit_level + 1;
                     latency += update_dst.latency;
 
                     Data update_data = update_dst.data;
 
-                    cache_sets_[index]->update_block(block_index, tag, update_data,
-                                                     true, true);
+                    update_cache_block(index, block_index, tag, update_data, true,
+                                       true);
                     cache_sets_[index]->update_replacement_policy(block_index);
 
                     DEBUG_PRINT(
@@ -292,8 +1651,8 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
 
                 } else {
                     // full write
-                    cache_sets_[index]->update_block(block_index, tag, data, true,
-                                                     true);
+                    request_write(address, true, coherence);
+                    update_cache_block(index, block_index, tag, data, true, true);
                     cache_sets_[index]->update_replacement_policy(block_index);
 
                     // no hit occured on any other level
@@ -309,34 +1668,27 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
                 // no free block found -> evict block
                 block_index = cache_sets_[index]->get_replacement_index();
 
-                // if block is valid and dirty write back to next level data storage
-                if (cache_sets_[index]->is_block_valid(block_index) &&
-                    cache_sets_[index]->is_block_dirty(block_index)) {
-                    Data write_back_data =
-                        cache_sets_[index]->get_block_data(block_index);
-                    address_t write_back_tag =
-                        cache_sets_[index]->get_block_tag(block_index);
-                    address_t write_back_address =
-                        get_address_from_index_and_tag(index, write_back_tag);
-                    auto write_back_dst = next_level_data_storage_->write(
-                        write_back_address, write_back_data);
-
-                    // if a write back occurs the latency from the write back
-                    // transaction needs to be added
-                    latency += write_back_dst.latency;
-                }
-
                 if (data.size() != cache_block_size_) {
                     // partial write
+                    latency += reserve_mshr();
+                    access.next_level_cycle = access.access_cycle + latency;
+                    fetched = true;
+
+                    // the block is loaded before the evicted block is moved to the
+                    // victim cache, so a hit in the victim cache frees an entry
                     auto update_dst = fill_data_from_next_level_data_storage(
-                        data, address, cache_block_size_);
+                        data, address, cache_block_size_, coherence);
                     Data update_data = update_dst.data;
 
+                    // if a write back occurs the latency from the write back
+                    // transaction needs to be added
+                    latency += evict_block(index, block_index);
+
                     hit_level = update_dst.hit_level + 1;
                     latency += update_dst.latency;
 
-                    cache_sets_[index]->update_block(block_index, tag, update_data,
-                                                     true, true);
+                    update_cache_block(index, block_index, tag, update_data, true,
+                                       true);
                     cache_sets_[index]->update_replacement_policy(block_index);
 
                     DEBUG_PRINT(
@@ -347,8 +1699,10 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
                         block_index);
 
                 } else {
-                    cache_sets_[index]->update_block(block_index, tag, data, true,
-                                                     true);
+                    latency += evict_block(index, block_index);
+
+                    request_write(address, true, coherence);
+                    update_cache_block(index, block_index, tag, data, true, true);
                     cache_sets_[index]->update_replacement_policy(block_index);
 
                     // no hit occured on any other level
@@ -363,7 +1717,8 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
             }
         } else {
             // write_allocate_ == false
-            auto write_back_dst = next_level_data_storage_->write(address, data);
+            request_write(address - offset, false, coherence);
+            auto write_back_dst = write_next_level(address, data);
             hit_level = write_back_dst.hit_level + 1;
 
             // if a write back occurs the latency from the write back transaction needs
@@ -377,10 +1732,14 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
                 "only no allocation\n",
                 name_.c_str(), address, data.to_string().c_str(), index);
         }
+
+        // a fetched block taken from the victim cache counts as hit on this level
+        count(fetched && hit_level == 0 ? &CacheStats::write_hits
+                                        : &CacheStats::write_misses);
     }
 
     if (write_through_ && !written_back) {
-        auto write_back_dst = next_level_data_storage_->write(address, data);
+        auto write_back_dst = write_next_level(address, data);
         // if a write back occurs the latency from the write back transaction needs to
         // be added
         latency += write_back_dst.latency;
@@ -391,7 +1750,18 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
             name_.c_str(), address, data.to_string().c_str(), index, block_index);
     }
 
+    latency += coherence.latency;
+
+    if (fetched) {
+        allocate_mshr(address - offset, access.access_cycle + latency);
+    }
+
+    train_prefetcher(address, hit_level != 0 || prefetch_hit);
+
     DataStorageTransaction dst = {WRITE, address, latency, hit_level, data};
+    dst.invalidations = coherence.invalidations;
+    dst.interventions = coherence.interventions;
+    dst.coherence_latency = coherence.latency;
 
     return dst;
 }
@@ -402,16 +1772,45 @@ DataStorageTransaction SetAssociativeCache::aligned_write(address_t address,
  * @param data the data to write
  */
 DataStorageTransaction SetAssociativeCache::write(address_t address, Data& data) {
+    AccessScope access_scope(this, AccessState());
+    return access_write(address, data);
+}
+
+/**
+ * @brief write data to cache in timed mode. The blocks of the access are issued in
+ * cycle, misses are tracked in MSHRs.
+ * @param cycle the cycle in which the access is issued
+ * @param address the address to write to
+ * @param data the data to write
+ * @return the transaction with the cycle in which the write completes
+ */
+DataStorageTransaction SetAssociativeCache::write_at(cycle_t cycle, address_t address,
+                                                     Data& data) {
+    AccessScope access_scope(this, {true, cycle, cycle});
+
+    auto dst = access_write(address, data);
+    dst.completion_cycle = cycle + dst.latency;
+    return dst;
+}
+
+DataStorageTransaction SetAssociativeCache::access_write(address_t address,
+                                                         Data& data) {
     std::map<address_t, Data> address_data_map = align_write_transaction(address, data);
 
     int32_t hit_level = -1;
+    std::vector<std::pair<address_t, size_t>> accesses;
     std::vector<latency_t> latencies;
+    CoherenceTransaction coherence;
 
     // itreate over address_data_map and execute and aligned_write
     for (auto& [addr, d] : address_data_map) {
         auto dst = aligned_write(addr, d);
 
+        accesses.push_back({addr, d.size()});
         latencies.push_back(dst.latency);
+        coherence.invalidations += dst.invalidations;
+        coherence.interventions += dst.interventions;
+        coherence.latency += dst.coherence_latency;
 
         // return the highest hit level from all reads
         if (dst.hit_level > hit_level) {
@@ -419,9 +1818,20 @@ DataStorageTransaction SetAssociativeCache::write(address_t address, Data& data)
         }
     }
 
-    latency_t latency = calculate_multi_block_access_latency(latencies);
+    // in timed mode all blocks are accessed in parallel
+    latency_t latency;
+    if (banks_ != nullptr) {
+        latency = calculate_banked_access_latency(accesses, latencies);
+    } else if (access_state().timed) {
+        latency = *std::max_element(latencies.begin(), latencies.end());
+    } else {
+        latency = calculate_multi_block_access_latency(latencies);
+    }
 
     DataStorageTransaction dst = {WRITE, address, latency, hit_level, data};
+    dst.invalidations = coherence.invalidations;
+    dst.interventions = coherence.interventions;
+    dst.coherence_latency = coherence.latency;
 
     return dst;
 }
@@ -475,23 +1885,64 @@ std::map<address_t, size_t> SetAssociativeCache::align_read_transaction(
 
 DataStorageTransaction SetAssociativeCache::aligned_read(address_t address,
                                                          size_t num_bytes) {
+    if (sectors_ > 1) {
+        return sectored_aligned_read(address, num_bytes);
+    }
+
+    AccessState& access = access_state();
+
     address_t offset = get_address_offset(address);
     address_t tag = get_address_tag(address);
     address_t index = get_address_index(address);
 
+    // the set stays locked until the next level data storage finished the access
+    auto set_lock = lock_set(index);
+
     int32_t hit_level = -1;
     latency_t latency = 0;
+    CoherenceTransaction coherence;
+    bool prefetch_hit = false;
 
     Data read_data = Data(num_bytes);
 
+    retire_mshrs(access.access_cycle);
+
     // check if target cache set already contains tag
-    int32_t block_index = cache_sets_[index]->get_block_index_with_tag(tag);
+    int32_t block_index =
+        cache_sets_[index]->get_block_index_with_tag(tag, generation_);
 
     // TODO: may be move to CacheSet in the future
-    if (block_index != -1) {
+    if (block_index != -1 && write_no_fetch_ &&
+        !cache_sets_[index]->are_block_bytes_valid(block_index, offset, num_bytes)) {
+        // block was allocated by a write without fetch -> miss -> load the rest of it
+        latency = miss_latency_;
+        count(&CacheStats::read_misses);
+
+        latency += reserve_mshr();
+        access.next_level_cycle = access.access_cycle + latency;
+
+        auto fill_dst =
+            fill_cache_block(index, block_index, address - offset, coherence);
+        hit_level = fill_dst.hit_level + 1;
+        latency += fill_dst.latency;
+
+        cache_sets_[index]->update_replacement_policy(block_index);
+
+        for (int i = 0; i < num_bytes; i++) {
+            read_data[i] = fill_dst.data[i + offset];
+        }
+
+        DEBUG_PRINT(
+            "> %s r @ 0x%016llx : d=%s / i=%02lld / b=%04d - read of block written "
+            "without fetch\n",
+            name_.c_str(), address, read_data.to_string().c_str(), index, block_index);
+
+    } else if (block_index != -1) {
         // block with tag found -> hit -> read block
         hit_level = 0;
-        latency = hit_latency_;
+        latency = merge_mshr(address - offset, hit_latency_);
+        count(&CacheStats::read_hits);
+        prefetch_hit = use_prefetched_block(address - offset, latency > hit_latency_);
 
         Data block_data = cache_sets_[index]->get_block_data(block_index);
         cache_sets_[index]->update_replacement_policy(block_index);
@@ -523,16 +1974,22 @@ DataStorageTransaction SetAssociativeCache::aligned_read(address_t address,
     } else {
         // block with tag not found -> miss -> read from next level storage
         // check if there is a free block
-        block_index = cache_sets_[index]->get_free_block_index();
+        block_index = cache_sets_[index]->get_free_block_index(generation_);
 
         latency = miss_latency_;
 
+        // in timed mode the miss may have to wait for a free MSHR
+        latency += reserve_mshr();
+        access.next_level_cycle = access.access_cycle + latency;
+
         address_t next_level_address = address - offset;
+        // blocks taken from the victim cache stay dirty
+        bool dirty = false;
 
         if (block_index != -1) {
             // free block found -> miss -> write to block
             auto next_level_storage_dst =
-                next_level_data_storage_->read(next_level_address, cache_block_size_);
+                read_next_level_block(next_level_address, false, coherence, dirty);
 
             Data next_level_storage_data = next_level_storage_dst.data;
             hit_level = next_level_storage_dst.hit_level + 1;
@@ -542,8 +1999,8 @@ DataStorageTransaction SetAssociativeCache::aligned_read(address_t address,
                 read_data[i] = next_level_storage_data[i + offset];
             }
 
-            cache_sets_[index]->update_block(block_index, tag, next_level_storage_data,
-                                             true, false);
+            update_cache_block(index, block_index, tag, next_level_storage_data, true,
+                               dirty);
             cache_sets_[index]->update_replacement_policy(block_index);
 
 #if DEBUG
@@ -569,22 +2026,13 @@ DataStorageTransaction SetAssociativeCache::aligned_read(address_t address,
             // block
             block_index = cache_sets_[index]->get_replacement_index();
 
-            // if block is valid and dirty write back to next level data storage
-            if (cache_sets_[index]->is_block_valid(block_index) &&
-                cache_sets_[index]->is_block_dirty(block_index)) {
-                Data write_back_data = cache_sets_[index]->get_block_data(block_index);
-                address_t write_back_tag =
-                    cache_sets_[index]->get_block_tag(block_index);
-                address_t write_back_address =
-                    get_address_from_index_and_tag(index, write_back_tag);
-                auto next_level_storage_dst = next_level_data_storage_->write(
-                    write_back_address, write_back_data);
-
-                latency += next_level_storage_dst.latency;
-            }
-
+            // the block is read before the evicted block is moved to the victim cache,
+            // so a hit in the victim cache frees an entry
             auto next_level_storage_dst =
-                next_level_data_storage_->read(next_level_address, cache_block_size_);
+                read_next_level_block(next_level_address, false, coherence, dirty);
+
+            // if block is valid and dirty write back to next level data storage
+            latency += evict_block(index, block_index);
 
             Data next_level_storage_data = next_level_storage_dst.data;
             hit_level = next_level_storage_dst.hit_level + 1;
@@ -594,8 +2042,8 @@ DataStorageTransaction SetAssociativeCache::aligned_read(address_t address,
                 read_data[i] = next_level_storage_data[i + offset];
             }
 
-            cache_sets_[index]->update_block(block_index, tag, next_level_storage_data,
-                                             true, false);
+            update_cache_block(index, block_index, tag, next_level_storage_data, true,
+                               dirty);
             cache_sets_[index]->update_replacement_policy(block_index);
 
 #if DEBUG
@@ -616,10 +2064,276 @@ DataStorageTransaction SetAssociativeCache::aligned_read(address_t address,
             }
 #endif
         }
+
+        // a block taken from the victim cache counts as hit on this level
+        count(hit_level == 0 ? &CacheStats::read_hits : &CacheStats::read_misses);
     }
 
+    latency += coherence.latency;
+
+    if (hit_level != 0) {
+        allocate_mshr(address - offset, access.access_cycle + latency);
+    }
+
+    train_prefetcher(address, hit_level != 0 || prefetch_hit);
+
     DataStorageTransaction dst = {READ, address, latency, hit_level, read_data};
+    dst.invalidations = coherence.invalidations;
+    dst.interventions = coherence.interventions;
+    dst.coherence_latency = coherence.latency;
+
+    return dst;
+}
+
+/**
+ * @brief writes data to a single block of a sectored cache. Only the partially written
+ * sectors which aren't valid are loaded from the next level data storage, the written
+ * sectors become valid and dirty.
+ * @param address the address to write to
+ * @param data the data to write
+ * @return the transaction result
+ */
+DataStorageTransaction SetAssociativeCache::sectored_aligned_write(address_t address,
+                                                                   Data& data) {
+    AccessState& access = access_state();
+
+    address_t offset = get_address_offset(address);
+    address_t tag = get_address_tag(address);
+    address_t index = get_address_index(address);
+    address_t block_address = address - offset;
+
+    auto set_lock = lock_set(index);
+
+    bool written_back = false;
+    bool fetched = false;
+    bool prefetch_hit = false;
+
+    int32_t hit_level = -1;
+    latency_t latency = 0;
+
+    retire_mshrs(access.access_cycle);
+
+    uint64_t accessed_sectors = get_sector_mask(offset, data.size());
+    uint64_t covered_sectors = get_covered_sector_mask(offset, data.size());
+
+    int32_t block_index =
+        cache_sets_[index]->get_block_index_with_tag(tag, generation_);
+
+    uint64_t valid_sectors = 0;
+    uint64_t dirty_sectors = 0;
+    if (block_index != -1) {
+        valid_sectors = cache_sets_[index]->get_block_valid_sectors(block_index);
+        dirty_sectors = cache_sets_[index]->get_block_dirty_sectors(block_index);
+    }
+
+    // partially written sectors have to be loaded unless they are valid already
+    uint64_t missing_sectors = accessed_sectors & ~covered_sectors & ~valid_sectors;
+
+    if (block_index != -1 && missing_sectors == 0) {
+        // all sectors which have to be valid are -> hit
+        hit_level = 0;
+        latency = merge_mshr(block_address, hit_latency_);
+        access.next_level_cycle = access.access_cycle + hit_latency_;
+        count(&CacheStats::write_hits);
+        prefetch_hit = use_prefetched_block(block_address, latency > hit_latency_);
+
+        Data block_data = cache_sets_[index]->get_block_data(block_index);
+        for (size_t i = 0; i < data.size(); i++) {
+            block_data[offset + i] = data[i];
+        }
+
+        update_cache_block_sectors(index, block_index, tag, block_data,
+                                   valid_sectors | accessed_sectors,
+                                   dirty_sectors | accessed_sectors);
+        cache_sets_[index]->update_replacement_policy(block_index);
+
+        DEBUG_PRINT("> %s w @ 0x%016llx : d=%s / i=%02lld / b=%04d - write to valid "
+                    "sectors\n",
+                    name_.c_str(), address, data.to_string().c_str(), index,
+                    block_index);
+    } else {
+        latency = miss_latency_;
+        access.next_level_cycle = access.access_cycle + miss_latency_;
+        count(&CacheStats::write_misses);
+
+        if (block_index != -1) {
+            count(&CacheStats::sector_misses);
+        }
+
+        if (block_index == -1 && !write_allocate_) {
+            auto write_back_dst = write_next_level(address, data);
+            hit_level = write_back_dst.hit_level + 1;
+            latency += write_back_dst.latency;
+
+            written_back = true;
+
+            DEBUG_PRINT(
+                "> %s w @ 0x%016llx : d=%s / i=%02lld - block not cached, write back "
+                "only no allocation\n",
+                name_.c_str(), address, data.to_string().c_str(), index);
+        } else {
+            Data block_data = block_index != -1
+                                  ? cache_sets_[index]->get_block_data(block_index)
+                                  : Data(cache_block_size_);
+
+            if (missing_sectors != 0) {
+                latency += reserve_mshr();
+                access.next_level_cycle = access.access_cycle + latency;
+                fetched = true;
+
+                latency += read_next_level_sectors(block_address, missing_sectors,
+                                                   block_data, hit_level);
+            }
+
+            if (block_index == -1) {
+                block_index = cache_sets_[index]->get_free_block_index(generation_);
+
+                if (block_index == -1) {
+                    block_index = cache_sets_[index]->get_replacement_index();
+                    latency += evict_block(index, block_index);
+                }
+            }
+
+            for (size_t i = 0; i < data.size(); i++) {
+                block_data[offset + i] = data[i];
+            }
+
+            update_cache_block_sectors(
+                index, block_index, tag, block_data,
+                valid_sectors | missing_sectors | accessed_sectors,
+                dirty_sectors | accessed_sectors);
+            cache_sets_[index]->update_replacement_policy(block_index);
+
+            DEBUG_PRINT(
+                "> %s w @ 0x%016llx : d=%s / i=%02lld / b=%04d - write with missing "
+                "sectors 0x%016llx\n",
+                name_.c_str(), address, data.to_string().c_str(), index, block_index,
+                missing_sectors);
+        }
+    }
+
+    if (write_through_ && !written_back) {
+        auto write_back_dst = write_next_level(address, data);
+        latency += write_back_dst.latency;
+    }
+
+    if (fetched) {
+        allocate_mshr(block_address, access.access_cycle + latency);
+    }
+
+    train_prefetcher(address, hit_level != 0 || prefetch_hit);
+
+    DataStorageTransaction dst = {WRITE, address, latency, hit_level, data};
+    return dst;
+}
+
+/**
+ * @brief reads data from a single block of a sectored cache. An access to a cached
+ * block with sectors which aren't valid is a miss, only these sectors are loaded from
+ * the next level data storage.
+ * @param address the address to read from
+ * @param num_bytes the number of bytes to read
+ * @return the transaction result
+ */
+DataStorageTransaction SetAssociativeCache::sectored_aligned_read(address_t address,
+                                                                  size_t num_bytes) {
+    AccessState& access = access_state();
+
+    address_t offset = get_address_offset(address);
+    address_t tag = get_address_tag(address);
+    address_t index = get_address_index(address);
+    address_t block_address = address - offset;
+
+    auto set_lock = lock_set(index);
+
+    int32_t hit_level = -1;
+    latency_t latency = 0;
+    bool prefetch_hit = false;
+
+    Data read_data = Data(num_bytes);
+
+    retire_mshrs(access.access_cycle);
+
+    uint64_t accessed_sectors = get_sector_mask(offset, num_bytes);
+
+    int32_t block_index =
+        cache_sets_[index]->get_block_index_with_tag(tag, generation_);
+
+    uint64_t valid_sectors = 0;
+    uint64_t dirty_sectors = 0;
+    if (block_index != -1) {
+        valid_sectors = cache_sets_[index]->get_block_valid_sectors(block_index);
+        dirty_sectors = cache_sets_[index]->get_block_dirty_sectors(block_index);
+    }
+
+    uint64_t missing_sectors = accessed_sectors & ~valid_sectors;
+
+    if (block_index != -1 && missing_sectors == 0) {
+        // all accessed sectors are valid -> hit
+        hit_level = 0;
+        latency = merge_mshr(block_address, hit_latency_);
+        count(&CacheStats::read_hits);
+        prefetch_hit = use_prefetched_block(block_address, latency > hit_latency_);
+
+        Data block_data = cache_sets_[index]->get_block_data(block_index);
+        cache_sets_[index]->update_replacement_policy(block_index);
+
+        for (size_t i = 0; i < num_bytes; i++) {
+            read_data[i] = block_data[i + offset];
+        }
+
+        DEBUG_PRINT("> %s r @ 0x%016llx : d=%s / i=%02lld / b=%04d - read of valid "
+                    "sectors\n",
+                    name_.c_str(), address, read_data.to_string().c_str(), index,
+                    block_index);
+    } else {
+        latency = miss_latency_;
+        count(&CacheStats::read_misses);
+
+        if (block_index != -1) {
+            count(&CacheStats::sector_misses);
+        }
+
+        latency += reserve_mshr();
+        access.next_level_cycle = access.access_cycle + latency;
+
+        Data block_data = block_index != -1
+                              ? cache_sets_[index]->get_block_data(block_index)
+                              : Data(cache_block_size_);
+        latency += read_next_level_sectors(block_address, missing_sectors, block_data,
+                                           hit_level);
+
+        if (block_index == -1) {
+            block_index = cache_sets_[index]->get_free_block_index(generation_);
+
+            if (block_index == -1) {
+                block_index = cache_sets_[index]->get_replacement_index();
+                latency += evict_block(index, block_index);
+            }
+        }
+
+        for (size_t i = 0; i < num_bytes; i++) {
+            read_data[i] = block_data[i + offset];
+        }
+
+        update_cache_block_sectors(index, block_index, tag, block_data,
+                                   valid_sectors | missing_sectors, dirty_sectors);
+        cache_sets_[index]->update_replacement_policy(block_index);
 
+        DEBUG_PRINT(
+            "> %s r @ 0x%016llx : d=%s / i=%02lld / b=%04d - read with missing "
+            "sectors 0x%016llx\n",
+            name_.c_str(), address, read_data.to_string().c_str(), index, block_index,
+            missing_sectors);
+    }
+
+    if (hit_level != 0) {
+        allocate_mshr(block_address, access.access_cycle + latency);
+    }
+
+    train_prefetcher(address, hit_level != 0 || prefetch_hit);
+
+    DataStorageTransaction dst = {READ, address, latency, hit_level, read_data};
     return dst;
 }
 
@@ -630,6 +2344,29 @@ DataStorageTransaction SetAssociativeCache::aligned_read(address_t address,
  * @return bytes read from cache
  */
 DataStorageTransaction SetAssociativeCache::read(address_t address, size_t num_bytes) {
+    AccessScope access_scope(this, AccessState());
+    return access_read(address, num_bytes);
+}
+
+/**
+ * @brief read data from cache in timed mode. The blocks of the access are issued in
+ * cycle, misses are tracked in MSHRs.
+ * @param cycle the cycle in which the access is issued
+ * @param address the address to read from
+ * @param num_bytes the number of bytes to read
+ * @return the transaction with the cycle in which the read completes
+ */
+DataStorageTransaction SetAssociativeCache::read_at(cycle_t cycle, address_t address,
+                                                    size_t num_bytes) {
+    AccessScope access_scope(this, {true, cycle, cycle});
+
+    auto dst = access_read(address, num_bytes);
+    dst.completion_cycle = cycle + dst.latency;
+    return dst;
+}
+
+DataStorageTransaction SetAssociativeCache::access_read(address_t address,
+                                                        size_t num_bytes) {
     Data read_data = Data(num_bytes);
 
     std::map<address_t, size_t> address_size_map =
@@ -637,7 +2374,9 @@ DataStorageTransaction SetAssociativeCache::read(address_t address, size_t num_b
 
     int data_index = 0;
     int32_t hit_level = -1;
+    std::vector<std::pair<address_t, size_t>> accesses;
     std::vector<latency_t> latencies;
+    CoherenceTransaction coherence;
 
     for (auto& [addr, size] : address_size_map) {
         auto dst = aligned_read(addr, size);
@@ -646,7 +2385,11 @@ DataStorageTransaction SetAssociativeCache::read(address_t address, size_t num_b
             read_data[data_index++] = dst.data[i];
         }
 
+        accesses.push_back({addr, size});
         latencies.push_back(dst.latency);
+        coherence.invalidations += dst.invalidations;
+        coherence.interventions += dst.interventions;
+        coherence.latency += dst.coherence_latency;
 
         // return the highest hit level from all reads
         if (dst.hit_level > hit_level) {
@@ -654,9 +2397,20 @@ DataStorageTransaction SetAssociativeCache::read(address_t address, size_t num_b
         }
     }
 
-    latency_t latency = calculate_multi_block_access_latency(latencies);
+    // in timed mode all blocks are accessed in parallel
+    latency_t latency;
+    if (banks_ != nullptr) {
+        latency = calculate_banked_access_latency(accesses, latencies);
+    } else if (access_state().timed) {
+        latency = *std::max_element(latencies.begin(), latencies.end());
+    } else {
+        latency = calculate_multi_block_access_latency(latencies);
+    }
 
     DataStorageTransaction dst = {READ, address, latency, hit_level, read_data};
+    dst.invalidations = coherence.invalidations;
+    dst.interventions = coherence.interventions;
+    dst.coherence_latency = coherence.latency;
     return dst;
 }
 
@@ -671,7 +2425,8 @@ bool SetAssociativeCache::is_address_cached(address_t address) {
     address_t index = get_address_index(address);
 
     // check if target cache set contains  with tag
-    int32_t block_index = cache_sets_[index]->get_block_index_with_tag(tag);
+    int32_t block_index =
+        cache_sets_[index]->get_block_index_with_tag(tag, generation_);
 
     return (block_index != -1);
 }
@@ -681,13 +2436,21 @@ bool SetAssociativeCache::is_address_valid(address_t address) {
     address_t index = get_address_index(address);
 
     // check if target cache set contains  with tag
-    int32_t block_index = cache_sets_[index]->get_block_index_with_tag(tag);
+    int32_t block_index =
+        cache_sets_[index]->get_block_index_with_tag(tag, generation_);
 
     if (block_index == -1) {
         return false;
     }
 
-    return cache_sets_[index]->is_block_valid(block_index);
+    // in a sectored cache the sector of the address has to be valid, without fetch on
+    // write the byte itself
+    address_t offset = get_address_offset(address);
+    uint64_t sector_bit = 1ull << (offset >> sector_bits_);
+    bool sector_valid =
+        (cache_sets_[index]->get_block_valid_sectors(block_index) & sector_bit) != 0;
+    return sector_valid &&
+           cache_sets_[index]->are_block_bytes_valid(block_index, offset, 1);
 }
 
 bool SetAssociativeCache::is_address_dirty(address_t address) {
@@ -695,13 +2458,15 @@ bool SetAssociativeCache::is_address_dirty(address_t address) {
     address_t index = get_address_index(address);
 
     // check if target cache set contains  with tag
-    int32_t block_index = cache_sets_[index]->get_block_index_with_tag(tag);
+    int32_t block_index =
+        cache_sets_[index]->get_block_index_with_tag(tag, generation_);
 
     if (block_index == -1) {
         return false;
     }
 
-    return cache_sets_[index]->is_block_dirty(block_index);
+    uint64_t sector_bit = 1ull << (get_address_offset(address) >> sector_bits_);
+    return (cache_sets_[index]->get_block_dirty_sectors(block_index) & sector_bit) != 0;
 }
 
 /**
@@ -716,7 +2481,8 @@ uint8_t SetAssociativeCache::get(uint64_t address) {
     address_t index = get_address_index(address);
 
     // check if target cache set contains  with tag
-    int32_t block_index = cache_sets_[index]->get_block_index_with_tag(tag);
+    int32_t block_index =
+        cache_sets_[index]->get_block_index_with_tag(tag, generation_);
 
     if (block_index != -1) {
         Data cache_block_data = cache_sets_[index]->get_block_data(block_index);
@@ -758,7 +2524,7 @@ address_t SetAssociativeCache::get_cache_block_tag(address_t cache_set_index,
  */
 bool SetAssociativeCache::is_cache_block_valid(address_t cache_set_index,
                                                address_t block_index) {
-    return cache_sets_[cache_set_index]->is_block_valid(block_index);
+    return cache_sets_[cache_set_index]->is_block_valid(block_index, generation_);
 }
 
 /**
@@ -774,34 +2540,65 @@ bool SetAssociativeCache::is_cache_block_dirty(address_t cache_set_index,
 }
 
 /**
- * @brief flush the whole cache, if blocks are dirty they are written back to the next
- * level data storage
+ * @brief returns the number of valid and dirty blocks in the cache. This is tracked on
+ * every update and therefore cheap to call.
+ * @return the number of dirty blocks
  */
+size_t SetAssociativeCache::get_dirty_block_count() { return dirty_blocks_; }
 
+/**
+ * @brief flush the whole cache, if blocks are dirty they are written back to the next
+ * level data storage. Only sets which contain dirty blocks are visited.
+ */
 DataStorageTransaction SetAssociativeCache::flush() {
     // if nothing needs to be written back to the next leve data storage everything is
     // considered a hit
     int32_t hit_level = 0;
     latency_t latency = 0;
 
-    for (int i = 0; i < sets_; i++) {
-        for (int j = 0; j < ways_; j++) {
-            if (cache_sets_[i]->is_block_dirty(j) &&
-                cache_sets_[i]->is_block_valid(j)) {
-                auto tag = cache_sets_[i]->get_block_tag(j);
-                auto data = cache_sets_[i]->get_block_data(j);
+    for (size_t i = 0; i < dirty_sets_.size(); i++) {
+        uint64_t dirty_sets_word = dirty_sets_[i];
+
+        while (dirty_sets_word != 0) {
+            address_t index = i * 64 + std::countr_zero(dirty_sets_word);
+            dirty_sets_word &= dirty_sets_word - 1;
 
-                address_t address = get_address_from_index_and_tag(i, tag);
+            const auto& dirty_mask = cache_sets_[index]->get_dirty_mask();
 
-                auto next_level_dst = next_level_data_storage_->write(address, data);
+            for (size_t j = 0; j < dirty_mask.size(); j++) {
+                uint64_t dirty_mask_word = dirty_mask[j];
 
-                if (next_level_dst.hit_level + 1 > hit_level) {
-                    hit_level = next_level_dst.hit_level + 1;
+                while (dirty_mask_word != 0) {
+                    uint32_t block_index = j * 64 + std::countr_zero(dirty_mask_word);
+                    dirty_mask_word &= dirty_mask_word - 1;
+
+                    latency += write_back_block(index, block_index, hit_level);
                 }
-                latency += next_level_dst.latency;
             }
         }
     }
+
+    if (victim_cache_ != nullptr) {
+        for (auto& entry : victim_cache_->get_entry_list()) {
+            if (!entry.dirty) {
+                continue;
+            }
+
+            Data data = entry.data;
+            auto next_level_dst = write_next_level(entry.address, data);
+            count(&CacheStats::write_backs);
+
+            if (next_level_dst.hit_level + 1 > hit_level) {
+                hit_level = next_level_dst.hit_level + 1;
+            }
+            latency += next_level_dst.latency;
+        }
+    }
+
+    if (write_buffer_ != nullptr) {
+        latency += drain_write_buffer();
+    }
+
     reset();
 
     Data data = Data(0);
@@ -811,15 +2608,53 @@ DataStorageTransaction SetAssociativeCache::flush() {
 }
 
 /**
- * @brief reset the whole cache
+ * @brief reset the whole cache by switching to a new generation, which invalidates all
+ * blocks at once. Only if the generation counter wraps around all blocks are
+ * invalidated one by one.
  */
 void SetAssociativeCache::reset() {
-    cache_sets_.clear();
-    cache_sets_.reserve(sets_);
+    generation_++;
 
-    for (int i = 0; i < sets_; i++) {
-        cache_sets_.push_back(std::unique_ptr<CacheSet>(
-            new CacheSet(cache_block_size_, ways_, replacement_policy_type_)));
+    if (prefetcher_ != nullptr) {
+        prefetcher_->reset();
+        prefetched_blocks_.clear();
+    }
+
+    if (victim_cache_ != nullptr) {
+        victim_cache_->reset();
+    }
+
+    if (write_buffer_ != nullptr) {
+        write_buffer_->reset();
+    }
+
+    if (banks_ != nullptr) {
+        banks_->reset();
+    }
+
+    if (coherence_directory_ != nullptr) {
+        coherence_directory_->evict_all(coherence_id_);
+    }
+
+    // only the sets which contain dirty blocks need their dirty masks cleared
+    if (dirty_blocks_ > 0) {
+        for (size_t i = 0; i < dirty_sets_.size(); i++) {
+            uint64_t dirty_sets_word = dirty_sets_[i];
+
+            while (dirty_sets_word != 0) {
+                address_t index = i * 64 + std::countr_zero(dirty_sets_word);
+                dirty_sets_word &= dirty_sets_word - 1;
+                cache_sets_[index]->clear_dirty_mask();
+            }
+            dirty_sets_[i] = 0;
+        }
+        dirty_blocks_ = 0;
+    }
+
+    if (generation_ == 0) {
+        for (auto& cache_set : cache_sets_) {
+            cache_set->reset();
+        }
     }
 }
 }  // namespace kachesim
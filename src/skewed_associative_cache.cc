@@ -0,0 +1,477 @@
+#include "kachesim/skewed_associative_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+SkewedAssociativeCache::SkewedAssociativeCache(
+    const std::string& name, std::shared_ptr<DataStorage> next_level_data_storage,
+    bool write_allocate, bool write_through, latency_t miss_latency,
+    latency_t hit_latency, size_t cache_block_size, size_t sets, size_t ways,
+    SkewedReplacementPolicyType replacement_policy_type)
+    : name_(name),
+      next_level_data_storage_(next_level_data_storage),
+      write_allocate_(write_allocate),
+      write_through_(write_through),
+      miss_latency_(miss_latency),
+      hit_latency_(hit_latency),
+      cache_block_size_(cache_block_size),
+      sets_(sets),
+      ways_(ways),
+      replacement_policy_type_(replacement_policy_type) {
+    if (sets_ == 0 || ways_ == 0) {
+        THROW_INVALID_ARGUMENT("skewed associative cache without sets or ways");
+    }
+
+    if (cache_block_size_ == 0 || (cache_block_size_ & (cache_block_size_ - 1)) != 0) {
+        THROW_INVALID_ARGUMENT("cache block size is not a power of two");
+    }
+
+    offset_bits_ = clog2(cache_block_size_);
+
+    index_functions_.reserve(ways_);
+    for (size_t way = 0; way < ways_; way++) {
+        index_functions_.push_back(IndexFunction(SKEWED_INDEX, sets_, way));
+    }
+
+    size_t blocks = sets_ * ways_;
+    data_ = std::vector<uint8_t>(blocks * cache_block_size_, 0);
+    tags_ = std::vector<address_t>(blocks, 0);
+    valid_ = std::vector<bool>(blocks, false);
+    dirty_ = std::vector<bool>(blocks, false);
+    last_access_ = std::vector<uint64_t>(blocks, 0);
+    recently_used_ = std::vector<bool>(blocks, false);
+}
+
+/**
+ * @brief creates an independent copy of the cache with the same blocks and
+ * replacement state
+ * @param next_level_data_storage the data storage the copy forwards misses to
+ * @return the copy of the cache
+ */
+std::shared_ptr<CacheInterface> SkewedAssociativeCache::clone(
+    std::shared_ptr<DataStorage> next_level_data_storage) {
+    auto cache = std::make_shared<SkewedAssociativeCache>(
+        name_, next_level_data_storage, write_allocate_, write_through_, miss_latency_,
+        hit_latency_, cache_block_size_, sets_, ways_, replacement_policy_type_);
+
+    cache->data_ = data_;
+    cache->tags_ = tags_;
+    cache->valid_ = valid_;
+    cache->dirty_ = dirty_;
+    cache->valid_blocks_ = valid_blocks_;
+    cache->dirty_blocks_ = dirty_blocks_;
+    cache->last_access_ = last_access_;
+    cache->access_counter_ = access_counter_;
+    cache->recently_used_ = recently_used_;
+    cache->next_way_ = next_way_;
+    cache->stats_ = stats_;
+
+    return cache;
+}
+
+std::string SkewedAssociativeCache::get_name() { return name_; }
+
+/**
+ * @brief Returns the size of the cache in bytes
+ */
+size_t SkewedAssociativeCache::size() { return sets_ * ways_ * cache_block_size_; }
+
+size_t SkewedAssociativeCache::get_address_space_size() {
+    return next_level_data_storage_->get_address_space_size();
+}
+
+latency_t SkewedAssociativeCache::get_hit_latency() { return hit_latency_; }
+
+latency_t SkewedAssociativeCache::get_miss_latency() { return miss_latency_; }
+
+void SkewedAssociativeCache::set_hit_latency(latency_t hit_latency) {
+    hit_latency_ = hit_latency;
+}
+
+void SkewedAssociativeCache::set_miss_latency(latency_t miss_latency) {
+    miss_latency_ = miss_latency;
+}
+
+size_t SkewedAssociativeCache::get_sets() { return sets_; }
+
+size_t SkewedAssociativeCache::get_ways() { return ways_; }
+
+SkewedReplacementPolicyType SkewedAssociativeCache::get_replacement_policy_type() {
+    return replacement_policy_type_;
+}
+
+/**
+ * @brief returns the number of blocks which hold data
+ */
+size_t SkewedAssociativeCache::get_valid_block_count() { return valid_blocks_; }
+
+CacheStats SkewedAssociativeCache::get_stats() { return stats_; }
+
+void SkewedAssociativeCache::reset_stats() { stats_ = CacheStats(); }
+
+/**
+ * @brief enables or disables concurrent accesses, in concurrent mode every access
+ * locks the whole cache
+ */
+void SkewedAssociativeCache::set_concurrent(bool concurrent) {
+    concurrent_ = concurrent;
+}
+
+std::unique_lock<std::mutex> SkewedAssociativeCache::lock() {
+    if (!concurrent_) {
+        return std::unique_lock<std::mutex>();
+    }
+    return std::unique_lock<std::mutex>(mutex_);
+}
+
+/**
+ * @brief returns the block of a way in which a block address can be stored
+ */
+inline size_t SkewedAssociativeCache::get_block(size_t way, address_t block_address) {
+    return way * sets_ + index_functions_[way].index(block_address);
+}
+
+/**
+ * @brief looks up the block holding a block address in all ways
+ * @return the block or no_block_ if the block address isn't cached
+ */
+size_t SkewedAssociativeCache::find_block(address_t block_address) {
+    // the tag doesn't depend on the skew, all ways share it
+    address_t tag = index_functions_[0].tag(block_address);
+
+    for (size_t way = 0; way < ways_; way++) {
+        size_t block = get_block(way, block_address);
+        if (valid_[block] && tags_[block] == tag) {
+            return block;
+        }
+    }
+
+    return no_block_;
+}
+
+/**
+ * @brief restores the block address of a valid block from its set and tag
+ */
+address_t SkewedAssociativeCache::get_block_address(size_t block) {
+    size_t way = block / sets_;
+    return index_functions_[way].block_address(block % sets_, tags_[block]);
+}
+
+void SkewedAssociativeCache::touch_block(size_t block) {
+    last_access_[block] = ++access_counter_;
+    recently_used_[block] = true;
+}
+
+/**
+ * @brief selects the block a block address replaces, a free candidate is preferred
+ */
+size_t SkewedAssociativeCache::get_replacement_block(address_t block_address) {
+    for (size_t way = 0; way < ways_; way++) {
+        size_t block = get_block(way, block_address);
+        if (!valid_[block]) {
+            return block;
+        }
+    }
+
+    if (replacement_policy_type_ == SKEWED_LRU) {
+        size_t replacement_block = get_block(0, block_address);
+
+        for (size_t way = 1; way < ways_; way++) {
+            size_t block = get_block(way, block_address);
+            if (last_access_[block] < last_access_[replacement_block]) {
+                replacement_block = block;
+            }
+        }
+
+        return replacement_block;
+    }
+
+    size_t first_way = next_way_;
+    next_way_ = (next_way_ + 1) % ways_;
+
+    for (size_t i = 0; i < ways_; i++) {
+        size_t block = get_block((first_way + i) % ways_, block_address);
+        if (!recently_used_[block]) {
+            return block;
+        }
+    }
+
+    for (size_t way = 0; way < ways_; way++) {
+        recently_used_[get_block(way, block_address)] = false;
+    }
+
+    return get_block(first_way, block_address);
+}
+
+/**
+ * @brief takes a free candidate block for a block address or replaces one, a dirty
+ * block is written back to the next level data storage
+ * @param block_address the block address of the new block
+ * @param latency the latency of the write back is added to it
+ * @return the block
+ */
+size_t SkewedAssociativeCache::allocate_block(address_t block_address,
+                                              latency_t& latency) {
+    size_t block = get_replacement_block(block_address);
+
+    if (valid_[block] && dirty_[block]) {
+        Data write_back_data =
+            Data(&data_[block * cache_block_size_], cache_block_size_);
+        auto write_back_dst = next_level_data_storage_->write(
+            get_block_address(block) << offset_bits_, write_back_data);
+        stats_.write_backs++;
+        latency += write_back_dst.latency;
+
+        dirty_[block] = false;
+        dirty_blocks_--;
+    }
+
+    if (!valid_[block]) {
+        valid_[block] = true;
+        valid_blocks_++;
+    }
+
+    tags_[block] = index_functions_[0].tag(block_address);
+    touch_block(block);
+
+    return block;
+}
+
+DataStorageTransaction SkewedAssociativeCache::aligned_read(address_t address,
+                                                            size_t num_bytes) {
+    address_t block_address = address >> offset_bits_;
+    address_t offset = address & (cache_block_size_ - 1);
+
+    int32_t hit_level;
+    latency_t latency;
+
+    size_t block = find_block(block_address);
+
+    if (block != no_block_) {
+        hit_level = 0;
+        latency = hit_latency_;
+        stats_.read_hits++;
+        touch_block(block);
+    } else {
+        latency = miss_latency_;
+        stats_.read_misses++;
+
+        auto next_level_dst =
+            next_level_data_storage_->read(address - offset, cache_block_size_);
+        hit_level = next_level_dst.hit_level + 1;
+        latency += next_level_dst.latency;
+
+        block = allocate_block(block_address, latency);
+        std::memcpy(&data_[block * cache_block_size_], next_level_dst.data.data(),
+                    cache_block_size_);
+    }
+
+    Data read_data = Data(&data_[block * cache_block_size_ + offset], num_bytes);
+
+    DEBUG_PRINT("> %s r @ 0x%016llx : d=%s / b=%04zu - %s\n", name_.c_str(),
+                static_cast<unsigned long long>(address), read_data.to_string().c_str(),
+                block, hit_level == 0 ? "hit" : "miss");
+
+    DataStorageTransaction dst = {READ, address, latency, hit_level, read_data};
+    return dst;
+}
+
+DataStorageTransaction SkewedAssociativeCache::aligned_write(address_t address,
+                                                             Data& data) {
+    address_t block_address = address >> offset_bits_;
+    address_t offset = address & (cache_block_size_ - 1);
+
+    int32_t hit_level = -1;
+    latency_t latency;
+    bool written_back = false;
+
+    size_t block = find_block(block_address);
+
+    if (block != no_block_) {
+        hit_level = 0;
+        latency = hit_latency_;
+        stats_.write_hits++;
+        touch_block(block);
+    } else {
+        latency = miss_latency_;
+        stats_.write_misses++;
+
+        if (write_allocate_) {
+            // a partial write needs the rest of the block from the next level data
+            // storage
+            if (data.size() != cache_block_size_) {
+                auto next_level_dst =
+                    next_level_data_storage_->read(address - offset, cache_block_size_);
+                hit_level = next_level_dst.hit_level + 1;
+                latency += next_level_dst.latency;
+
+                block = allocate_block(block_address, latency);
+                std::memcpy(&data_[block * cache_block_size_],
+                            next_level_dst.data.data(), cache_block_size_);
+            } else {
+                block = allocate_block(block_address, latency);
+            }
+        } else {
+            auto next_level_dst = next_level_data_storage_->write(address, data);
+            hit_level = next_level_dst.hit_level + 1;
+            latency += next_level_dst.latency;
+            written_back = true;
+        }
+    }
+
+    if (block != no_block_) {
+        std::memcpy(&data_[block * cache_block_size_ + offset], data.data(),
+                    data.size());
+
+        if (!dirty_[block]) {
+            dirty_[block] = true;
+            dirty_blocks_++;
+        }
+    }
+
+    if (write_through_ && !written_back) {
+        auto next_level_dst = next_level_data_storage_->write(address, data);
+        latency += next_level_dst.latency;
+    }
+
+    DEBUG_PRINT("> %s w @ 0x%016llx : d=%s / b=%04zu - %s\n", name_.c_str(),
+                static_cast<unsigned long long>(address), data.to_string().c_str(),
+                block, hit_level == 0 ? "hit" : "miss");
+
+    DataStorageTransaction dst = {WRITE, address, latency, hit_level, data};
+    return dst;
+}
+
+/**
+ * @brief write data to the cache, accesses may span multiple blocks
+ * @param address the address to write to
+ * @param data the data to write
+ */
+DataStorageTransaction SkewedAssociativeCache::write(address_t address, Data& data) {
+    auto cache_lock = lock();
+
+    int32_t hit_level = -1;
+    latency_t latency = 0;
+
+    for (size_t bytes_written = 0; bytes_written < data.size();) {
+        address_t block_address = address + bytes_written;
+        size_t num_bytes =
+            std::min(cache_block_size_ - (block_address & (cache_block_size_ - 1)),
+                     data.size() - bytes_written);
+
+        Data block_data = Data(data.data() + bytes_written, num_bytes);
+        auto dst = aligned_write(block_address, block_data);
+
+        latency += dst.latency;
+        hit_level = std::max(hit_level, dst.hit_level);
+        bytes_written += num_bytes;
+    }
+
+    DataStorageTransaction dst = {WRITE, address, latency, hit_level, data};
+    return dst;
+}
+
+/**
+ * @brief read data from the cache, accesses may span multiple blocks
+ * @param address the address to read from
+ * @param num_bytes the number of bytes to read
+ */
+DataStorageTransaction SkewedAssociativeCache::read(address_t address,
+                                                    size_t num_bytes) {
+    auto cache_lock = lock();
+
+    Data read_data = Data(num_bytes);
+    int32_t hit_level = -1;
+    latency_t latency = 0;
+
+    for (size_t bytes_read = 0; bytes_read < num_bytes;) {
+        address_t block_address = address + bytes_read;
+        size_t block_bytes =
+            std::min(cache_block_size_ - (block_address & (cache_block_size_ - 1)),
+                     num_bytes - bytes_read);
+
+        auto dst = aligned_read(block_address, block_bytes);
+        std::memcpy(read_data.data() + bytes_read, dst.data.data(), block_bytes);
+
+        latency += dst.latency;
+        hit_level = std::max(hit_level, dst.hit_level);
+        bytes_read += block_bytes;
+    }
+
+    DataStorageTransaction dst = {READ, address, latency, hit_level, read_data};
+    return dst;
+}
+
+bool SkewedAssociativeCache::is_address_cached(address_t address) {
+    return find_block(address >> offset_bits_) != no_block_;
+}
+
+bool SkewedAssociativeCache::is_address_dirty(address_t address) {
+    size_t block = find_block(address >> offset_bits_);
+    return block != no_block_ && dirty_[block];
+}
+
+/**
+ * @brief returns the cached byte or 0. CAUTION: this method is intended for debugging
+ * and should not be used in a simulation
+ */
+uint8_t SkewedAssociativeCache::get(address_t address) {
+    size_t block = find_block(address >> offset_bits_);
+    if (block == no_block_) {
+        return 0;
+    }
+    return data_[block * cache_block_size_ + (address & (cache_block_size_ - 1))];
+}
+
+size_t SkewedAssociativeCache::get_dirty_block_count() { return dirty_blocks_; }
+
+/**
+ * @brief flush the whole cache, dirty blocks are written back to the next level data
+ * storage
+ */
+DataStorageTransaction SkewedAssociativeCache::flush() {
+    int32_t hit_level = 0;
+    latency_t latency = 0;
+
+    for (size_t block = 0; block < tags_.size() && dirty_blocks_ > 0; block++) {
+        if (!valid_[block] || !dirty_[block]) {
+            continue;
+        }
+
+        Data data = Data(&data_[block * cache_block_size_], cache_block_size_);
+        auto next_level_dst = next_level_data_storage_->write(
+            get_block_address(block) << offset_bits_, data);
+        stats_.write_backs++;
+
+        dirty_[block] = false;
+        dirty_blocks_--;
+
+        hit_level = std::max(hit_level, next_level_dst.hit_level + 1);
+        latency += next_level_dst.latency;
+    }
+    reset();
+
+    Data data = Data(0);
+
+    DataStorageTransaction dst = {WRITE, 0, latency, hit_level, data};
+    return dst;
+}
+
+/**
+ * @brief invalidates all blocks without writing them back
+ */
+void SkewedAssociativeCache::reset() {
+    std::fill(valid_.begin(), valid_.end(), false);
+    std::fill(dirty_.begin(), dirty_.end(), false);
+    valid_blocks_ = 0;
+    dirty_blocks_ = 0;
+
+    std::fill(last_access_.begin(), last_access_.end(), 0);
+    access_counter_ = 0;
+    std::fill(recently_used_.begin(), recently_used_.end(), false);
+    next_way_ = 0;
+}
+}  // namespace kachesim
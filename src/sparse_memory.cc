@@ -0,0 +1,62 @@
+#include "kachesim/sparse_memory.h"
+
+#include "kachesim/backing_store/cow_backing_store.h"
+
+namespace kachesim {
+SparseMemory::SparseMemory(const std::string& name, uint64_t size,
+                           latency_t read_latency, latency_t write_latency,
+                           size_t page_size)
+    : SparseMemory(name, std::make_shared<SparseBackingStore>(size, page_size),
+                   read_latency, write_latency) {}
+
+SparseMemory::SparseMemory(const std::string& name,
+                           std::shared_ptr<SparseBackingStore> backing_store,
+                           latency_t read_latency, latency_t write_latency)
+    : FakeMemory(name, backing_store, read_latency, write_latency) {}
+
+/**
+ * @brief returns the current backing store, cloning replaces it by a CowBackingStore
+ * which is a SparseBackingStore as well
+ */
+std::shared_ptr<SparseBackingStore> SparseMemory::sparse_backing_store() {
+    return std::static_pointer_cast<SparseBackingStore>(backing_store_);
+}
+
+size_t SparseMemory::page_size() { return sparse_backing_store()->page_size(); }
+
+/**
+ * @brief returns the number of pages which have been written since the last reset,
+ * pages which are still shared with a clone are not counted
+ * @return the number of allocated pages
+ */
+size_t SparseMemory::get_allocated_page_count() {
+    return sparse_backing_store()->get_allocated_page_count();
+}
+
+/**
+ * @brief creates an independent copy of the memory which shares the current pages
+ * copy-on-write, see FakeMemory::clone_backing_store
+ * @return the copy of the memory
+ */
+std::shared_ptr<MemoryInterface> SparseMemory::clone() {
+    auto backing_store = std::static_pointer_cast<SparseBackingStore>(
+        clone_backing_store(page_size()));
+    auto sparse_memory = std::make_shared<SparseMemory>(get_name(), backing_store,
+                                                        read_latency_, write_latency_);
+    sparse_memory->dirty_pages_ = dirty_pages_;
+    sparse_memory->concurrent_ = concurrent_;
+
+    return sparse_memory;
+}
+
+/**
+ * @brief drops all pages, this also marks all pages as clean. Pages shared with a
+ * clone are released instead of being restored.
+ */
+void SparseMemory::reset() {
+    if (std::dynamic_pointer_cast<CowBackingStore>(backing_store_) != nullptr) {
+        backing_store_ = std::make_shared<SparseBackingStore>(size(), page_size());
+    }
+    FakeMemory::reset();
+}
+}  // namespace kachesim
@@ -0,0 +1,102 @@
+#include "kachesim/victim_cache.h"
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+VictimCache::VictimCache(size_t cache_block_size, size_t entries, latency_t latency)
+    : cache_block_size_(cache_block_size), entries_(entries), latency_(latency) {
+    if (entries_ == 0) {
+        THROW_INVALID_ARGUMENT("victim cache without entries");
+    }
+    entry_map_.reserve(entries_);
+}
+
+/**
+ * @brief creates a deep copy of a victim cache, the iterators of the copy point into
+ * its own list
+ */
+VictimCache::VictimCache(const VictimCache& victim_cache)
+    : cache_block_size_(victim_cache.cache_block_size_),
+      entries_(victim_cache.entries_),
+      latency_(victim_cache.latency_),
+      entry_list_(victim_cache.entry_list_) {
+    entry_map_.reserve(entries_);
+    for (auto it = entry_list_.begin(); it != entry_list_.end(); ++it) {
+        entry_map_.insert({it->address, it});
+    }
+}
+
+std::shared_ptr<VictimCache> VictimCache::clone() {
+    return std::make_shared<VictimCache>(*this);
+}
+
+/**
+ * @brief returns the size of the victim cache in bytes
+ */
+size_t VictimCache::size() { return entries_ * cache_block_size_; }
+
+size_t VictimCache::get_entries() { return entries_; }
+
+/**
+ * @brief returns the number of blocks currently held by the victim cache
+ */
+size_t VictimCache::get_entry_count() { return entry_list_.size(); }
+
+latency_t VictimCache::get_latency() { return latency_; }
+
+/**
+ * @brief inserts a block evicted from the cache
+ * @param address the address of the block
+ * @param data the data of the block
+ * @param dirty if the block has to be written back when it leaves the victim cache
+ * @return the replaced block if the victim cache was full
+ */
+std::optional<VictimCacheEntry> VictimCache::insert(address_t address, Data& data,
+                                                    bool dirty) {
+    // an older copy of the block is outdated
+    remove(address);
+
+    std::optional<VictimCacheEntry> replaced;
+    if (entry_list_.size() == entries_) {
+        replaced.emplace(entry_list_.back());
+        entry_map_.erase(replaced->address);
+        entry_list_.pop_back();
+    }
+
+    entry_list_.push_front({address, data, dirty});
+    entry_map_.insert({address, entry_list_.begin()});
+
+    return replaced;
+}
+
+/**
+ * @brief removes a block from the victim cache
+ * @param address the address of the block
+ * @return the block or nothing if it isn't held by the victim cache
+ */
+std::optional<VictimCacheEntry> VictimCache::remove(address_t address) {
+    auto it = entry_map_.find(address);
+    if (it == entry_map_.end()) {
+        return std::nullopt;
+    }
+
+    std::optional<VictimCacheEntry> entry(*it->second);
+    entry_list_.erase(it->second);
+    entry_map_.erase(it);
+    return entry;
+}
+
+bool VictimCache::contains(address_t address) {
+    return entry_map_.find(address) != entry_map_.end();
+}
+
+/**
+ * @brief returns all blocks, the most recently inserted block first
+ */
+const std::list<VictimCacheEntry>& VictimCache::get_entry_list() { return entry_list_; }
+
+void VictimCache::reset() {
+    entry_list_.clear();
+    entry_map_.clear();
+}
+}  // namespace kachesim
@@ -0,0 +1,203 @@
+#include "kachesim/write_buffer.h"
+
+#include <algorithm>
+
+#include "kachesim/common.h"
+
+namespace kachesim {
+WriteBuffer::WriteBuffer(size_t entries, size_t granularity,
+                         WriteBufferDrainPolicy drain_policy)
+    : entries_(entries), granularity_(granularity), drain_policy_(drain_policy) {
+    if (entries_ == 0) {
+        THROW_INVALID_ARGUMENT("write buffer without entries");
+    }
+    if (granularity_ == 0 || (granularity_ & (granularity_ - 1)) != 0) {
+        THROW_INVALID_ARGUMENT("granularity of write buffer is not a power of two");
+    }
+    entry_map_.reserve(entries_);
+}
+
+/**
+ * @brief creates a deep copy of a write buffer, the iterators of the copy point into
+ * its own list
+ */
+WriteBuffer::WriteBuffer(const WriteBuffer& write_buffer)
+    : entries_(write_buffer.entries_),
+      granularity_(write_buffer.granularity_),
+      drain_policy_(write_buffer.drain_policy_),
+      entry_list_(write_buffer.entry_list_),
+      drain_cycle_(write_buffer.drain_cycle_) {
+    entry_map_.reserve(entries_);
+    for (auto it = entry_list_.begin(); it != entry_list_.end(); ++it) {
+        if (!it->draining) {
+            entry_map_.insert({it->address, it});
+        }
+    }
+}
+
+std::shared_ptr<WriteBuffer> WriteBuffer::clone() {
+    return std::make_shared<WriteBuffer>(*this);
+}
+
+/**
+ * @brief returns the size of the write buffer in bytes
+ */
+size_t WriteBuffer::size() { return entries_ * granularity_; }
+
+size_t WriteBuffer::get_entries() { return entries_; }
+
+size_t WriteBuffer::get_granularity() { return granularity_; }
+
+WriteBufferDrainPolicy WriteBuffer::get_drain_policy() { return drain_policy_; }
+
+/**
+ * @brief returns the number of occupied entries, including draining ones
+ */
+size_t WriteBuffer::get_entry_count() { return entry_list_.size(); }
+
+bool WriteBuffer::is_full() { return entry_list_.size() >= entries_; }
+
+/**
+ * @brief merges a write into the entry of its granule if there is one which isn't
+ * draining
+ * @param address the address of the write
+ * @param data the data of the write, must not exceed the granule
+ * @return if the write was merged
+ */
+bool WriteBuffer::merge(address_t address, Data& data) {
+    address_t offset = address & (granularity_ - 1);
+    auto it = entry_map_.find(address - offset);
+    if (it == entry_map_.end()) {
+        return false;
+    }
+
+    auto& entry = *it->second;
+    for (size_t i = 0; i < data.size(); i++) {
+        entry.data[offset + i] = data[i];
+        entry.valid[offset + i] = true;
+    }
+    return true;
+}
+
+/**
+ * @brief allocates an entry for a write which couldn't be merged
+ * @param address the address of the write
+ * @param data the data of the write, must not exceed the granule
+ * @param cycle the cycle in which the entry is allocated
+ * @throws std::runtime_error if the write buffer is full
+ */
+void WriteBuffer::insert(address_t address, Data& data, cycle_t cycle) {
+    if (is_full()) {
+        THROW_RUNTIME_ERROR("write buffer is full");
+    }
+
+    address_t offset = address & (granularity_ - 1);
+
+    WriteBufferEntry entry = {address - offset, Data(granularity_),
+                              std::vector<bool>(granularity_, false), cycle, false, 0};
+    entry_list_.push_back(entry);
+
+    auto it = std::prev(entry_list_.end());
+    entry_map_[it->address] = it;
+
+    merge(address, data);
+}
+
+/**
+ * @brief overwrites the bytes of a read from the next level data storage which are
+ * held by the write buffer, newer entries take precedence
+ * @param address the address of the read
+ * @param data the data of the read
+ */
+void WriteBuffer::forward(address_t address, Data& data) {
+    for (auto& entry : entry_list_) {
+        if (entry.address >= address + data.size() ||
+            entry.address + granularity_ <= address) {
+            continue;
+        }
+
+        address_t begin = std::max(entry.address, address);
+        address_t end = std::min(entry.address + granularity_, address + data.size());
+        for (address_t byte = begin; byte < end; byte++) {
+            if (entry.valid[byte - entry.address]) {
+                data[byte - address] = entry.data[byte - entry.address];
+            }
+        }
+    }
+}
+
+/**
+ * @brief marks an entry as written to the next level data storage, it stays in the
+ * buffer until its drain completes
+ * @param entry an entry of the buffer
+ * @param drained_cycle the cycle in which the drain completes
+ */
+void WriteBuffer::set_draining(WriteBufferEntry& entry, cycle_t drained_cycle) {
+    auto it = entry_map_.find(entry.address);
+    if (it != entry_map_.end() && &*it->second == &entry) {
+        entry_map_.erase(it);
+    }
+
+    entry.draining = true;
+    entry.drained_cycle = drained_cycle;
+    drain_cycle_ = std::max(drain_cycle_, drained_cycle);
+}
+
+/**
+ * @brief returns the cycle in which the first draining entry frees its slot
+ */
+std::optional<cycle_t> WriteBuffer::get_first_drained_cycle() {
+    std::optional<cycle_t> first;
+    for (auto& entry : entry_list_) {
+        if (entry.draining && (!first.has_value() || entry.drained_cycle < *first)) {
+            first = entry.drained_cycle;
+        }
+    }
+    return first;
+}
+
+/**
+ * @brief returns the cycle in which the last drain completes, the next drain can't
+ * start earlier
+ */
+cycle_t WriteBuffer::get_drain_cycle() { return drain_cycle_; }
+
+/**
+ * @brief frees the entries whose drain completed until cycle
+ */
+void WriteBuffer::retire(cycle_t cycle) {
+    entry_list_.remove_if([cycle](const WriteBufferEntry& entry) {
+        return entry.draining && entry.drained_cycle <= cycle;
+    });
+}
+
+/**
+ * @brief removes the oldest entry, e.g. to drain it
+ * @return the oldest entry or nothing if the buffer is empty
+ */
+std::optional<WriteBufferEntry> WriteBuffer::remove_oldest() {
+    if (entry_list_.empty()) {
+        return std::nullopt;
+    }
+
+    auto it = entry_map_.find(entry_list_.front().address);
+    if (it != entry_map_.end() && it->second == entry_list_.begin()) {
+        entry_map_.erase(it);
+    }
+
+    WriteBufferEntry entry = entry_list_.front();
+    entry_list_.pop_front();
+    return entry;
+}
+
+/**
+ * @brief returns all entries, the oldest first
+ */
+std::list<WriteBufferEntry>& WriteBuffer::get_entry_list() { return entry_list_; }
+
+void WriteBuffer::reset() {
+    entry_list_.clear();
+    entry_map_.clear();
+    drain_cycle_ = 0;
+}
+}  // namespace kachesim
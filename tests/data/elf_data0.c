@@ -0,0 +1,20 @@
+// test program for FakeMemory::load_elf, elf_data0.elf32 and elf_data0.elf64 are built
+// with
+//   gcc -m32 -O1 -nostdlib -static -fno-pic -no-pie -Wl,-T,elf_data0.ld \
+//       -Wl,--build-id=none -o elf_data0.elf32 elf_data0.c
+//   gcc -m64 -O1 -nostdlib -static -fno-pic -no-pie -Wl,-T,elf_data0.ld \
+//       -Wl,--build-id=none -o elf_data0.elf64 elf_data0.c
+unsigned int values[4] = {0xdeadbeef, 0x12345678, 0xcafebabe, 0x0badf00d};
+unsigned int zeros[64];
+
+int sum(int n) {
+    int s = 0;
+    for (int i = 0; i < n; i++) s += values[i & 3] + zeros[i & 63];
+    return s;
+}
+
+void _start(void) {
+    zeros[0] = sum(4);
+    for (;;) {
+    }
+}
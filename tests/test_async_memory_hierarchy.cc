@@ -0,0 +1,116 @@
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+std::string read_file_into_string(const std::string& filename) {
+    if (!std::filesystem::exists(filename)) {
+        throw std::invalid_argument("File " + filename + " does not exist.");
+    }
+
+    std::ifstream file(filename);
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    return buffer.str();
+}
+
+AccessTask load_twice(AsyncMemoryHierarchy& hierarchy, size_t port, address_t address,
+                      std::vector<cycle_t>& cycles) {
+    auto read_dst0 = co_await hierarchy.read_async(port, address, 8);
+    assert(read_dst0.hit_level == 2);
+    cycles.push_back(hierarchy.get_cycle());
+
+    auto read_dst1 = co_await hierarchy.read_async(port, address, 8);
+    assert(read_dst1.hit_level == 0);
+    cycles.push_back(hierarchy.get_cycle());
+}
+
+AccessTask delayed_load_store(AsyncMemoryHierarchy& hierarchy, size_t port,
+                              address_t address, std::vector<cycle_t>& cycles) {
+    co_await hierarchy.delay(1);
+    cycles.push_back(hierarchy.get_cycle());
+
+    co_await hierarchy.read_async(port, address, 8);
+    cycles.push_back(hierarchy.get_cycle());
+
+    Data data = Data(8);
+    data.set<uint64_t>(0xdead'beef'dead'beef);
+    auto write_dst = co_await hierarchy.write_async(port, address, data);
+    assert(write_dst.hit_level == 0);
+    cycles.push_back(hierarchy.get_cycle());
+}
+
+AccessTask load_from_invalid_port(AsyncMemoryHierarchy& hierarchy) {
+    co_await hierarchy.read_async(10, 0x0, 8);
+}
+
+int main() {
+    std::string yaml_config_string =
+        read_file_into_string("../data/memory_hierarchy3.yaml");
+
+    auto mh0 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    size_t core0 = mh0->get_port("core0_l1d");
+    size_t core1 = mh0->get_port("core1_l1d");
+
+    std::vector<cycle_t> core0_cycles;
+    std::vector<cycle_t> core1_cycles;
+
+    AsyncMemoryHierarchy hierarchy0(*mh0);
+    assert(mh0->is_timed());
+
+    hierarchy0.spawn(load_twice(hierarchy0, core0, 0x100, core0_cycles));
+    hierarchy0.spawn(delayed_load_store(hierarchy0, core1, 0x200, core1_cycles));
+    assert(hierarchy0.get_pending_count() == 2);
+
+    hierarchy0.run();
+    assert(hierarchy0.get_pending_count() == 0);
+
+    // the misses of both coroutines overlap
+    assert(core0_cycles == std::vector<cycle_t>({5 + 11 + 23, 5 + 11 + 23 + 3}));
+    assert(core1_cycles ==
+           std::vector<cycle_t>({1, 1 + 5 + 11 + 23, 1 + 5 + 11 + 23 + 3}));
+    assert(mh0->get_cycle() == 43);
+
+    // the data is written when the access is issued
+    assert(mh0->read(core1, 0x200, 8).data.get<uint64_t>() == 0xdead'beef'dead'beef);
+
+    // coroutines spawned later start in the current cycle
+    std::vector<cycle_t> core0_cycles1;
+    hierarchy0.spawn(load_twice(hierarchy0, core0, 0x300, core0_cycles1));
+    hierarchy0.run();
+    assert(core0_cycles1 == std::vector<cycle_t>({43 + 39, 43 + 39 + 3}));
+
+    // exceptions of coroutines are rethrown by run
+    auto mh1 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    AsyncMemoryHierarchy hierarchy1(*mh1);
+    hierarchy1.spawn(load_from_invalid_port(hierarchy1));
+
+    bool thrown = false;
+    try {
+        hierarchy1.run();
+    } catch (const std::out_of_range& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // coroutines which didn't finish are destroyed with the hierarchy
+    {
+        std::vector<cycle_t> core0_cycles2;
+        AsyncMemoryHierarchy hierarchy2(*mh1);
+        hierarchy2.spawn(load_twice(hierarchy2, core0, 0x400, core0_cycles2));
+        assert(hierarchy2.get_pending_count() == 1);
+    }
+
+    return 0;
+}
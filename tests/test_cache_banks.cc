@@ -0,0 +1,68 @@
+#include <cassert>
+#include <memory>
+#include <set>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+int main() {
+    auto banks = std::make_shared<CacheBanks>(4, 8, 2);
+    assert(banks->get_banks() == 4);
+    assert(banks->get_bank_width() == 8);
+    assert(banks->get_busy_cycles() == 2);
+    assert(banks->get_bank_function() == MODULO_INDEX);
+
+    // units of 8 bytes are interleaved over the banks
+    assert(banks->get_bank(0x00) == 0);
+    assert(banks->get_bank(0x0f) == 1);
+    assert(banks->get_bank(0x20) == 0);
+
+    // accesses to different banks overlap
+    assert(banks->schedule(0x00, 8, 0, 3) == 3);
+    assert(banks->schedule(0x08, 8, 0, 3) == 3);
+
+    // bank 0 is busy until cycle 2
+    assert(banks->schedule(0x20, 8, 1, 3) == 2 + 3);
+
+    // the access waits for bank 0 which is busy until cycle 4 and accesses its two
+    // units in bank 0 one after the other
+    assert(banks->schedule(0x00, 40, 0, 3) == 4 + 3 + 2);
+
+    // bank 1 is busy until cycle 6
+    assert(banks->schedule(0x08, 1, 7, 1) == 8);
+
+    auto banks_clone = banks->clone();
+
+    // clones are independent
+    banks->reset();
+    assert(banks->schedule(0x00, 8, 0, 3) == 3);
+    assert(banks_clone->schedule(0x00, 8, 0, 3) == 8 + 3);
+
+    // a stride of 4 units maps to one bank with modulo selection, XOR spreads it
+    CacheBanks xor_banks = CacheBanks(4, 8, 1, XOR_INDEX);
+    std::set<size_t> xor_bank_set;
+    for (address_t address = 0; address < 0x80; address += 0x20) {
+        assert(banks->get_bank(address) == 0);
+        xor_bank_set.insert(xor_banks.get_bank(address));
+    }
+    assert(xor_bank_set.size() == 4);
+
+    bool width_thrown = false;
+    try {
+        CacheBanks(4, 12, 1);
+    } catch (const std::invalid_argument& e) {
+        width_thrown = true;
+    }
+    assert(width_thrown);
+
+    bool banks_thrown = false;
+    try {
+        CacheBanks(0, 8, 1);
+    } catch (const std::invalid_argument& e) {
+        banks_thrown = true;
+    }
+    assert(banks_thrown);
+
+    return 0;
+}
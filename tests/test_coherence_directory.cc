@@ -0,0 +1,174 @@
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+std::string read_file_into_string(const std::string& filename) {
+    if (!std::filesystem::exists(filename)) {
+        throw std::invalid_argument("File " + filename + " does not exist.");
+    }
+
+    std::ifstream file(filename);
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    return buffer.str();
+}
+
+int main() {
+    std::string yaml_config_string =
+        read_file_into_string("../data/memory_hierarchy4.yaml");
+
+    // MESI
+    auto mh0 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    auto directory0 = mh0->get_coherence_directory();
+    assert(directory0 != nullptr);
+    assert(directory0->get_protocol() == MESI);
+
+    size_t core0 = mh0->get_port("core0_l1d");
+    size_t core1 = mh0->get_port("core1_l1d");
+
+    auto core0_l1d = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh0->get_data_storage("core0_l1d"));
+    auto core1_l1d = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh0->get_data_storage("core1_l1d"));
+
+    // the first reader gets the block exclusively
+    auto read_dst0 = mh0->read(core0, 0x100, 8);
+    assert(read_dst0.invalidations == 0);
+    assert(read_dst0.interventions == 0);
+    assert(read_dst0.coherence_latency == 2);
+    assert(directory0->get_state(core0, 0x100) == COHERENCE_EXCLUSIVE);
+
+    // a second reader downgrades the owner
+    auto read_dst1 = mh0->read(core1, 0x100, 8);
+    assert(read_dst1.interventions == 1);
+    assert(read_dst1.coherence_latency == 2 + 4);
+    assert(directory0->get_state(core0, 0x100) == COHERENCE_SHARED);
+    assert(directory0->get_state(core1, 0x100) == COHERENCE_SHARED);
+
+    // hits don't consult the directory
+    auto read_dst2 = mh0->read(core1, 0x100, 8);
+    assert(read_dst2.hit_level == 0);
+    assert(read_dst2.coherence_latency == 0);
+
+    // a write invalidates all other copies
+    Data data0 = Data(8);
+    data0.set<uint64_t>(0x1111'2222'3333'4444);
+    auto write_dst0 = mh0->write(core0, 0x100, data0);
+    assert(write_dst0.hit_level == 0);
+    assert(write_dst0.invalidations == 1);
+    assert(write_dst0.coherence_latency == 2 + 4);
+    assert(write_dst0.latency == 3 + 2 + 4);
+    assert(directory0->get_state(core0, 0x100) == COHERENCE_MODIFIED);
+    assert(directory0->get_state(core1, 0x100) == COHERENCE_INVALID);
+    assert(!core1_l1d->is_address_cached(0x100));
+
+    // writes to a modified block are silent
+    auto write_dst1 = mh0->write(core0, 0x108, data0);
+    assert(write_dst1.coherence_latency == 0);
+
+    // the modified block is written back to the shared l2 before it is shared
+    auto read_dst3 = mh0->read(core1, 0x100, 8);
+    assert(read_dst3.data.get<uint64_t>() == 0x1111'2222'3333'4444);
+    assert(read_dst3.interventions == 1);
+    assert(read_dst3.coherence_latency == 2 + 4 + 7);
+    assert(read_dst3.hit_level == 1);
+    assert(!core0_l1d->is_address_dirty(0x100));
+    assert(directory0->get_state(core0, 0x100) == COHERENCE_SHARED);
+    assert(directory0->get_state(core1, 0x100) == COHERENCE_SHARED);
+
+    assert(directory0->get_invalidation_count() == 1);
+    assert(directory0->get_intervention_count() == 2);
+
+    // evicted and flushed blocks are removed from the directory
+    assert(directory0->get_entry_count() == 1);
+    mh0->flush_all_caches();
+    assert(directory0->get_entry_count() == 0);
+    assert(mh0->top_level_memory->read(0x108, 8).data.get<uint64_t>() ==
+           0x1111'2222'3333'4444);
+
+    // MOESI
+    std::string moesi_yaml_config_string = yaml_config_string;
+    moesi_yaml_config_string.replace(moesi_yaml_config_string.find("protocol: MESI"),
+                                     14, "protocol: MOESI");
+
+    auto mh1 = std::make_unique<MemoryHierarchy>(moesi_yaml_config_string);
+    auto directory1 = mh1->get_coherence_directory();
+    assert(directory1->get_protocol() == MOESI);
+
+    auto l2 =
+        std::dynamic_pointer_cast<SetAssociativeCache>(mh1->get_data_storage("l2"));
+    core0_l1d = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh1->get_data_storage("core0_l1d"));
+
+    Data data1 = Data(8);
+    data1.set<uint64_t>(0x5555'6666'7777'8888);
+    mh1->write(core0, 0x200, data1);
+    assert(directory1->get_state(core0, 0x200) == COHERENCE_MODIFIED);
+
+    // the dirty block is forwarded from cache to cache and stays dirty in the owner
+    auto read_dst4 = mh1->read(core1, 0x200, 8);
+    assert(read_dst4.data.get<uint64_t>() == 0x5555'6666'7777'8888);
+    assert(read_dst4.interventions == 1);
+    assert(read_dst4.hit_level == 1);
+    assert(core0_l1d->is_address_dirty(0x200));
+    assert(!l2->is_address_dirty(0x200));
+    assert(directory1->get_state(core0, 0x200) == COHERENCE_OWNED);
+    assert(directory1->get_state(core1, 0x200) == COHERENCE_SHARED);
+
+    // a sharer which writes takes over the dirty block from the owner
+    Data data2 = Data(8);
+    data2.set<uint64_t>(0x9999'aaaa'bbbb'cccc);
+    auto write_dst2 = mh1->write(core1, 0x208, data2);
+    assert(write_dst2.interventions == 1);
+    assert(!core0_l1d->is_address_cached(0x200));
+    assert(!l2->is_address_dirty(0x200));
+    assert(directory1->get_state(core1, 0x200) == COHERENCE_MODIFIED);
+
+    // clones get their own directory with the same entries
+    auto mh2 = mh1->clone();
+    assert(mh2->get_coherence_directory() != directory1);
+    assert(mh2->get_coherence_directory()->get_state(core1, 0x200) ==
+           COHERENCE_MODIFIED);
+    assert(mh2->read(core0, 0x200, 8).data.get<uint64_t>() == 0x5555'6666'7777'8888);
+    assert(mh2->read(core0, 0x208, 8).data.get<uint64_t>() == 0x9999'aaaa'bbbb'cccc);
+    assert(directory1->get_state(core0, 0x200) == COHERENCE_INVALID);
+
+    mh1->flush_all_caches();
+    assert(mh1->top_level_memory->read(0x200, 8).data.get<uint64_t>() ==
+           0x5555'6666'7777'8888);
+    assert(mh1->top_level_memory->read(0x208, 8).data.get<uint64_t>() ==
+           0x9999'aaaa'bbbb'cccc);
+
+    // snoops access other first level caches, so there is no concurrent mode
+    bool thrown = false;
+    try {
+        mh1->set_concurrent(true);
+    } catch (const std::runtime_error& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // coherent caches need a common next level data storage
+    HierarchyConfig config = HierarchyConfig::from_yaml(yaml_config_string);
+    config.caches[0].next_level_data_storage = "fm0";
+    thrown = false;
+    try {
+        config.validate();
+    } catch (const std::invalid_argument& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <cassert>
+#include <memory>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+int main() {
+    DramTimings timings;
+    timings.t_rcd = 10;
+    timings.t_cas = 10;
+    timings.t_rp = 10;
+    timings.t_ras = 25;
+    timings.t_burst = 4;
+
+    // 2 banks with rows of 1024 bytes: 0x000 is row 0 of bank 0, 0x400 row 0 of bank 1
+    // and 0x800 row 1 of bank 0
+    auto dram = std::make_shared<DramMemory>("dram", 4096, 2, 2, 1, 1, 2, 1024, 64,
+                                             OPEN_ROW_POLICY, timings);
+    assert(dram->size() == 4096);
+    assert(dram->get_banks() == 2);
+    assert(dram->get_row_policy() == OPEN_ROW_POLICY);
+
+    auto data = Data(8);
+    data.set<uint64_t>(0x0123'4567'89ab'cdef);
+
+    // the controller latency and the activate before the first access of a row
+    assert(dram->write(0x000, data).latency == 2 + 10 + 10 + 4);
+    assert(dram->read(0x000, 8).data.get<uint64_t>() == 0x0123'4567'89ab'cdef);
+    assert(dram->read(0x040, 64).latency == 2 + 10 + 4);
+
+    // another row of the bank is precharged first
+    assert(dram->read(0x800, 64).latency == 2 + 10 + 10 + 10 + 4);
+
+    // the access takes two bursts in a precharged bank
+    assert(dram->read(0x400, 128).latency == 2 + 10 + 10 + 2 * 4);
+
+    DramStats stats0 = dram->get_stats();
+    assert(stats0.row_hits == 2);
+    assert(stats0.row_misses == 2);
+    assert(stats0.row_conflicts == 1);
+
+    // a closed row policy precharges after every access
+    auto closed_dram = std::make_shared<DramMemory>(
+        "closed_dram", 4096, 2, 2, 1, 1, 2, 1024, 64, CLOSED_ROW_POLICY, timings);
+    assert(closed_dram->read(0x000, 64).latency == 2 + 10 + 10 + 4);
+    assert(closed_dram->read(0x040, 64).latency == 2 + 10 + 10 + 4);
+    assert(closed_dram->get_stats().row_misses == 2);
+
+    // in timed mode the banks work in parallel and share the data bus
+    auto timed_dram = std::make_shared<DramMemory>("timed_dram", 4096, 2, 2, 1, 1, 2,
+                                                   1024, 64, OPEN_ROW_POLICY, timings);
+    assert(timed_dram->read_at(0, 0x000, 64).completion_cycle == 2 + 10 + 10 + 4);
+    assert(timed_dram->read_at(0, 0x400, 64).completion_cycle == 2 + 10 + 10 + 4 + 4);
+
+    // row 0 of bank 0 can't be precharged before cycle 2 + 25
+    auto conflict_dst = timed_dram->read_at(0, 0x800, 64);
+    assert(conflict_dst.completion_cycle == 27 + 10 + 10 + 10 + 4);
+    assert(conflict_dst.latency == 61);
+
+    // a younger access to row 0 is served before the precharge of row 0, after the
+    // transfers on the data bus
+    assert(timed_dram->read_at(3, 0x080, 64).completion_cycle == 30 + 4);
+
+    // an access to the open row 1 follows the access which opened it
+    assert(timed_dram->read_at(10, 0x840, 64).completion_cycle == 61 + 4);
+
+    DramStats stats1 = timed_dram->get_stats();
+    assert(stats1.row_hits == 2);
+    assert(stats1.row_misses == 2);
+    assert(stats1.row_conflicts == 1);
+
+    // clones are independent and keep the content and the open rows
+    auto dram_clone = std::dynamic_pointer_cast<DramMemory>(dram->clone());
+    assert(dram_clone != nullptr);
+    assert(dram_clone->read(0x000, 8).data.get<uint64_t>() == 0x0123'4567'89ab'cdef);
+    assert(dram_clone->read(0x440, 64).latency == 2 + 10 + 4);
+
+    data.set<uint64_t>(0xfedc'ba98'7654'3210);
+    dram_clone->write(0x000, data);
+    assert(dram->read(0x000, 8).data.get<uint64_t>() == 0x0123'4567'89ab'cdef);
+
+    // a reset closes all rows
+    dram->reset();
+    assert(dram->read(0x440, 64).latency == 2 + 10 + 10 + 4);
+
+    bool row_size_thrown = false;
+    try {
+        DramMemory("invalid_dram", 4096, 2, 2, 1, 1, 2, 1000, 64, OPEN_ROW_POLICY,
+                   timings);
+    } catch (const std::invalid_argument& e) {
+        row_size_thrown = true;
+    }
+    assert(row_size_thrown);
+
+    return 0;
+}
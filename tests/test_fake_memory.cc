@@ -1,6 +1,7 @@
 #include <cassert>
 #include <climits>
 #include <cstdint>
+#include <filesystem>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -237,6 +238,228 @@ int main() {
 
     fm->write_hex_memory_file("../data/hex_data2.mem", 16, 19);
 
+    std::filesystem::remove("../data/hex_data1.mem");
+    std::filesystem::remove("../data/hex_data2.mem");
+
+    // map a binary image into memory
+    auto mbs = std::make_shared<MappedBackingStore>("../data/bin_data0.mem", 8192);
+    auto fm_image = std::make_unique<FakeMemory>("fm_image0", mbs, read_latency,
+                                                 write_latency);
+
+    assert(fm_image->size() == 8192);
+    assert(mbs->image_size() == 32);
+    assert(fm_image->read(0, 8).data.get<uint64_t>() == 0x12340a0abeefdead);
+    assert(fm_image->read(8, 8).data.get<uint64_t>() == 0x010000eeff012345);
+
+    // bytes behind the image are 0
+    assert(fm_image->read(32, 8).data.get<uint64_t>() == 0);
+    assert(fm_image->read(8184, 8).data.get<uint64_t>() == 0);
+
+    // writes are private and do not modify the image file
+    Data d_image = Data(8);
+    d_image.set<uint64_t>(0x1122'3344'5566'7788);
+    fm_image->write(4, d_image);
+    fm_image->write(4096, d_image);
+
+    assert(fm_image->read(4, 8).data.get<uint64_t>() == 0x1122'3344'5566'7788);
+    assert(fm_image->read(4096, 8).data.get<uint64_t>() == 0x1122'3344'5566'7788);
+
+    auto fm_file = FakeMemory("fm_file0", 32, read_latency, write_latency);
+    fm_file.read_bin_memory_file("../data/bin_data0.mem", 0);
+    assert(fm_file.read(0, 8).data.get<uint64_t>() == 0x12340a0abeefdead);
+
+    // reset restores the image
+    fm_image->reset();
+
+    assert(fm_image->read(0, 8).data.get<uint64_t>() == 0x12340a0abeefdead);
+    assert(fm_image->read(4096, 8).data.get<uint64_t>() == 0);
+
+    // without a size the memory is as large as the image
+    auto mbs1 = std::make_shared<MappedBackingStore>("../data/bin_data0.mem");
+    assert(mbs1->size() == 32);
+
+    // images larger than the memory are rejected
+    bool thrown = false;
+    try {
+        auto mbs2 = std::make_shared<MappedBackingStore>("../data/bin_data0.mem", 16);
+    } catch (const std::invalid_argument& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // dump and load a hex file which is split into multiple chunks. Lines are written
+    // in ascending address order but read with the lowest address right most, so each
+    // line of 32 bytes is mirrored
+    auto fm_large = std::make_unique<FakeMemory>("fm_large0", 12 * 1024 * 1024,
+                                                 read_latency, write_latency);
+    for (uint64_t i = 0; i < fm_large->size(); i += 4096) {
+        Data d_large = Data(8);
+        d_large.set<uint64_t>(0x0123'4567'89ab'cdef ^ i);
+        fm_large->write(i, d_large);
+    }
+    fm_large->write_hex_memory_file("../data/hex_data3.mem", 0, 0, 32);
+
+    for (uint32_t num_threads : {1, 4}) {
+        auto fm_loaded = std::make_unique<FakeMemory>("fm_loaded0", fm_large->size(),
+                                                      read_latency, write_latency);
+        fm_loaded->read_hex_memory_file("../data/hex_data3.mem", 0, 0, num_threads);
+
+        for (uint64_t i = 0; i < fm_large->size(); i += 4096) {
+            assert(fm_loaded->read(i + 24, 8).data.get<uint64_t>() ==
+                   __builtin_bswap64(0x0123'4567'89ab'cdef ^ i));
+            assert(fm_loaded->read(i, 8).data.get<uint64_t>() == 0);
+        }
+    }
+
+    // loading stops after the line which reaches the end address
+    auto fm_cut = std::make_unique<FakeMemory>("fm_cut0", fm_large->size(),
+                                               read_latency, write_latency);
+    fm_cut->read_hex_memory_file("../data/hex_data3.mem", 0, 10 * 1024 * 1024 + 4,
+                                 4);
+    assert(fm_cut->read(10 * 1024 * 1024 + 24, 8).data.get<uint64_t>() ==
+           __builtin_bswap64(0x0123'4567'89ab'cdef ^ (10 * 1024 * 1024)));
+    assert(fm_cut->read(10 * 1024 * 1024 + 4096 + 24, 8).data.get<uint64_t>() == 0);
+
+    std::filesystem::remove("../data/hex_data3.mem");
+
+    // load ELF files, the data segment is linked to virtual address 0x2000 but loaded
+    // to physical address 0x3000
+    for (const auto& elf_file_path :
+         {"../data/elf_data0.elf32", "../data/elf_data0.elf64"}) {
+        auto fm_elf = std::make_unique<FakeMemory>("fm_elf0", 0x4000, read_latency,
+                                                   write_latency);
+
+        // BSS has to be zero filled
+        for (uint64_t i = 0x3000; i < 0x4000; i++) {
+            fm_elf->set(i, 0xff);
+        }
+
+        auto image = fm_elf->load_elf(elf_file_path);
+
+        assert(image.segments.size() == 2);
+        assert(image.segments[0].physical_address == 0x1000);
+        assert(image.segments[0].executable);
+        assert(image.segments[1].physical_address == 0x3000);
+        assert(image.segments[1].virtual_address == 0x2000);
+        assert(image.segments[1].file_size == 0x10);
+        assert(image.segments[1].memory_size == 0x120);
+        assert(image.segments[1].writable);
+
+        assert(fm_elf->read(0x3000, 4).data.get<uint32_t>() == 0xdeadbeef);
+        assert(fm_elf->read(0x300c, 4).data.get<uint32_t>() == 0x0badf00d);
+        for (uint64_t i = 0x3010; i < 0x3120; i += 8) {
+            assert(fm_elf->read(i, 8).data.get<uint64_t>() == 0);
+        }
+        assert(fm_elf->read(0x3120, 1).data.get<uint8_t>() == 0xff);
+
+        // symbols are sorted by address
+        assert(image.symbols.size() == 4);
+        assert(image.symbols[0].name == "sum");
+        assert(image.symbols[0].address == 0x1000);
+        assert(image.symbols[0].type == ELF_SYMBOL_FUNCTION);
+        assert(image.symbols[1].name == "_start");
+        assert(image.symbols[1].address == image.entry_point);
+        assert(image.symbols[2].name == "values");
+        assert(image.symbols[2].size == 16);
+        assert(image.symbols[3].name == "zeros");
+        assert(image.symbols[3].address == 0x2020);
+        assert(image.symbols[3].size == 256);
+        assert(image.symbols[3].type == ELF_SYMBOL_OBJECT);
+    }
+
+    assert(FakeMemory("fm_elf1", 0x4000, read_latency, write_latency)
+               .load_elf("../data/elf_data0.elf32")
+               .entry_point == 0x1041);
+
+    // segments which don't fit into memory are rejected
+    thrown = false;
+    try {
+        FakeMemory("fm_elf2", 0x3100, read_latency, write_latency)
+            .load_elf("../data/elf_data0.elf64");
+    } catch (const std::out_of_range& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // files which aren't ELF files are rejected
+    thrown = false;
+    try {
+        FakeMemory("fm_elf3", 0x4000, read_latency, write_latency)
+            .load_elf("../data/bin_data0.mem");
+    } catch (const std::runtime_error& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // incremental dumps of a memory whose size isn't a multiple of the page size
+    auto fm_inc0 = FakeMemory("fm_inc0", 10000, read_latency, write_latency);
+    assert(fm_inc0.get_dirty_page_size() == 4096);
+
+    fm_inc0.set(100, 1);
+    fm_inc0.set(9999, 2);
+    assert(fm_inc0.get_dirty_page_count() == 2);
+    assert(!fm_inc0.is_page_dirty(4096));
+
+    fm_inc0.write_incremental_memory_file("../data/inc_data2.mem");
+
+    auto fm_inc1 = FakeMemory("fm_inc1", 10000, read_latency, write_latency);
+    fm_inc1.read_incremental_memory_file("../data/inc_data2.mem");
+    assert(fm_inc1.get(100) == 1);
+    assert(fm_inc1.get(9999) == 2);
+
+    // memories of a different size are rejected
+    thrown = false;
+    try {
+        auto fm_inc2 = FakeMemory("fm_inc2", 20000, read_latency, write_latency);
+        fm_inc2.read_incremental_memory_file("../data/inc_data2.mem");
+    } catch (const std::runtime_error& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // other files are rejected
+    thrown = false;
+    try {
+        fm_inc1.read_incremental_memory_file("../data/bin_data0.mem");
+    } catch (const std::runtime_error& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::filesystem::remove("../data/inc_data2.mem");
+
+    // copy-on-write memories sharing one base, the last page is shorter than 4096
+    auto cow_base = std::make_shared<DenseBackingStore>(10000);
+    auto fm_base = FakeMemory("fm_base0", cow_base, read_latency, write_latency);
+    fm_base.set(8, 0x11);
+    fm_base.set(9999, 0x22);
+
+    auto cbs0 = std::make_shared<CowBackingStore>(cow_base);
+    auto cbs1 = std::make_shared<CowBackingStore>(cow_base);
+    auto fm_cow0 = FakeMemory("fm_cow0", cbs0, read_latency, write_latency);
+    auto fm_cow1 = FakeMemory("fm_cow1", cbs1, read_latency, write_latency);
+
+    assert(fm_cow0.size() == 10000);
+    assert(fm_cow0.get(8) == 0x11);
+
+    fm_cow0.set(9, 0x33);
+    fm_cow0.set(9998, 0x44);
+
+    assert(cbs0->get_allocated_page_count() == 2);
+    assert(cbs1->get_allocated_page_count() == 0);
+    assert(fm_cow0.get(8) == 0x11);
+    assert(fm_cow0.get(9) == 0x33);
+    assert(fm_cow0.get(9998) == 0x44);
+    assert(fm_cow0.get(9999) == 0x22);
+    assert(fm_cow1.get(9) == 0);
+    assert(fm_base.get(9) == 0);
+
+    // reset drops the private pages
+    fm_cow0.reset();
+    assert(fm_cow0.get(9) == 0);
+    assert(fm_cow0.get(8) == 0x11);
+    assert(cbs0->get_allocated_page_count() == 0);
+
     auto fm_static = FakeMemory("fm_static0", 32, read_latency, write_latency);
 
     fm_static.set(15, 42);
@@ -0,0 +1,104 @@
+#include <cassert>
+#include <memory>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+int main() {
+    latency_t fm_read_latency = 11;
+    latency_t fm_write_latency = 13;
+
+    auto fm = std::make_shared<FakeMemory>("mem0", 4096, fm_read_latency,
+                                           fm_write_latency);
+
+    latency_t fac_miss_latency = 7;
+    latency_t fac_hit_latency = 3;
+
+    auto fac = std::make_shared<FullyAssociativeCache>(
+        "fac0", fm, true, false, fac_miss_latency, fac_hit_latency, 16, 4);
+    assert(fac->size() == 64);
+    assert(fac->get_entries() == 4);
+    assert(fac->get_valid_entry_count() == 0);
+
+    // any block can be placed in any entry
+    for (address_t address = 0; address < 4 * 256; address += 256) {
+        Data d = Data(4);
+        d.set<uint32_t>(address);
+        auto dst = fac->write(address, d);
+        assert(dst.latency == fac_miss_latency + fm_read_latency);
+        assert(dst.hit_level == 1);
+    }
+    assert(fac->get_valid_entry_count() == 4);
+    assert(fac->get_dirty_block_count() == 4);
+
+    auto hit_dst = fac->read(0, 4);
+    assert(hit_dst.latency == fac_hit_latency);
+    assert(hit_dst.hit_level == 0);
+    assert(hit_dst.data.get<uint32_t>() == 0);
+
+    // 0x100 is the least recently used block, it is written back on eviction
+    auto evict_dst = fac->read(0x1000 - 16, 4);
+    assert(evict_dst.latency == fac_miss_latency + fm_read_latency + fm_write_latency);
+    assert(!fac->is_address_cached(0x100));
+    assert(fac->is_address_cached(0x000));
+    assert(fm->read(0x100, 4).data.get<uint32_t>() == 0x100);
+
+    // partial writes keep the rest of the block
+    Data d = Data(1);
+    d.set<uint8_t>(0xab);
+    fac->write(0x201, d);
+    auto partial_dst = fac->read(0x200, 4);
+    assert(partial_dst.data.get<uint32_t>() == 0x0000'ab00);
+
+    // accesses spanning multiple blocks sum up the latencies
+    auto multi_block_dst = fac->read(0x0c, 8);
+    assert(multi_block_dst.latency ==
+           fac_hit_latency + fac_miss_latency + fm_read_latency + fm_write_latency);
+
+    auto stats = fac->get_stats();
+    assert(stats.write_hits == 1);
+    assert(stats.write_misses == 4);
+    assert(stats.write_backs == 2);
+
+    // clones are independent
+    auto fm_clone = std::make_shared<FakeMemory>("mem1", 4096, fm_read_latency,
+                                                 fm_write_latency);
+    auto fac_clone =
+        std::dynamic_pointer_cast<FullyAssociativeCache>(fac->clone(fm_clone));
+    assert(fac_clone->get_valid_entry_count() == 4);
+    assert(fac_clone->get(0x201) == 0xab);
+
+    auto flush_dst = fac->flush();
+    assert(flush_dst.latency == 2 * fm_write_latency);
+    assert(fac->get_dirty_block_count() == 0);
+    assert(fm->read(0x200, 4).data.get<uint32_t>() == 0x0000'ab00);
+    assert(fac_clone->get_dirty_block_count() == 2);
+
+    fac->reset();
+    assert(fac->get_valid_entry_count() == 0);
+    assert(!fac->is_address_cached(0x200));
+
+    // no write allocate, write through
+    auto fac_wt = std::make_shared<FullyAssociativeCache>(
+        "fac1", fm, false, true, fac_miss_latency, fac_hit_latency, 16, 2);
+    d.set<uint8_t>(0xcd);
+    auto write_through_dst = fac_wt->write(0x300, d);
+    assert(write_through_dst.latency == fac_miss_latency + fm_write_latency);
+    assert(!fac_wt->is_address_cached(0x300));
+    assert(fm->read(0x300, 1).data.get<uint8_t>() == 0xcd);
+
+    // thousands of entries
+    auto fac_large = std::make_shared<FullyAssociativeCache>(
+        "fac2", fm, true, false, fac_miss_latency, fac_hit_latency, 1, 4096);
+    for (address_t address = 0; address < 4096; address++) {
+        fac_large->read(address, 1);
+    }
+    assert(fac_large->get_valid_entry_count() == 4096);
+    for (address_t address = 0; address < 4096; address += 97) {
+        assert(fac_large->read(address, 1).hit_level == 0);
+    }
+    assert(fac_large->get_stats().read_misses == 4096);
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+std::string read_file_into_string(const std::string& filename) {
+    if (!std::filesystem::exists(filename)) {
+        throw std::invalid_argument("File " + filename + " does not exist.");
+    }
+
+    std::ifstream file(filename);
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    return buffer.str();
+}
+
+CacheConfig create_cache_config(const std::string& name,
+                                const std::string& next_level_data_storage,
+                                latency_t miss_latency, latency_t hit_latency,
+                                size_t sets, size_t ways) {
+    CacheConfig config;
+    config.name = name;
+    config.next_level_data_storage = next_level_data_storage;
+    config.miss_latency = miss_latency;
+    config.hit_latency = hit_latency;
+    config.cache_block_size = 32;
+    config.sets = sets;
+    config.ways = ways;
+    return config;
+}
+
+/**
+ * @brief checks that building the hierarchy throws std::invalid_argument with a message
+ * containing expected_message
+ */
+void assert_invalid(const HierarchyBuilder& builder,
+                    const std::string& expected_message) {
+    bool thrown = false;
+    try {
+        builder.build();
+    } catch (const std::invalid_argument& e) {
+        thrown = std::string(e.what()).find(expected_message) != std::string::npos;
+    }
+    assert(thrown);
+}
+
+int main() {
+    MemoryConfig memory_config;
+    memory_config.name = "fm0";
+    memory_config.size = 1024;
+    memory_config.read_latency = 23;
+    memory_config.write_latency = 29;
+
+    // same hierarchy as memory_hierarchy0.yaml, caches are added in arbitrary order
+    auto l1_config = create_cache_config("l1_dcache", "l2_dcache", 5, 3, 4, 2);
+    auto l2_config = create_cache_config("l2_dcache", "l3_dcache", 11, 7, 4, 8);
+    auto l3_config = create_cache_config("l3_dcache", "fm0", 17, 13, 2, 16);
+
+    auto builder = HierarchyBuilder()
+                       .cache(l2_config)
+                       .memory(memory_config)
+                       .cache(l1_config)
+                       .cache(l3_config);
+
+    auto order = builder.get_config().get_topological_order();
+    assert(order.size() == 4);
+    assert(order[0] == "fm0");
+    assert(order[1] == "l3_dcache");
+    assert(order[2] == "l2_dcache");
+    assert(order[3] == "l1_dcache");
+
+    auto mh0 = builder.build();
+    auto mh1 = std::make_unique<MemoryHierarchy>(
+        read_file_into_string("../data/memory_hierarchy0.yaml"));
+
+    // yaml is lowered into the same config
+    auto yaml_order = mh1->get_config().get_topological_order();
+    assert(yaml_order == order);
+    assert(mh1->get_config().caches[0].hit_latency == 3);
+    assert(mh1->get_config().caches[0].sets == 4);
+    assert(mh1->get_config().memories[0].write_latency == 29);
+
+    // both hierarchies behave the same
+    for (int i = 0; i < 1024; i++) {
+        address_t address = std::rand() % 1024;
+        if (std::rand() % 2 == 0) {
+            Data write_data = Data(1);
+            write_data.set<uint8_t>(std::rand());
+            auto write_dst0 = mh0->write(address, write_data);
+            auto write_dst1 = mh1->write(address, write_data);
+            assert(write_dst0.latency == write_dst1.latency);
+        } else {
+            auto read_dst0 = mh0->read(address, 1);
+            auto read_dst1 = mh1->read(address, 1);
+            assert(read_dst0.latency == read_dst1.latency);
+            assert(read_dst0.hit_level == read_dst1.hit_level);
+            assert(read_dst0.data.get<uint8_t>() == read_dst1.data.get<uint8_t>());
+        }
+    }
+
+    // cycles are reported with the caches involved
+    assert_invalid(HierarchyBuilder()
+                       .memory(memory_config)
+                       .cache(create_cache_config("l1", "l2", 5, 3, 4, 2))
+                       .cache(create_cache_config("l2", "l3", 5, 3, 4, 2))
+                       .cache(create_cache_config("l3", "l2", 5, 3, 4, 2)),
+                   "cycle in memory hierarchy: l2 -> l3 -> l2");
+
+    // unknown next level data storage
+    assert_invalid(HierarchyBuilder().memory(memory_config).cache(
+                       create_cache_config("l1", "l2", 5, 3, 4, 2)),
+                   "No data_storage with name l2");
+
+    // duplicate names
+    assert_invalid(HierarchyBuilder().memory(memory_config).cache(
+                       create_cache_config("fm0", "fm0", 5, 3, 4, 2)),
+                   "'fm0' is not unique");
+
+    // invalid parameters
+    assert_invalid(HierarchyBuilder().memory(memory_config).cache(
+                       create_cache_config("l1", "fm0", 5, 3, 0, 2)),
+                   "sets of cache 'l1' is 0");
+
+    CacheConfig sectored_config = create_cache_config("l1", "fm0", 5, 3, 4, 2);
+    sectored_config.sectors = 3;
+    assert_invalid(HierarchyBuilder().memory(memory_config).cache(sectored_config),
+                   "sectors of cache 'l1'");
+
+    sectored_config.sectors = 2;
+    sectored_config.write_no_fetch = true;
+    assert_invalid(HierarchyBuilder().memory(memory_config).cache(sectored_config),
+                   "without fetch on write can't be sectored");
+
+    CacheConfig buffered_config = create_cache_config("l1", "fm0", 5, 3, 4, 2);
+    buffered_config.write_buffer_entries = 4;
+    buffered_config.write_buffer_granularity = 24;
+    assert_invalid(HierarchyBuilder().memory(memory_config).cache(buffered_config),
+                   "write buffer granularity of cache 'l1'");
+
+    MemoryConfig dram_config = memory_config;
+    dram_config.type = DRAM_MEMORY;
+    dram_config.row_size = 1000;
+    assert_invalid(HierarchyBuilder().memory(dram_config),
+                   "row_size of memory 'fm0' is not a multiple of burst_size");
+
+    assert_invalid(HierarchyBuilder().cache(l3_config), "without a memory");
+
+    MemoryConfig empty_memory_config;
+    empty_memory_config.name = "fm1";
+    assert_invalid(HierarchyBuilder().memory(empty_memory_config), "size of memory");
+
+    return 0;
+}
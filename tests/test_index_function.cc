@@ -0,0 +1,89 @@
+#include <cassert>
+#include <set>
+#include <vector>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+int main() {
+    std::vector<IndexFunctionType> types = {MODULO_INDEX, XOR_INDEX, PRIME_MODULO_INDEX,
+                                            SKEWED_INDEX};
+    std::vector<size_t> set_counts = {1, 2, 3, 12, 64, 1000, 3072};
+
+    // each block address is restored from its index and tag
+    for (IndexFunctionType type : types) {
+        for (size_t sets : set_counts) {
+            IndexFunction index_function = IndexFunction(type, sets);
+            assert(index_function.get_sets() == sets);
+            assert(index_function.get_indexable_sets() <= sets);
+
+            for (address_t block_address = 0; block_address < 100'000;
+                 block_address += 7) {
+                address_t index = index_function.index(block_address);
+                address_t tag = index_function.tag(block_address);
+                assert(index < index_function.get_indexable_sets());
+                assert(index_function.block_address(index, tag) == block_address);
+            }
+
+            address_t block_address = 0xffff'ffff'ffff'fff3;
+            address_t index = index_function.index(block_address);
+            address_t tag = index_function.tag(block_address);
+            assert(index < index_function.get_indexable_sets());
+            assert(index_function.block_address(index, tag) == block_address);
+        }
+    }
+
+    // modulo indexing with a power of two is bit slicing
+    IndexFunction modulo = IndexFunction(MODULO_INDEX, 64);
+    assert(modulo.index(0x1234'5678) == (0x1234'5678 & 63));
+    assert(modulo.tag(0x1234'5678) == (0x1234'5678 >> 6));
+
+    // non-power-of-two set counts
+    IndexFunction modulo_12 = IndexFunction(MODULO_INDEX, 12);
+    assert(modulo_12.index(100) == 100 % 12);
+    assert(modulo_12.tag(100) == 100 / 12);
+
+    // prime modulo uses the largest prime which isn't larger than the set count
+    assert(IndexFunction(PRIME_MODULO_INDEX, 64).get_indexable_sets() == 61);
+    assert(IndexFunction(PRIME_MODULO_INDEX, 1024).get_indexable_sets() == 1021);
+    assert(IndexFunction(PRIME_MODULO_INDEX, 13).get_indexable_sets() == 13);
+    assert(IndexFunction(PRIME_MODULO_INDEX, 1).get_indexable_sets() == 1);
+
+    // a power-of-two stride maps to a single set with modulo indexing, the other index
+    // functions spread it
+    for (IndexFunctionType type : types) {
+        IndexFunction index_function = IndexFunction(type, 64);
+        std::set<address_t> indices;
+
+        for (address_t block_address = 0; block_address < 64 * 64;
+             block_address += 64) {
+            indices.insert(index_function.index(block_address));
+        }
+
+        if (type == MODULO_INDEX) {
+            assert(indices.size() == 1);
+        } else {
+            assert(indices.size() > 32);
+        }
+    }
+
+    // different skews map a block to different sets
+    IndexFunction skew0 = IndexFunction(SKEWED_INDEX, 64, 0);
+    IndexFunction skew1 = IndexFunction(SKEWED_INDEX, 64, 1);
+    size_t different_indices = 0;
+    for (address_t block_address = 0; block_address < 64 * 64; block_address++) {
+        different_indices += skew0.index(block_address) != skew1.index(block_address);
+    }
+    assert(different_indices > 64 * 60);
+
+    bool thrown = false;
+    try {
+        IndexFunction(MODULO_INDEX, 0);
+    } catch (const std::invalid_argument& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    return 0;
+}
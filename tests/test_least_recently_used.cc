@@ -27,5 +27,13 @@ int main() {
     lru->remove(2);
     assert(lru->get_replacement_index() == 3);
 
+    // clones keep the order but are updated independently
+    auto lru_clone = lru->clone();
+    assert(lru_clone->to_string() == lru->to_string());
+
+    lru_clone->update(3);
+    assert(lru_clone->get_replacement_index() == 5);
+    assert(lru->get_replacement_index() == 3);
+
     return 0;
 }
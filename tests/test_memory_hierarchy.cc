@@ -4,6 +4,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 #include "kachesim/doubly_linked_list/doubly_linked_list.h"
 #include "kachesim/kachesim.h"
@@ -93,5 +94,434 @@ int main() {
         assert(mh0->top_level_memory->get(i) == address_data_map.at(i));
     }
 
+    // after a reset all reads miss in every cache level
+    mh0->reset();
+
+    auto read_dst0 = mh0->read(0, 1);
+    assert(read_dst0.hit_level == 3);
+    assert(read_dst0.data.get<uint8_t>() == address_data_map.at(0));
+
+    auto read_dst1 = mh0->read(0, 1);
+    assert(read_dst1.hit_level == 0);
+
+    // memory hierarchy with a sparse memory spanning a 48-bit address space
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy1.yaml");
+
+    auto mh1 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+
+    assert(mh1->top_level_memory->size() == 0x1'0000'0000'0000);
+
+    std::map<address_t, uint64_t> sparse_address_data_map;
+
+    for (int i = 0; i < 256; i++) {
+        address_t address =
+            ((uint64_t)std::rand() << 20 | std::rand()) & 0xffff'ffff'fff8;
+        uint64_t value = (uint64_t)std::rand() << 32 | std::rand();
+        sparse_address_data_map[address] = value;
+
+        Data write_data = Data(8);
+        write_data.set<uint64_t>(value);
+        mh1->write(address, write_data);
+    }
+
+    for (const auto& [address, value] : sparse_address_data_map) {
+        assert(mh1->read(address, 8).data.get<uint64_t>() == value);
+    }
+
+    mh1->flush_all_caches();
+
+    for (const auto& [address, value] : sparse_address_data_map) {
+        assert(mh1->top_level_memory->read(address, 8).data.get<uint64_t>() == value);
+    }
+
+    // memory hierarchy with a memory image
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy2.yaml");
+
+    auto mh2 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+
+    assert(mh2->top_level_memory->size() == 4096);
+    assert(mh2->read(0, 8).data.get<uint64_t>() == 0x12340a0abeefdead);
+    assert(mh2->read(8, 8).data.get<uint64_t>() == 0x010000eeff012345);
+    assert(mh2->read(2048, 8).data.get<uint64_t>() == 0);
+
+    // clones start from the same cache state but are independent afterwards
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy0.yaml");
+
+    auto mh6 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+
+    for (int i = 0; i < 512; i++) {
+        Data warmup_data = Data(1);
+        warmup_data.set<uint8_t>(i);
+        mh6->write(std::rand() % mh6->top_level_memory->size(), warmup_data);
+    }
+
+    auto mh7 = mh6->clone();
+
+    for (int i = 0; i < 256; i++) {
+        address_t address = std::rand() % mh6->top_level_memory->size();
+        auto read_dst6 = mh6->read(address, 1);
+        auto read_dst7 = mh7->read(address, 1);
+
+        assert(read_dst6.hit_level == read_dst7.hit_level);
+        assert(read_dst6.latency == read_dst7.latency);
+        assert(read_dst6.data.get<uint8_t>() == read_dst7.data.get<uint8_t>());
+    }
+
+    // clones can run on different threads and writes stay private
+    auto mh8 = mh6->clone();
+
+    auto write_pattern = [](MemoryHierarchy* mh, uint8_t value) {
+        for (address_t address = 0; address < 64; address++) {
+            Data pattern_data = Data(1);
+            pattern_data.set<uint8_t>(value);
+            mh->write(address, pattern_data);
+        }
+        mh->flush_all_caches();
+    };
+
+    std::vector<uint8_t> original_values;
+    for (address_t address = 0; address < 64; address++) {
+        original_values.push_back(mh6->read(address, 1).data.get<uint8_t>());
+    }
+
+    std::thread thread7(write_pattern, mh7.get(), 0x77);
+    std::thread thread8(write_pattern, mh8.get(), 0x88);
+    thread7.join();
+    thread8.join();
+
+    for (address_t address = 0; address < 64; address++) {
+        assert(mh7->top_level_memory->get(address) == 0x77);
+        assert(mh8->top_level_memory->get(address) == 0x88);
+        assert(mh6->read(address, 1).data.get<uint8_t>() == original_values[address]);
+    }
+
+    // latencies of a clone can be changed without affecting the original
+    auto l1_clone = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh7->get_data_storage("l1_dcache"));
+    auto l1 = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh6->get_data_storage("l1_dcache"));
+    l1_clone->set_hit_latency(l1->get_hit_latency() + 10);
+    assert(l1->get_hit_latency() + 10 == l1_clone->get_hit_latency());
+
+    // two cores with split first level caches sharing a second level cache
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy3.yaml");
+
+    auto mh9 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+
+    assert(mh9->get_port_count() == 4);
+    assert(mh9->get_port_names()[0] == "core0_l1i");
+    assert(mh9->get_port("core1_l1d") == 3);
+
+    size_t core0_l1d = mh9->get_port("core0_l1d");
+    size_t core1_l1d = mh9->get_port("core1_l1d");
+    size_t core1_l1i = mh9->get_port("core1_l1i");
+
+    Data core_data = Data(8);
+    core_data.set<uint64_t>(0xc0de'c0de'c0de'c0de);
+    mh9->write(core0_l1d, 0x100, core_data);
+
+    // the block is in the first level cache of core 0 and in the shared cache
+    auto read_dst9 = mh9->read(core0_l1d, 0x100, 8);
+    assert(read_dst9.hit_level == 0);
+
+    auto read_dst10 = mh9->read(core1_l1d, 0x200, 8);
+    assert(read_dst10.hit_level == 2);
+
+    auto read_dst11 = mh9->read(core1_l1i, 0x200, 8);
+    assert(read_dst11.hit_level == 1);
+
+    // flushing writes back the first level caches before the shared cache
+    mh9->flush_all_caches();
+    assert(mh9->top_level_memory->read(0x100, 8).data.get<uint64_t>() ==
+           0xc0de'c0de'c0de'c0de);
+
+    auto read_dst12 = mh9->read(core1_l1d, 0x100, 8);
+    assert(read_dst12.hit_level == 2);
+    assert(read_dst12.data.get<uint64_t>() == 0xc0de'c0de'c0de'c0de);
+
+    // clones have the same ports
+    auto mh10 = mh9->clone();
+    assert(mh10->get_port_names() == mh9->get_port_names());
+    assert(mh10->read(core1_l1d, 0x100, 8).hit_level == 0);
+
+    bool port_thrown = false;
+    try {
+        mh9->read(4, 0, 8);
+    } catch (const std::out_of_range& e) {
+        port_thrown = true;
+    }
+    assert(port_thrown);
+
+    // in concurrent mode every port can be used by its own thread, only the shared l2
+    // and memory are locked
+    auto mh11 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    mh11->set_concurrent(true);
+
+    auto core0_l1d_cache = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh11->get_data_storage("core0_l1d"));
+    auto l2_cache =
+        std::dynamic_pointer_cast<SetAssociativeCache>(mh11->get_data_storage("l2"));
+    assert(!core0_l1d_cache->is_concurrent());
+    assert(l2_cache->is_concurrent());
+    assert(l2_cache->get_mshrs() == 4);
+
+    // the ports of a timed hierarchy share the global clock
+    bool timed_thrown = false;
+    try {
+        mh11->set_timed(true);
+    } catch (const std::runtime_error& e) {
+        timed_thrown = true;
+    }
+    assert(timed_thrown);
+    assert(!mh11->is_timed());
+
+    auto mh11_timed = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    mh11_timed->set_timed(true);
+    bool concurrent_thrown = false;
+    try {
+        mh11_timed->set_concurrent(true);
+    } catch (const std::runtime_error& e) {
+        concurrent_thrown = true;
+    }
+    assert(concurrent_thrown);
+
+    auto access_port = [&mh11](size_t port, address_t start_address) {
+        for (address_t address = start_address; address < start_address + 2048;
+             address += 8) {
+            Data data = Data(8);
+            data.set<uint64_t>(address * 0x0101'0101);
+            mh11->write(port, address, data);
+        }
+        for (address_t address = start_address; address < start_address + 2048;
+             address += 8) {
+            auto dst = mh11->read(port, address, 8);
+            assert(dst.data.get<uint64_t>() == address * 0x0101'0101);
+        }
+    };
+
+    std::thread core0_thread(access_port, mh11->get_port("core0_l1d"), 0);
+    std::thread core1_thread(access_port, mh11->get_port("core1_l1d"), 2048);
+    core0_thread.join();
+    core1_thread.join();
+
+    mh11->flush_all_caches();
+    for (address_t address = 0; address < 4096; address += 8) {
+        auto dst = mh11->top_level_memory->read(address, 8);
+        assert(dst.data.get<uint64_t>() == address * 0x0101'0101);
+    }
+
+    // stats of all threads are summed up
+    CacheStats core0_l1d_stats = core0_l1d_cache->get_stats();
+    assert(core0_l1d_stats.write_hits + core0_l1d_stats.write_misses == 256);
+    assert(core0_l1d_stats.read_hits + core0_l1d_stats.read_misses == 256);
+
+    CacheStats l2_stats = l2_cache->get_stats();
+    assert(l2_stats.read_misses > 0);
+    assert(l2_stats.write_backs > 0);
+
+    // in timed mode accesses are issued in the cycle of the global clock
+    auto mh12 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    mh12->set_timed(true);
+    assert(mh12->is_timed());
+
+    auto timed_dst0 = mh12->read(core0_l1d, 0x100, 8);
+    assert(timed_dst0.completion_cycle == 5 + 11 + 23);
+
+    // a second miss is issued before the first one completed
+    mh12->advance(1);
+    auto timed_dst1 = mh12->read(core1_l1d, 0x200, 8);
+    assert(timed_dst1.completion_cycle == 1 + 5 + 11 + 23);
+
+    mh12->advance_to(timed_dst0.completion_cycle);
+    assert(mh12->get_cycle() == 39);
+    auto timed_dst2 = mh12->read(core0_l1d, 0x100, 8);
+    assert(timed_dst2.completion_cycle == 39 + 3);
+
+    bool cycle_thrown = false;
+    try {
+        mh12->advance_to(0);
+    } catch (const std::invalid_argument& e) {
+        cycle_thrown = true;
+    }
+    assert(cycle_thrown);
+
+    // prefetchers are attached per cache
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy5.yaml");
+
+    auto mh13 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    assert(mh13->get_config().caches[0].prefetcher == STRIDE_PREFETCHER);
+    assert(mh13->get_config().caches[0].prefetch_degree == 4);
+    assert(mh13->get_config().caches[1].prefetcher == STREAM_PREFETCHER);
+
+    for (address_t address = 0; address < 1024; address += 8) {
+        Data data = Data(8);
+        data.set<uint64_t>(address * 0x0303'0303);
+        mh13->top_level_memory->write(address, data);
+    }
+
+    // a sequential scan only misses until the stride was detected
+    for (address_t address = 0; address < 1024; address += 8) {
+        auto dst = mh13->read(address, 8);
+        assert(dst.data.get<uint64_t>() == address * 0x0303'0303);
+    }
+
+    auto l1_prefetch_cache = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh13->get_data_storage("l1_dcache"));
+    auto l2_prefetch_cache = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh13->get_data_storage("l2_dcache"));
+    assert(l1_prefetch_cache->get_prefetcher() != nullptr);
+
+    CacheStats l1_prefetch_stats = l1_prefetch_cache->get_stats();
+    assert(l1_prefetch_stats.read_misses < 4);
+    assert(l1_prefetch_stats.prefetches_useful > 28);
+
+    // the prefetches of the first level cache train the stream prefetcher
+    CacheStats l2_prefetch_stats = l2_prefetch_cache->get_stats();
+    assert(l2_prefetch_stats.prefetches_issued > 0);
+    assert(l2_prefetch_stats.prefetches_useful > 0);
+
+    bool prefetcher_thrown = false;
+    try {
+        auto unknown_prefetcher_config = yaml_config_string;
+        unknown_prefetcher_config.replace(unknown_prefetcher_config.find("stride"), 6,
+                                          "markov");
+        auto mh14 = std::make_unique<MemoryHierarchy>(unknown_prefetcher_config);
+    } catch (const std::invalid_argument& e) {
+        prefetcher_thrown = true;
+    }
+    assert(prefetcher_thrown);
+
+    // a direct mapped cache with a victim cache of 4 blocks
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy6.yaml");
+
+    auto mh15 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    assert(mh15->get_config().caches[0].victim_cache_size == 128);
+    assert(mh15->get_config().caches[0].victim_cache_latency == 2);
+
+    // blocks mapping to the same set are served by the victim cache after the first
+    // round
+    for (int round = 0; round < 4; round++) {
+        for (address_t address = 0; address < 1024; address += 256) {
+            auto dst = mh15->read(address, 8);
+            assert(dst.hit_level == (round == 0 ? 1 : 0));
+        }
+    }
+
+    auto victim_l1 = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh15->get_data_storage("l1_dcache"));
+    assert(victim_l1->get_victim_cache()->get_entries() == 4);
+    assert(victim_l1->get_stats().victim_hits == 12);
+
+    // a fully associative first level cache with 8 entries
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy7.yaml");
+
+    auto mh16 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    assert(mh16->get_config().caches[0].type == FULLY_ASSOCIATIVE_CACHE);
+    assert(mh16->get_config().caches[0].ways == 8);
+
+    // blocks mapping to the same set of a set associative cache don't conflict
+    for (int round = 0; round < 2; round++) {
+        for (address_t address = 0; address < 4096; address += 512) {
+            auto dst = mh16->read(address, 8);
+            assert(dst.hit_level == (round == 0 ? 1 : 0));
+        }
+    }
+
+    auto fully_associative_l1 = std::dynamic_pointer_cast<FullyAssociativeCache>(
+        mh16->get_data_storage("l1_dcache"));
+    assert(fully_associative_l1->get_valid_entry_count() == 8);
+
+    // a skewed associative first level cache with the capacity of 16 sets and 4 ways
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy8.yaml");
+
+    auto mh17 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    assert(mh17->get_config().caches[0].type == SKEWED_ASSOCIATIVE_CACHE);
+    assert(mh17->get_config().caches[0].skewed_replacement_policy == SKEWED_NRU);
+
+    auto skewed_l1 = std::dynamic_pointer_cast<SkewedAssociativeCache>(
+        mh17->get_data_storage("l1_dcache"));
+    assert(skewed_l1->size() == 16 * 4 * 32);
+
+    Data skewed_data = Data(8);
+    skewed_data.set<uint64_t>(0x0123'4567'89ab'cdef);
+    mh17->write(0x2000, skewed_data);
+    assert(mh17->read(0x2000, 8).hit_level == 0);
+    mh17->flush_all_caches();
+    assert(mh17->top_level_memory->read(0x2000, 8).data.get<uint64_t>() ==
+           0x0123'4567'89ab'cdef);
+
+    // a first level cache with 4 banks of 8 byte units
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy9.yaml");
+
+    auto mh18 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    assert(mh18->get_config().caches[0].banks == 4);
+    assert(mh18->get_config().caches[0].bank_function == XOR_INDEX);
+
+    auto banked_l1 = std::dynamic_pointer_cast<SetAssociativeCache>(
+        mh18->get_data_storage("l1_dcache"));
+    assert(banked_l1->get_banks()->get_bank_width() == 8);
+
+    // a block covers all banks, the second block of an access waits for the first
+    mh18->read(0x00, 64);
+    assert(mh18->read(0x00, 32).latency == 3);
+    assert(mh18->read(0x00, 64).latency == 1 + 3);
+
+    // a first level cache in front of a DRAM with 2 channels of 4 banks
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy10.yaml");
+
+    auto mh19 = std::make_unique<MemoryHierarchy>(yaml_config_string);
+    assert(mh19->get_config().memories[0].type == DRAM_MEMORY);
+    assert(mh19->get_config().memories[0].dram_timings.t_ras == 25);
+
+    auto dram = std::dynamic_pointer_cast<DramMemory>(mh19->top_level_memory);
+    assert(dram != nullptr);
+    assert(dram->get_channels() == 2);
+    assert(dram->get_row_policy() == OPEN_ROW_POLICY);
+
+    // the second block of the row hits in the open row
+    assert(mh19->read(0x000, 8).latency == 5 + 2 + 10 + 10 + 4);
+    assert(mh19->read(0x020, 8).latency == 5 + 2 + 10 + 4);
+    assert(dram->get_stats().row_hits == 1);
+
+    // memory hierarchies sharing one base image copy-on-write
+    auto base_image = std::make_shared<DenseBackingStore>(1024);
+    FakeMemory("base_image", base_image, 0, 0)
+        .read_bin_memory_file("../data/bin_data0.mem");
+
+    yaml_config_string = read_file_into_string("../data/memory_hierarchy0.yaml");
+
+    auto mh3 = std::make_unique<MemoryHierarchy>(yaml_config_string, base_image);
+    auto mh4 = std::make_unique<MemoryHierarchy>(yaml_config_string, base_image);
+
+    assert(mh3->read(0, 8).data.get<uint64_t>() == 0x12340a0abeefdead);
+    assert(mh4->read(0, 8).data.get<uint64_t>() == 0x12340a0abeefdead);
+
+    Data shared_data = Data(8);
+    shared_data.set<uint64_t>(0x0102'0304'0506'0708);
+    mh3->write(0, shared_data);
+    mh3->flush_all_caches();
+
+    // writes are private to the hierarchy
+    assert(mh3->top_level_memory->read(0, 8).data.get<uint64_t>() ==
+           0x0102'0304'0506'0708);
+    assert(mh3->top_level_memory->read(8, 8).data.get<uint64_t>() ==
+           0x010000eeff012345);
+    assert(mh4->top_level_memory->read(0, 8).data.get<uint64_t>() ==
+           0x12340a0abeefdead);
+
+    uint64_t base_value = 0;
+    base_image->read(0, reinterpret_cast<uint8_t*>(&base_value), 8);
+    assert(base_value == 0x12340a0abeefdead);
+
+    // base images can't be combined with memories of a different size
+    bool thrown = false;
+    try {
+        yaml_config_string = read_file_into_string("../data/memory_hierarchy2.yaml");
+        auto mh5 = std::make_unique<MemoryHierarchy>(yaml_config_string, base_image);
+    } catch (const std::invalid_argument& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
     return 0;
 }
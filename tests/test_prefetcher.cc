@@ -0,0 +1,95 @@
+#include <cassert>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+int main() {
+    // next line prefetcher only prefetches on misses
+    auto next_line = std::make_shared<NextLinePrefetcher>(64, 2);
+    assert(next_line->access(0, 0x108, true) == std::vector<address_t>({0x140, 0x180}));
+    assert(next_line->access(0, 0x108, false).empty());
+
+    // stride prefetcher prefetches once a stride was seen twice
+    auto stride = std::make_shared<StridePrefetcher>(64, 2);
+    assert(stride->access(0x400, 0x1000, true).empty());
+    assert(stride->access(0x400, 0x1100, true).empty());
+    assert(stride->access(0x400, 0x1200, true) ==
+           std::vector<address_t>({0x1300, 0x1400}));
+
+    // instructions are tracked independently
+    assert(stride->access(0x404, 0x2000, true).empty());
+    assert(stride->access(0x404, 0x1f00, true).empty());
+    assert(stride->access(0x404, 0x1e00, false) ==
+           std::vector<address_t>({0x1d00, 0x1c00}));
+    assert(stride->access(0x400, 0x1300, false) ==
+           std::vector<address_t>({0x1400, 0x1500}));
+
+    // a different stride has to be confirmed again
+    assert(stride->access(0x400, 0x1380, false).empty());
+    assert(stride->access(0x400, 0x1400, false) ==
+           std::vector<address_t>({0x1480, 0x1500}));
+
+    // strides smaller than a block skip the current block
+    auto small_stride = std::make_shared<StridePrefetcher>(64, 8);
+    small_stride->access(0, 0, true);
+    small_stride->access(0, 8, false);
+    assert(small_stride->access(0, 16, false) == std::vector<address_t>({64}));
+
+    // clones are trained independently, reset forgets all strides
+    auto stride_clone = stride->clone();
+    stride->reset();
+    assert(stride->access(0x400, 0x1480, false).empty());
+    assert(stride_clone->access(0x400, 0x1480, false) ==
+           std::vector<address_t>({0x1500, 0x1580}));
+
+    // stream prefetcher starts a stream with the second adjacent miss
+    auto stream = std::make_shared<StreamPrefetcher>(64, 2, 2);
+    assert(stream->access(0, 10 * 64, true).empty());
+    assert(stream->access(0, 11 * 64, true) ==
+           std::vector<address_t>({12 * 64, 13 * 64}));
+
+    // accesses within the stream keep the prefetches degree blocks ahead
+    assert(stream->access(0, 12 * 64 + 8, false) == std::vector<address_t>({14 * 64}));
+    assert(stream->access(0, 14 * 64, false) ==
+           std::vector<address_t>({15 * 64, 16 * 64}));
+
+    // descending streams
+    assert(stream->access(0, 100 * 64, true).empty());
+    assert(stream->access(0, 99 * 64, true) ==
+           std::vector<address_t>({98 * 64, 97 * 64}));
+
+    // a new stream replaces the least recently used one
+    assert(stream->access(0, 200 * 64, true).empty());
+    assert(stream->access(0, 15 * 64, false).empty());
+    assert(stream->access(0, 98 * 64, false) == std::vector<address_t>({96 * 64}));
+
+    stream->reset();
+    assert(stream->access(0, 97 * 64, false).empty());
+
+    // blocks which leave the address space aren't prefetched
+    address_t last_block = std::numeric_limits<address_t>::max() / 64;
+    assert(next_line->access(0, last_block * 64 + 8, true).empty());
+
+    auto descending_stride = std::make_shared<StridePrefetcher>(64, 2);
+    descending_stride->access(0x408, 0x180, true);
+    descending_stride->access(0x408, 0x100, true);
+    assert(descending_stride->access(0x408, 0x080, true) ==
+           std::vector<address_t>({0x000}));
+
+    auto edge_stream = std::make_shared<StreamPrefetcher>(64, 2, 2);
+    edge_stream->access(0, 0x40, true);
+    assert(edge_stream->access(0, 0x00, true).empty());
+    edge_stream->access(0, (last_block - 1) * 64, true);
+    assert(edge_stream->access(0, last_block * 64, true).empty());
+
+    // prefetchers are created by type
+    assert(Prefetcher::create(NO_PREFETCHER, 64, 1) == nullptr);
+    assert(std::dynamic_pointer_cast<StreamPrefetcher>(
+               Prefetcher::create(STREAM_PREFETCHER, 64, 1)) != nullptr);
+
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <map>
 #include <memory>
 #include <numeric>
+#include <thread>
 #include <vector>
 
 #include "kachesim/doubly_linked_list/doubly_linked_list.h"
@@ -1098,5 +1099,664 @@ int main() {
 
         assert(read_dst.data == write_data);
     }
+
+    // write through caches never contain dirty blocks
+    assert(sac3->get_dirty_block_count() == 0);
+
+    // reset invalidates all blocks without writing them back
+    sac3->reset();
+
+    for (uint64_t i = 0; i < fm->size(); i++) {
+        assert(!sac3->is_address_cached(i));
+        assert(!sac3->is_address_valid(i));
+    }
+
+    // blocks are allocated again after the reset
+    auto read_dst23 = sac3->read(0x0010, 8);
+
+    assert(read_dst23.hit_level == 1);
+    assert(read_dst23.data.get<uint64_t>() == fm->read(0x0010, 8).data.get<uint64_t>());
+    assert(sac3->is_address_cached(0x0010));
+
+    auto read_dst24 = sac3->read(0x0010, 8);
+    assert(read_dst24.hit_level == 0);
+
+    // only dirty blocks are written back on flush
+    fm->reset();
+
+    write_allocate = true;
+    write_through = false;
+
+    auto sac4 = std::make_shared<SetAssociativeCache>(
+        "sac4", fm, write_allocate, write_through, sac_miss_latency, sac_hit_latency,
+        cache_block_size, sets, ways, ReplacementPolicyType::LRU);
+
+    assert(sac4->get_dirty_block_count() == 0);
+
+    sac4->read(0x0000, 8);
+    sac4->read(0x0008, 8);
+    assert(sac4->get_dirty_block_count() == 0);
+
+    auto d_block9 = Data(8);
+    d_block9.set<uint64_t>(0x2222'2222'2222'2222);
+    sac4->write(0x0008, d_block9);
+    sac4->write(0x0020, d_block9);
+    sac4->write(0x0028, d_block9);
+    assert(sac4->get_dirty_block_count() == 3);
+    assert(sac4->is_address_dirty(0x0008));
+    assert(!sac4->is_address_dirty(0x0000));
+
+    // writing the same block again does not change the number of dirty blocks
+    sac4->write(0x0008, d_block9);
+    assert(sac4->get_dirty_block_count() == 3);
+
+    auto flush_dst0 = sac4->flush();
+
+    assert(flush_dst0.hit_level == 1);
+    assert(flush_dst0.latency == 3 * fm_write_latency);
+    assert(sac4->get_dirty_block_count() == 0);
+    assert(!sac4->is_address_cached(0x0008));
+
+    assert(fm->read(0x0000, 8).data.get<uint64_t>() == 0);
+    assert(fm->read(0x0008, 8).data.get<uint64_t>() == 0x2222'2222'2222'2222);
+    assert(fm->read(0x0020, 8).data.get<uint64_t>() == 0x2222'2222'2222'2222);
+    assert(fm->read(0x0028, 8).data.get<uint64_t>() == 0x2222'2222'2222'2222);
+
+    // flushing a clean cache does not access the next level data storage
+    auto flush_dst1 = sac4->flush();
+    assert(flush_dst1.hit_level == 0);
+    assert(flush_dst1.latency == 0);
+
+    // dirty blocks which are evicted are no longer counted
+    sac4->write(0x0000, d_block9);
+    sac4->write(0x0020, d_block9);
+    sac4->write(0x0040, d_block9);
+    assert(sac4->get_dirty_block_count() == 2);
+
+    // dirty blocks are dropped on reset
+    sac4->reset();
+    assert(sac4->get_dirty_block_count() == 0);
+    auto flush_dst2 = sac4->flush();
+    assert(flush_dst2.latency == 0);
+
+    // hits, misses and write backs are counted per block
+    sac4->reset_stats();
+    sac4->write(0x0000, d_block9);
+    sac4->write(0x0000, d_block9);
+    sac4->read(0x0020, 8);
+    sac4->read(0x0040, 8);
+    sac4->read(0x0000, 8);
+
+    CacheStats stats0 = sac4->get_stats();
+    assert(stats0.write_hits == 1);
+    assert(stats0.write_misses == 1);
+    assert(stats0.read_hits == 0);
+    assert(stats0.read_misses == 3);
+    assert(stats0.write_backs == 1);
+
+    // stats are kept when switching to concurrent mode
+    sac4->set_concurrent(true);
+    sac4->read(0x0000, 8);
+    CacheStats stats1 = sac4->get_stats();
+    assert(stats1.read_hits == 1);
+    assert(stats1.read_misses == 3);
+
+    // evicted and flushed dirty blocks are no longer counted in concurrent mode
+    sac4->reset();
+    sac4->write(0x0000, d_block9);
+    sac4->write(0x0020, d_block9);
+    sac4->read(0x0040, 8);
+    assert(sac4->get_dirty_block_count() == 1);
+    sac4->read(0x0000, 8);
+    assert(sac4->get_dirty_block_count() == 0);
+    sac4->write(0x0000, d_block9);
+    sac4->flush();
+    assert(sac4->get_dirty_block_count() == 0);
+
+    // timed mode with 2 MSHRs
+    auto fm_timed = std::make_shared<FakeMemory>("fm_timed", 1024, 20, 30);
+    auto sac5 = std::make_shared<SetAssociativeCache>(
+        "sac5", fm_timed, write_allocate, write_through, 5, 3, cache_block_size, sets,
+        ways, ReplacementPolicyType::LRU, 1, 2);
+    assert(sac5->get_mshrs() == 2);
+
+    // memories complete after their latency
+    assert(fm_timed->read_at(100, 0x0000, 8).completion_cycle == 120);
+
+    // misses to different blocks are outstanding at the same time
+    auto timed_dst0 = sac5->read_at(0, 0x0000, 8);
+    assert(timed_dst0.hit_level == 1);
+    assert(timed_dst0.completion_cycle == 5 + 20);
+    auto timed_dst1 = sac5->read_at(1, 0x0008, 8);
+    assert(timed_dst1.completion_cycle == 1 + 5 + 20);
+    assert(sac5->get_outstanding_miss_count(1) == 2);
+
+    // an access to a block with an outstanding miss is merged into its MSHR
+    auto timed_dst2 = sac5->read_at(2, 0x0000, 8);
+    assert(timed_dst2.hit_level == 0);
+    assert(timed_dst2.completion_cycle == 25);
+
+    // all MSHRs are in use, the miss waits until the first one is free
+    auto timed_dst3 = sac5->read_at(3, 0x0010, 8);
+    assert(timed_dst3.completion_cycle == 25 + 5 + 20);
+    assert(timed_dst3.latency == 50 - 3);
+
+    // hit under miss
+    auto timed_dst4 = sac5->read_at(30, 0x0000, 8);
+    assert(timed_dst4.completion_cycle == 30 + 3);
+    assert(sac5->get_outstanding_miss_count(30) == 1);
+
+    // the blocks of one access are issued in parallel
+    auto timed_dst5 = sac5->read_at(60, 0x0018, 16);
+    assert(timed_dst5.completion_cycle == 60 + 5 + 20);
+
+    auto d_block10 = Data(8);
+    d_block10.set<uint64_t>(0x3333'3333'3333'3333);
+    auto timed_dst6 = sac5->write_at(90, 0x0000, d_block10);
+    assert(timed_dst6.completion_cycle == 90 + 3);
+
+    CacheStats stats2 = sac5->get_stats();
+    assert(stats2.mshr_merges == 1);
+    assert(stats2.mshr_stalls == 1);
+
+    // untimed accesses still sum up the latency
+    assert(sac5->read(0x0000, 8).latency == 3);
+
+    // timed accesses from multiple threads, each thread issues in its own cycles
+    auto fm_concurrent = std::make_shared<FakeMemory>("fm_concurrent", 65536, 20, 30);
+    fm_concurrent->set_concurrent(true);
+    auto sac20 = std::make_shared<SetAssociativeCache>(
+        "sac20", fm_concurrent, write_allocate, write_through, 5, 3, 64, 256, 4,
+        ReplacementPolicyType::LRU, 1, 4);
+    sac20->set_concurrent(true);
+
+    auto access_timed = [&sac20](address_t start_address) {
+        cycle_t cycle = 0;
+        for (address_t address = start_address; address < start_address + 4096;
+             address += 8) {
+            Data data = Data(8);
+            data.set<uint64_t>(address * 0x0101'0101);
+            auto write_dst = sac20->write_at(cycle, address, data);
+            assert(write_dst.completion_cycle == cycle + write_dst.latency);
+
+            // the block was loaded by the write, so the read hits without waiting
+            auto read_dst = sac20->read_at(write_dst.completion_cycle, address, 8);
+            assert(read_dst.hit_level == 0);
+            assert(read_dst.latency == 3);
+            assert(read_dst.data.get<uint64_t>() == address * 0x0101'0101);
+            cycle = read_dst.completion_cycle;
+        }
+    };
+
+    std::vector<std::thread> timed_threads;
+    for (address_t start_address = 0; start_address < 16384; start_address += 4096) {
+        timed_threads.emplace_back(access_timed, start_address);
+    }
+    for (auto& timed_thread : timed_threads) {
+        timed_thread.join();
+    }
+
+    CacheStats stats_concurrent = sac20->get_stats();
+    assert(stats_concurrent.read_hits == 2048);
+    assert(stats_concurrent.write_misses == 256);
+    assert(stats_concurrent.write_hits == 2048 - 256);
+
+    // next line prefetching with 16 byte blocks, 4 sets and 2 ways
+    auto fm_prefetch = std::make_shared<FakeMemory>("fm_prefetch", 4096, 20, 30);
+    for (address_t address = 0; address < 4096; address += 8) {
+        Data data = Data(8);
+        data.set<uint64_t>(address * 0x0707'0707);
+        fm_prefetch->write(address, data);
+    }
+
+    auto sac6 = std::make_shared<SetAssociativeCache>(
+        "sac6", fm_prefetch, write_allocate, write_through, 5, 1, 16, 4, 2,
+        ReplacementPolicyType::LRU, 1, 2);
+    sac6->set_prefetcher(std::make_shared<NextLinePrefetcher>(16, 1));
+
+    // only the first block misses, every first access to a prefetched block prefetches
+    // the next one
+    for (address_t address = 0; address < 0x40; address += 8) {
+        auto dst = sac6->read(address, 8);
+        assert(dst.data.get<uint64_t>() == address * 0x0707'0707);
+        assert(dst.hit_level == (address == 0 ? 1 : 0));
+    }
+    assert(sac6->is_address_cached(0x40));
+
+    CacheStats stats3 = sac6->get_stats();
+    assert(stats3.read_misses == 1);
+    assert(stats3.read_hits == 7);
+    assert(stats3.prefetches_issued == 4);
+    assert(stats3.prefetches_useful == 3);
+
+    // the prefetched block 0x40 is evicted without being accessed
+    sac6->read(0x80, 8);
+    sac6->read(0xc0, 8);
+    CacheStats stats4 = sac6->get_stats();
+    assert(stats4.prefetches_issued == 6);
+    assert(stats4.prefetches_polluting == 1);
+
+    // in timed mode a prefetch holds an MSHR, accesses to it before it completes are
+    // late and prefetches are dropped if all MSHRs are in use
+    sac6->reset();
+    sac6->reset_stats();
+    sac6->read_at(0, 0x00, 8);
+    auto prefetch_dst0 = sac6->read_at(10, 0x10, 8);
+    assert(prefetch_dst0.hit_level == 0);
+    assert(prefetch_dst0.completion_cycle == 5 + 20);
+    assert(prefetch_dst0.data.get<uint64_t>() == 0x10 * 0x0707'0707);
+    assert(!sac6->is_address_cached(0x20));
+
+    CacheStats stats5 = sac6->get_stats();
+    assert(stats5.prefetches_issued == 1);
+    assert(stats5.prefetches_useful == 1);
+    assert(stats5.prefetches_late == 1);
+    assert(stats5.prefetches_dropped == 1);
+
+    // clones get their own prefetcher
+    auto sac7 =
+        std::dynamic_pointer_cast<SetAssociativeCache>(sac6->clone(fm_prefetch));
+    assert(sac7->get_prefetcher() != nullptr);
+    assert(sac7->get_prefetcher() != sac6->get_prefetcher());
+
+    // prefetching isn't supported in concurrent mode
+    bool concurrent_thrown = false;
+    try {
+        sac6->set_concurrent(true);
+    } catch (const std::runtime_error& e) {
+        concurrent_thrown = true;
+    }
+    assert(concurrent_thrown);
+
+    // direct mapped cache with 16 byte blocks, 4 sets and a victim cache of one block
+    auto sac8 = std::make_shared<SetAssociativeCache>(
+        "sac8", fm_prefetch, write_allocate, write_through, 5, 1, 16, 4, 1,
+        ReplacementPolicyType::LRU);
+    auto victim_cache = std::make_shared<VictimCache>(16, 1, 2);
+    sac8->set_victim_cache(victim_cache);
+
+    assert(sac8->read(0x00, 8).latency == 5 + 20);
+    assert(sac8->read(0x40, 8).latency == 5 + 20);
+    assert(victim_cache->contains(0x00));
+
+    // the conflicting blocks are swapped between the cache and the victim cache
+    sac8->reset_stats();
+    auto victim_dst0 = sac8->read(0x00, 8);
+    assert(victim_dst0.hit_level == 0);
+    assert(victim_dst0.latency == 5 + 2);
+    assert(victim_dst0.data.get<uint64_t>() == 0x00);
+    assert(victim_cache->contains(0x40));
+    assert(!victim_cache->contains(0x00));
+
+    // dirty blocks are only written back when they leave the victim cache
+    auto d_block11 = Data(8);
+    d_block11.set<uint64_t>(0x4444'4444'4444'4444);
+    assert(sac8->write(0x48, d_block11).hit_level == 0);
+    assert(sac8->is_address_dirty(0x40));
+
+    sac8->read(0x80, 8);
+    assert(victim_cache->contains(0x40));
+    assert(fm_prefetch->read(0x48, 8).data.get<uint64_t>() == 0x48ull * 0x0707'0707);
+
+    sac8->read(0xc0, 8);
+    assert(!victim_cache->contains(0x40));
+    assert(fm_prefetch->read(0x48, 8).data.get<uint64_t>() == 0x4444'4444'4444'4444);
+
+    CacheStats stats6 = sac8->get_stats();
+    assert(stats6.victim_hits == 2);
+    assert(stats6.write_backs == 1);
+
+    // hits in the victim cache count as hits, they don't access the next level
+    assert(stats6.read_hits == 1);
+    assert(stats6.read_misses == 2);
+    assert(stats6.write_hits == 1);
+    assert(stats6.write_misses == 0);
+
+    // flushing writes back the dirty blocks of the victim cache
+    sac8->write(0x100, d_block11);
+    sac8->read(0x140, 8);
+    assert(victim_cache->contains(0x100));
+    sac8->flush();
+    assert(victim_cache->get_entry_count() == 0);
+    assert(fm_prefetch->read(0x100, 8).data.get<uint64_t>() == 0x4444'4444'4444'4444);
+
+    // a full write drops the outdated copy in the victim cache
+    sac8->read(0x00, 8);
+    sac8->read(0x40, 8);
+    auto d_block12 = Data(16);
+    d_block12.set<uint64_t>(0x5555'5555'5555'5555);
+    sac8->write(0x00, d_block12);
+    assert(!victim_cache->contains(0x00));
+    assert(sac8->read(0x00, 8).data.get<uint64_t>() == 0x5555'5555'5555'5555);
+
+    // 12 sets with XOR folded indices, write backs restore the address of each block
+    auto fm_index = std::make_shared<FakeMemory>("fm_index", 1 << 16, 20, 30);
+    auto sac9 = std::make_shared<SetAssociativeCache>(
+        "sac9", fm_index, write_allocate, write_through, 5, 1, 16, 12, 2,
+        ReplacementPolicyType::LRU, 1, 0, XOR_INDEX);
+    assert(sac9->size() == 12 * 2 * 16);
+
+    for (address_t address = 0; address < (1 << 16); address += 16 * 12) {
+        Data data = Data(8);
+        data.set<uint64_t>(address);
+        sac9->write(address, data);
+    }
+    sac9->flush();
+
+    for (address_t address = 0; address < (1 << 16); address += 16 * 12) {
+        assert(fm_index->read(address, 8).data.get<uint64_t>() == address);
+    }
+
+    // blocks which share a set with modulo indexing are spread over the sets
+    auto sac10 = std::make_shared<SetAssociativeCache>(
+        "sac10", fm_index, write_allocate, write_through, 5, 1, 16, 12, 2,
+        ReplacementPolicyType::LRU);
+    sac9->reset();
+    sac9->reset_stats();
+
+    for (int round = 0; round < 2; round++) {
+        for (address_t address = 0; address < 12 * 16 * 12; address += 16 * 12) {
+            sac9->read(address, 8);
+            sac10->read(address, 8);
+        }
+    }
+    assert(sac9->get_stats().read_hits == 12);
+    assert(sac10->get_stats().read_hits == 0);
+
+    // 64 byte blocks with 4 sectors of 16 bytes, only the accessed sectors are loaded
+    auto fm_sector = std::make_shared<FakeMemory>("fm_sector", 4096, 20, 30);
+    for (address_t address = 0; address < 4096; address += 8) {
+        Data data = Data(8);
+        data.set<uint64_t>(address);
+        fm_sector->write(address, data);
+    }
+
+    auto sac11 = std::make_shared<SetAssociativeCache>(
+        "sac11", fm_sector, true, false, 5, 1, 64, 2, 2, ReplacementPolicyType::LRU, 1,
+        0, MODULO_INDEX, 4);
+    assert(sac11->get_sectors() == 4);
+
+    auto sector_miss_dst = sac11->read(0x08, 8);
+    assert(sector_miss_dst.latency == 5 + 20);
+    assert(sector_miss_dst.hit_level == 1);
+    assert(sector_miss_dst.data.get<uint64_t>() == 0x08);
+    assert(sac11->get_stats().next_level_bytes_read == 16);
+    assert(sac11->is_address_valid(0x00));
+    assert(!sac11->is_address_valid(0x10));
+
+    assert(sac11->read(0x00, 16).hit_level == 0);
+
+    // the block is cached but the accessed sector isn't valid
+    auto sector_dst = sac11->read(0x18, 8);
+    assert(sector_dst.hit_level == 1);
+    assert(sector_dst.data.get<uint64_t>() == 0x18);
+    assert(sac11->get_stats().next_level_bytes_read == 32);
+
+    // only the missing sector of an access spanning two sectors is loaded
+    auto spanning_dst = sac11->read(0x1c, 8);
+    assert(spanning_dst.hit_level == 1);
+    assert(spanning_dst.data.get<uint32_t>(4) == 0x20);
+    assert(sac11->get_stats().next_level_bytes_read == 48);
+
+    // a write covering a whole sector doesn't load it
+    auto d_sector = Data(16);
+    d_sector.set<uint64_t>(0x6666'6666'6666'6666);
+    assert(sac11->write(0x30, d_sector).hit_level == 0);
+    assert(sac11->get_stats().next_level_bytes_read == 48);
+    assert(sac11->is_address_dirty(0x30));
+    assert(!sac11->is_address_dirty(0x00));
+
+    // a partial write loads the partially written sector only
+    auto d_partial = Data(4);
+    d_partial.set<uint32_t>(0x7777'7777);
+    auto partial_dst = sac11->write(0x84, d_partial);
+    assert(partial_dst.hit_level == 1);
+    assert(partial_dst.latency == 5 + 20);
+    assert(sac11->get_stats().next_level_bytes_read == 64);
+    assert(sac11->write(0x90, d_sector).hit_level == 0);
+
+    CacheStats stats7 = sac11->get_stats();
+    assert(stats7.read_hits == 1);
+    assert(stats7.read_misses == 3);
+    assert(stats7.sector_misses == 2);
+    assert(stats7.write_hits == 2);
+    assert(stats7.write_misses == 1);
+
+    // only dirty sectors are written back, adjacent sectors with one write
+    auto sector_flush_dst = sac11->flush();
+    assert(sector_flush_dst.latency == 2 * 30);
+
+    CacheStats stats8 = sac11->get_stats();
+    assert(stats8.write_backs == 2);
+    assert(stats8.next_level_bytes_written == 16 + 32);
+    assert(fm_sector->read(0x30, 8).data.get<uint64_t>() == 0x6666'6666'6666'6666);
+    assert(fm_sector->read(0x38, 8).data.get<uint64_t>() == 0);
+    assert(fm_sector->read(0x80, 8).data.get<uint64_t>() == 0x7777'7777'0000'0080);
+    assert(fm_sector->read(0x88, 8).data.get<uint64_t>() == 0x88);
+    assert(fm_sector->read(0x90, 8).data.get<uint64_t>() == 0x6666'6666'6666'6666);
+
+    // an evicted block only writes back its dirty sector
+    sac11->write(0x120, d_sector);
+    sac11->read(0x200, 8);
+    sac11->read(0x300, 8);
+    assert(!sac11->is_address_cached(0x120));
+    assert(sac11->get_stats().next_level_bytes_written == 16 + 32 + 16);
+    assert(fm_sector->read(0x120, 8).data.get<uint64_t>() == 0x6666'6666'6666'6666);
+    assert(fm_sector->read(0x110, 8).data.get<uint64_t>() == 0x110);
+
+    // sectors have to divide the block
+    bool sectors_thrown = false;
+    try {
+        SetAssociativeCache("sac12", fm_sector, true, false, 5, 1, 64, 2, 2,
+                            ReplacementPolicyType::LRU, 1, 0, MODULO_INDEX, 3);
+    } catch (const std::invalid_argument& e) {
+        sectors_thrown = true;
+    }
+    assert(sectors_thrown);
+
+    // partial write misses don't load the block, a read of a byte which wasn't written
+    // loads it
+    auto fm_no_fetch = std::make_shared<FakeMemory>("fm_no_fetch", 4096, 20, 30);
+    for (address_t address = 0; address < 4096; address += 8) {
+        Data data = Data(8);
+        data.set<uint64_t>(address);
+        fm_no_fetch->write(address, data);
+    }
+
+    auto sac13 = std::make_shared<SetAssociativeCache>(
+        "sac13", fm_no_fetch, true, false, 5, 1, 64, 2, 2, ReplacementPolicyType::LRU,
+        1, 0, MODULO_INDEX, 1, true);
+    assert(sac13->get_write_no_fetch());
+
+    auto d_no_fetch = Data(4);
+    d_no_fetch.set<uint32_t>(0x1111'1111);
+    auto no_fetch_dst = sac13->write(0x04, d_no_fetch);
+    assert(no_fetch_dst.hit_level == -1);
+    assert(no_fetch_dst.latency == 5);
+    assert(sac13->is_address_valid(0x04));
+    assert(!sac13->is_address_valid(0x00));
+    assert(sac13->is_address_dirty(0x04));
+
+    auto d_no_fetch_word = Data(8);
+    d_no_fetch_word.set<uint64_t>(0x2222'2222'2222'2222);
+    assert(sac13->write(0x08, d_no_fetch_word).latency == 1);
+
+    // only written bytes are read
+    auto written_dst = sac13->read(0x04, 8);
+    assert(written_dst.hit_level == 0);
+    assert(written_dst.data.get<uint64_t>() == 0x2222'2222'1111'1111);
+    assert(sac13->get_stats().next_level_bytes_read == 0);
+
+    auto fill_dst = sac13->read(0x00, 8);
+    assert(fill_dst.hit_level == 1);
+    assert(fill_dst.latency == 5 + 20);
+    assert(fill_dst.data.get<uint64_t>() == 0x1111'1111'0000'0000);
+    assert(sac13->read(0x10, 8).data.get<uint64_t>() == 0x10);
+    assert(sac13->is_address_valid(0x00));
+
+    // a block which wasn't loaded only writes back the written bytes
+    d_no_fetch.set<uint32_t>(0x7777'7777);
+    sac13->write(0x84, d_no_fetch);
+    sac13->write(0x8c, d_no_fetch);
+
+    CacheStats stats9 = sac13->get_stats();
+    assert(stats9.write_misses == 2);
+    assert(stats9.write_hits == 2);
+    assert(stats9.read_misses == 1);
+    assert(stats9.deferred_fills == 1);
+    assert(stats9.next_level_bytes_read == 64);
+
+    auto no_fetch_flush_dst = sac13->flush();
+    assert(no_fetch_flush_dst.latency == 3 * 30);
+
+    CacheStats stats10 = sac13->get_stats();
+    assert(stats10.write_backs == 2);
+    assert(stats10.next_level_bytes_written == 64 + 4 + 4);
+    assert(fm_no_fetch->read(0x00, 8).data.get<uint64_t>() == 0x1111'1111'0000'0000);
+    assert(fm_no_fetch->read(0x80, 8).data.get<uint64_t>() == 0x7777'7777'0000'0080);
+    assert(fm_no_fetch->read(0x88, 8).data.get<uint64_t>() == 0x7777'7777'0000'0088);
+
+    // write no fetch keeps a valid bit per byte instead of sectors
+    bool no_fetch_thrown = false;
+    try {
+        SetAssociativeCache("sac14", fm_no_fetch, true, false, 5, 1, 64, 2, 2,
+                            ReplacementPolicyType::LRU, 1, 0, MODULO_INDEX, 2, true);
+    } catch (const std::invalid_argument& e) {
+        no_fetch_thrown = true;
+    }
+    assert(no_fetch_thrown);
+
+    // a write buffer absorbs the write throughs and merges writes to the same block
+    auto fm_buffer = std::make_shared<FakeMemory>("fm_buffer", 4096, 20, 30);
+    auto sac15 = std::make_shared<SetAssociativeCache>(
+        "sac15", fm_buffer, true, true, 5, 1, 64, 2, 2, ReplacementPolicyType::LRU);
+    sac15->set_write_buffer(std::make_shared<WriteBuffer>(2, 64, DRAIN_WHEN_FULL));
+
+    for (address_t address = 0; address < 64; address += 8) {
+        Data data = Data(8);
+        data.set<uint64_t>(address + 1);
+        auto buffered_dst = sac15->write(address, data);
+        assert(buffered_dst.latency == (address == 0 ? 5 + 20 : 1));
+    }
+    assert(fm_buffer->read(0x08, 8).data.get<uint64_t>() == 0);
+
+    auto d_buffer = Data(8);
+    d_buffer.set<uint64_t>(0x8888'8888'8888'8888);
+    sac15->write(0x40, d_buffer);
+
+    // the third block waits for the oldest entry to drain
+    auto stall_dst = sac15->write(0x80, d_buffer);
+    assert(stall_dst.latency == 5 + 20 + 30);
+    assert(fm_buffer->read(0x08, 8).data.get<uint64_t>() == 0x09);
+    assert(fm_buffer->read(0x40, 8).data.get<uint64_t>() == 0);
+
+    CacheStats stats11 = sac15->get_stats();
+    assert(stats11.write_buffer_merges == 7);
+    assert(stats11.write_buffer_drains == 1);
+    assert(stats11.write_buffer_stalls == 1);
+    assert(stats11.next_level_bytes_written == 64);
+
+    sac15->flush();
+    assert(sac15->get_write_buffer()->get_entry_count() == 0);
+    assert(fm_buffer->read(0x40, 8).data.get<uint64_t>() == 0x8888'8888'8888'8888);
+    assert(fm_buffer->read(0x80, 8).data.get<uint64_t>() == 0x8888'8888'8888'8888);
+
+    // reads from the next level see the buffered bytes
+    auto sac16 = std::make_shared<SetAssociativeCache>(
+        "sac16", fm_buffer, false, false, 5, 1, 64, 2, 2, ReplacementPolicyType::LRU);
+    sac16->set_write_buffer(std::make_shared<WriteBuffer>(2, 16, DRAIN_WHEN_FULL));
+
+    d_buffer.set<uint64_t>(0x9999'9999'9999'9999);
+    assert(sac16->write(0x108, d_buffer).latency == 5);
+    assert(fm_buffer->read(0x108, 8).data.get<uint64_t>() == 0);
+    assert(sac16->read(0x100, 16).data.get<uint64_t>(8) == 0x9999'9999'9999'9999);
+
+    // in timed mode an eager write buffer drains while the next level is free
+    auto sac17 = std::make_shared<SetAssociativeCache>(
+        "sac17", fm_buffer, true, true, 5, 1, 64, 2, 2, ReplacementPolicyType::LRU);
+    sac17->set_write_buffer(std::make_shared<WriteBuffer>(1, 64, DRAIN_EAGER));
+
+    assert(sac17->write_at(0, 0x200, d_buffer).latency == 5 + 20);
+
+    // the entry started draining in cycle 5 and frees its slot in cycle 35
+    auto eager_stall_dst = sac17->write_at(30, 0x208, d_buffer);
+    assert(eager_stall_dst.latency == 1 + 4);
+    assert(fm_buffer->read(0x200, 8).data.get<uint64_t>() == 0x9999'9999'9999'9999);
+
+    // the next level is busy until cycle 35, so the write merges
+    assert(sac17->write_at(32, 0x210, d_buffer).latency == 1);
+
+    CacheStats stats12 = sac17->get_stats();
+    assert(stats12.write_buffer_drains == 1);
+    assert(stats12.write_buffer_stalls == 1);
+    assert(stats12.write_buffer_merges == 1);
+
+    // blocks in different banks are accessed in parallel
+    auto fm_banks = std::make_shared<FakeMemory>("fm_banks", 4096, 20, 30);
+    auto sac18 = std::make_shared<SetAssociativeCache>(
+        "sac18", fm_banks, true, false, 5, 1, 64, 4, 2, ReplacementPolicyType::LRU);
+    sac18->set_banks(std::make_shared<CacheBanks>(2, 64, 1));
+
+    assert(sac18->read(0x00, 128).latency == 5 + 20);
+    assert(sac18->read(0x38, 16).latency == 1);
+
+    // in timed mode back-to-back accesses to the same bank serialize
+    sac18->read(0x80, 8);
+    assert(sac18->read_at(10, 0x00, 8).latency == 1);
+    assert(sac18->read_at(10, 0x80, 8).latency == 1 + 1);
+    assert(sac18->read_at(10, 0x40, 8).latency == 1);
+
+    // units of the same bank in one block are accessed one after the other
+    auto sac19 = std::make_shared<SetAssociativeCache>(
+        "sac19", fm_banks, true, false, 5, 1, 64, 4, 2, ReplacementPolicyType::LRU);
+    sac19->set_banks(std::make_shared<CacheBanks>(4, 8, 1));
+
+    sac19->read(0x00, 64);
+    assert(sac19->read(0x00, 32).latency == 1);
+    assert(sac19->read(0x00, 64).latency == 1 + 1);
+
+    assert(sac18->get_stats().bank_conflicts == 1);
+    assert(sac19->get_stats().bank_conflicts == 2);
+
+    bool banks_thrown = false;
+    try {
+        sac19->set_concurrent(true);
+    } catch (const std::runtime_error& e) {
+        banks_thrown = true;
+    }
+    assert(banks_thrown);
+
+    // prefetches outside of the memory are dropped at both ends
+    auto fm_edge = std::make_shared<FakeMemory>("fm_edge", 256, 20, 30);
+    std::vector<std::shared_ptr<Prefetcher>> edge_prefetchers = {
+        std::make_shared<NextLinePrefetcher>(16, 2),
+        std::make_shared<StridePrefetcher>(16, 2),
+        std::make_shared<StreamPrefetcher>(16, 2, 2)};
+
+    for (auto& edge_prefetcher : edge_prefetchers) {
+        auto sac20 = std::make_shared<SetAssociativeCache>(
+            "sac20", fm_edge, true, false, 5, 1, 16, 4, 2, ReplacementPolicyType::LRU);
+        sac20->set_prefetcher(edge_prefetcher);
+
+        assert(sac20->read(0xf0, 4).hit_level == 1);
+        for (address_t address : {0x20, 0x10, 0x00}) {
+            assert(sac20->read(address, 4).hit_level >= 0);
+        }
+        assert(!sac20->is_address_cached(0x100));
+    }
+
+    // the bounds are those of the memory, not of the next level cache
+    auto l2_edge = std::make_shared<SetAssociativeCache>(
+        "l2_edge", fm_edge, true, false, 5, 1, 16, 1, 2, ReplacementPolicyType::LRU);
+    auto sac21 = std::make_shared<SetAssociativeCache>(
+        "sac21", l2_edge, true, false, 5, 1, 16, 4, 2, ReplacementPolicyType::LRU);
+    sac21->set_prefetcher(std::make_shared<NextLinePrefetcher>(16, 1));
+    assert(sac21->get_address_space_size() == 256);
+
+    sac21->read(0x80, 4);
+    assert(sac21->is_address_cached(0x90));
+    sac21->read(0xf0, 4);
+    assert(sac21->get_stats().prefetches_issued == 1);
+
     return 0;
 }
@@ -0,0 +1,96 @@
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+int main() {
+    latency_t fm_read_latency = 11;
+    latency_t fm_write_latency = 13;
+
+    auto fm = std::make_shared<FakeMemory>("mem0", 1 << 20, fm_read_latency,
+                                           fm_write_latency);
+
+    latency_t skac_miss_latency = 7;
+    latency_t skac_hit_latency = 3;
+
+    // same capacity as a 64 set, 4 way set associative cache
+    auto skac = std::make_shared<SkewedAssociativeCache>(
+        "skac0", fm, true, false, skac_miss_latency, skac_hit_latency, 16, 64, 4,
+        SKEWED_LRU);
+    auto sac = std::make_shared<SetAssociativeCache>(
+        "sac0", fm, true, false, skac_miss_latency, skac_hit_latency, 16, 64, 4,
+        ReplacementPolicyType::LRU);
+    assert(skac->size() == sac->size());
+    assert(skac->get_sets() == 64);
+    assert(skac->get_ways() == 4);
+
+    auto miss_dst = skac->read(0x40, 4);
+    assert(miss_dst.latency == skac_miss_latency + fm_read_latency);
+    assert(miss_dst.hit_level == 1);
+    auto hit_dst = skac->read(0x44, 4);
+    assert(hit_dst.latency == skac_hit_latency);
+    assert(hit_dst.hit_level == 0);
+
+    // 8 blocks with a power of two stride thrash a single set of the set associative
+    // cache, the skewed cache spreads them over the ways
+    skac->reset();
+    for (int round = 0; round < 4; round++) {
+        for (address_t address = 0; address < 8 * 64 * 16; address += 64 * 16) {
+            skac->read(address, 8);
+            sac->read(address, 8);
+        }
+    }
+    assert(sac->get_stats().read_hits == 0);
+    assert(skac->get_stats().read_hits >= 3 * 8);
+
+    // write backs restore the address of each block
+    skac->reset();
+    for (address_t address = 0; address < (1 << 20); address += 16 * 97) {
+        Data d = Data(8);
+        d.set<uint64_t>(address);
+        skac->write(address, d);
+    }
+    assert(skac->get_valid_block_count() <= 64 * 4);
+    assert(skac->get_stats().write_backs > 0);
+
+    skac->flush();
+    assert(skac->get_dirty_block_count() == 0);
+    assert(skac->get_valid_block_count() == 0);
+    for (address_t address = 0; address < (1 << 20); address += 16 * 97) {
+        assert(fm->read(address, 8).data.get<uint64_t>() == address);
+    }
+
+    // not recently used replacement keeps the blocks which are hit
+    auto skac_nru = std::make_shared<SkewedAssociativeCache>(
+        "skac1", fm, true, false, skac_miss_latency, skac_hit_latency, 16, 12, 2,
+        SKEWED_NRU);
+    assert(skac_nru->get_replacement_policy_type() == SKEWED_NRU);
+
+    Data d = Data(4);
+    d.set<uint32_t>(0xdead'beef);
+    skac_nru->write(0x100, d);
+    for (address_t address = 0x1000; address < 0x8000; address += 16) {
+        skac_nru->read(0x100, 4);
+        skac_nru->read(address, 4);
+    }
+    assert(skac_nru->get_stats().read_hits > 1600);
+    assert(skac_nru->is_address_cached(0x100));
+    assert(skac_nru->get(0x101) == 0xbe);
+
+    // clones are independent
+    auto fm_clone = std::make_shared<FakeMemory>("mem1", 1 << 20, fm_read_latency,
+                                                 fm_write_latency);
+    auto skac_clone =
+        std::dynamic_pointer_cast<SkewedAssociativeCache>(skac_nru->clone(fm_clone));
+    skac_nru->reset();
+    assert(!skac_nru->is_address_cached(0x100));
+    assert(skac_clone->is_address_cached(0x100));
+    skac_clone->write(0x100, d);
+    skac_clone->flush();
+    assert(fm_clone->read(0x100, 4).data.get<uint32_t>() == 0xdead'beef);
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+int main() {
+    latency_t read_latency = 3;
+    latency_t write_latency = 5;
+
+    // 48-bit address space with 4 KiB pages
+    uint64_t size = 1ull << 48;
+
+    auto sm = std::make_unique<SparseMemory>("sm0", size, read_latency, write_latency);
+
+    assert(sm->size() == size);
+    assert(sm->page_size() == 4096);
+    assert(sm->get_allocated_page_count() == 0);
+
+    // bytes which were never written are 0 and reading does not allocate pages
+    auto read_dst0 = sm->read(0x7fff'ffff'0000, 8);
+
+    assert(read_dst0.type == DataStorageTransactionType::READ);
+    assert(read_dst0.address == 0x7fff'ffff'0000);
+    assert(read_dst0.latency == read_latency);
+    assert(read_dst0.hit_level == 0);
+    assert(read_dst0.data.get<uint64_t>() == 0);
+    assert(sm->get_allocated_page_count() == 0);
+
+    // write to the beginning and the end of the address space
+    Data d0 = Data(8);
+    d0.set<uint64_t>(0x0123'4567'89ab'cdef);
+
+    auto write_dst0 = sm->write(0x0000, d0);
+
+    assert(write_dst0.type == DataStorageTransactionType::WRITE);
+    assert(write_dst0.latency == write_latency);
+    assert(write_dst0.hit_level == 0);
+    assert(sm->get_allocated_page_count() == 1);
+
+    sm->write(size - 8, d0);
+    assert(sm->get_allocated_page_count() == 2);
+
+    assert(sm->read(0x0000, 8).data.get<uint64_t>() == 0x0123'4567'89ab'cdef);
+    assert(sm->read(size - 8, 8).data.get<uint64_t>() == 0x0123'4567'89ab'cdef);
+    assert(sm->get(size - 1) == 0x01);
+
+    // write across a page boundary
+    sm->write(0x1'0000'0ffc, d0);
+    assert(sm->get_allocated_page_count() == 4);
+    assert(sm->read(0x1'0000'0ffc, 8).data.get<uint64_t>() == 0x0123'4567'89ab'cdef);
+    assert(sm->read(0x1'0000'0ff8, 4).data.get<uint32_t>() == 0);
+    assert(sm->read(0x1'0000'1004, 4).data.get<uint32_t>() == 0);
+
+    // accesses out of range throw
+    bool thrown = false;
+    try {
+        sm->read(size - 4, 8);
+    } catch (const std::out_of_range& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // reset drops all pages
+    sm->reset();
+
+    assert(sm->get_allocated_page_count() == 0);
+    assert(sm->read(0x0000, 8).data.get<uint64_t>() == 0);
+    assert(sm->read(size - 8, 8).data.get<uint64_t>() == 0);
+
+    // 2 MiB pages
+    auto sm1 = std::make_unique<SparseMemory>("sm1", size, read_latency, write_latency,
+                                              2 * 1024 * 1024);
+
+    for (uint64_t i = 0; i < 4 * 1024 * 1024; i += 4096) {
+        Data d = Data(4);
+        d.set<uint32_t>(i);
+        sm1->write(0x4000'0000 + i, d);
+    }
+
+    assert(sm1->get_allocated_page_count() == 2);
+
+    for (uint64_t i = 0; i < 4 * 1024 * 1024; i += 4096) {
+        assert(sm1->read(0x4000'0000 + i, 4).data.get<uint32_t>() == i);
+    }
+
+    // incremental checkpoints only contain the pages written in between
+    auto sm3 = std::make_unique<SparseMemory>("sm3", size, read_latency, write_latency);
+
+    Data d3 = Data(8);
+    d3.set<uint64_t>(0x1111'2222'3333'4444);
+    sm3->write(0x10'0000'0000, d3);
+    sm3->write(size - 8, d3);
+
+    assert(sm3->get_dirty_page_count() == 2);
+    sm3->write_incremental_memory_file("../data/inc_data0.mem");
+    sm3->clear_dirty_pages();
+    assert(sm3->get_dirty_page_count() == 0);
+
+    // a write across a page boundary marks both pages
+    d3.set<uint64_t>(0x5555'6666'7777'8888);
+    sm3->write(0x20'0000'0ffc, d3);
+
+    assert(sm3->get_dirty_page_count() == 2);
+    assert(sm3->is_page_dirty(0x20'0000'0000));
+    assert(sm3->is_page_dirty(0x20'0000'1000));
+    assert(!sm3->is_page_dirty(0x10'0000'0000));
+    sm3->write_incremental_memory_file("../data/inc_data1.mem");
+
+    // header, index and two pages
+    assert(std::filesystem::file_size("../data/inc_data0.mem") ==
+           32 + 2 * 8 + 2 * 4096);
+
+    auto sm4 = std::make_unique<SparseMemory>("sm4", size, read_latency, write_latency);
+    sm4->read_incremental_memory_file("../data/inc_data0.mem");
+    sm4->read_incremental_memory_file("../data/inc_data1.mem");
+
+    assert(sm4->read(0x10'0000'0000, 8).data.get<uint64_t>() == 0x1111'2222'3333'4444);
+    assert(sm4->read(size - 8, 8).data.get<uint64_t>() == 0x1111'2222'3333'4444);
+    assert(sm4->read(0x20'0000'0ffc, 8).data.get<uint64_t>() == 0x5555'6666'7777'8888);
+    assert(sm4->get_allocated_page_count() == 4);
+    assert(sm4->get_dirty_page_count() == 4);
+
+    // reset marks all pages as clean
+    sm4->reset();
+    assert(sm4->get_dirty_page_count() == 0);
+
+    std::filesystem::remove("../data/inc_data0.mem");
+    std::filesystem::remove("../data/inc_data1.mem");
+
+    // clones share the pages written so far copy-on-write
+    auto sm5 = std::make_shared<SparseMemory>("sm5", size, read_latency, write_latency,
+                                              2 * 1024 * 1024);
+    Data d5 = Data(8);
+    d5.set<uint64_t>(5);
+    sm5->write(0x0000, d5);
+
+    auto sm5_clone = std::dynamic_pointer_cast<SparseMemory>(sm5->clone());
+    assert(sm5_clone != nullptr);
+    assert(sm5_clone->page_size() == 2 * 1024 * 1024);
+    assert(sm5_clone->get_allocated_page_count() == 0);
+    assert(sm5_clone->read(0x0000, 8).data.get<uint64_t>() == 5);
+
+    // pages written after the clone are counted in the memory which wrote them
+    sm5->write(0x1000'0000, d5);
+    sm5->write(0x2000'0000, d5);
+    assert(sm5->get_allocated_page_count() == 2);
+    assert(sm5_clone->get_allocated_page_count() == 0);
+    assert(sm5_clone->read(0x1000'0000, 8).data.get<uint64_t>() == 0);
+
+    // reset drops the shared pages as well
+    sm5->reset();
+    assert(sm5->get_allocated_page_count() == 0);
+    assert(sm5->get_dirty_page_count() == 0);
+    assert(sm5->read(0x0000, 8).data.get<uint64_t>() == 0);
+    assert(sm5->read(0x1000'0000, 8).data.get<uint64_t>() == 0);
+    assert(sm5_clone->read(0x0000, 8).data.get<uint64_t>() == 5);
+
+    sm5_clone->reset();
+    assert(sm5_clone->read(0x0000, 8).data.get<uint64_t>() == 0);
+
+    // page sizes have to be a power of two
+    thrown = false;
+    try {
+        auto sm2 = SparseMemory("sm2", size, read_latency, write_latency, 3000);
+    } catch (const std::invalid_argument& e) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include <cassert>
+#include <memory>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+int main() {
+    auto victim_cache = std::make_shared<VictimCache>(16, 2, 3);
+    assert(victim_cache->size() == 32);
+    assert(victim_cache->get_entries() == 2);
+    assert(victim_cache->get_latency() == 3);
+
+    auto d0 = Data(16);
+    d0.set<uint64_t>(0x1111'1111'1111'1111);
+    auto d1 = Data(16);
+    d1.set<uint64_t>(0x2222'2222'2222'2222);
+
+    assert(!victim_cache->insert(0x00, d0, true).has_value());
+    assert(!victim_cache->insert(0x40, d1, false).has_value());
+    assert(victim_cache->get_entry_count() == 2);
+    assert(victim_cache->contains(0x00));
+
+    // the least recently inserted block is replaced
+    auto replaced = victim_cache->insert(0x80, d1, false);
+    assert(replaced.has_value());
+    assert(replaced->address == 0x00);
+    assert(replaced->dirty);
+    assert(replaced->data.get<uint64_t>() == 0x1111'1111'1111'1111);
+    assert(!victim_cache->contains(0x00));
+
+    // reinserting a block replaces its outdated copy
+    assert(!victim_cache->insert(0x40, d0, true).has_value());
+    assert(victim_cache->get_entry_count() == 2);
+    assert(victim_cache->get_entry_list().front().address == 0x40);
+
+    // clones are independent
+    auto victim_cache_clone = victim_cache->clone();
+
+    auto removed = victim_cache->remove(0x40);
+    assert(removed.has_value());
+    assert(removed->dirty);
+    assert(removed->data.get<uint64_t>() == 0x1111'1111'1111'1111);
+    assert(!victim_cache->remove(0x40).has_value());
+    assert(victim_cache->get_entry_count() == 1);
+
+    assert(victim_cache_clone->contains(0x40));
+    assert(victim_cache_clone->remove(0x80).has_value());
+    assert(victim_cache_clone->get_entry_count() == 1);
+
+    victim_cache->reset();
+    assert(victim_cache->get_entry_count() == 0);
+    assert(!victim_cache->contains(0x80));
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <cassert>
+#include <memory>
+
+#include "kachesim/kachesim.h"
+
+using namespace kachesim;
+
+int main() {
+    auto write_buffer = std::make_shared<WriteBuffer>(2, 16, DRAIN_WHEN_FULL);
+    assert(write_buffer->size() == 32);
+    assert(write_buffer->get_entries() == 2);
+    assert(write_buffer->get_granularity() == 16);
+    assert(write_buffer->get_drain_policy() == DRAIN_WHEN_FULL);
+
+    auto d0 = Data(4);
+    d0.set<uint32_t>(0x1111'1111);
+    auto d1 = Data(4);
+    d1.set<uint32_t>(0x2222'2222);
+
+    // writes to the same granule merge
+    assert(!write_buffer->merge(0x04, d0));
+    write_buffer->insert(0x04, d0, 3);
+    assert(write_buffer->merge(0x0c, d1));
+    assert(write_buffer->get_entry_count() == 1);
+
+    auto& entry = write_buffer->get_entry_list().front();
+    assert(entry.address == 0x00);
+    assert(entry.insert_cycle == 3);
+    assert(!entry.valid[0x03]);
+    assert(entry.valid[0x04]);
+    assert(entry.valid[0x0f]);
+    assert(entry.data.get<uint32_t>(0x0c) == 0x2222'2222);
+
+    // only written bytes are forwarded
+    auto read_data = Data(8);
+    read_data.set<uint64_t>(0xffff'ffff'ffff'ffff);
+    write_buffer->forward(0x00, read_data);
+    assert(read_data.get<uint64_t>() == 0x1111'1111'ffff'ffff);
+
+    write_buffer->insert(0x20, d1, 4);
+    assert(write_buffer->is_full());
+
+    bool full_thrown = false;
+    try {
+        write_buffer->insert(0x40, d1, 5);
+    } catch (const std::runtime_error& e) {
+        full_thrown = true;
+    }
+    assert(full_thrown);
+
+    // a draining entry doesn't take writes and is freed when its drain completes
+    write_buffer->set_draining(write_buffer->get_entry_list().front(), 10);
+    assert(write_buffer->get_drain_cycle() == 10);
+    assert(write_buffer->get_first_drained_cycle() == 10);
+    assert(!write_buffer->merge(0x00, d1));
+
+    auto write_buffer_clone = write_buffer->clone();
+
+    write_buffer->retire(9);
+    assert(write_buffer->get_entry_count() == 2);
+    write_buffer->retire(10);
+    assert(write_buffer->get_entry_count() == 1);
+    assert(!write_buffer->get_first_drained_cycle().has_value());
+
+    auto oldest = write_buffer->remove_oldest();
+    assert(oldest.has_value());
+    assert(oldest->address == 0x20);
+    assert(!write_buffer->remove_oldest().has_value());
+
+    // clones are independent
+    assert(write_buffer_clone->get_entry_count() == 2);
+    assert(write_buffer_clone->merge(0x24, d0));
+    assert(!write_buffer_clone->merge(0x00, d0));
+
+    write_buffer_clone->reset();
+    assert(write_buffer_clone->get_entry_count() == 0);
+    assert(write_buffer_clone->get_drain_cycle() == 0);
+
+    bool granularity_thrown = false;
+    try {
+        WriteBuffer(2, 24, DRAIN_EAGER);
+    } catch (const std::invalid_argument& e) {
+        granularity_thrown = true;
+    }
+    assert(granularity_thrown);
+
+    return 0;
+}